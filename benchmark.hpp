@@ -0,0 +1,334 @@
+#pragma once
+
+#include "utils.hpp"
+#include "latency_histogram.hpp"
+#include "perf_counters.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+
+namespace hft {
+
+/**
+ * Keep a value alive without the compiler proving it unused
+ * (same trick as Google Benchmark's DoNotOptimize)
+ */
+template<typename T>
+inline void do_not_optimize(T const& value) noexcept {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * Compiler barrier - forces pending stores to memory
+ */
+inline void clobber_memory() noexcept {
+    asm volatile("" : : : "memory");
+}
+
+/**
+ * Microbenchmark configuration
+ */
+struct BenchmarkConfig {
+    uint64_t warmup_ops{100000};        // Untimed - train caches and predictors
+    uint64_t ops_per_rep{100000};       // Timed as one block (throughput)
+    uint32_t repetitions{20};           // Independent blocks (run-to-run variance)
+    uint64_t latency_samples{100000};   // Individually timed ops (distribution)
+    int core{0};                        // Pin benchmark thread here (-1 = don't)
+};
+
+/**
+ * One benchmark's results
+ */
+struct BenchmarkResult {
+    std::string name;
+    uint64_t ops_per_rep;
+    uint32_t repetitions;
+
+    // Throughput: ns/op per repetition
+    double mean_ns;
+    double stddev_ns;
+    double min_ns;
+    double median_ns;
+    double max_ns;
+
+    // Latency: per-op distribution (timer overhead subtracted)
+    LatencyHistogram latency;
+
+    // Hardware counters per op over the throughput reps (if PMU available)
+    bool has_perf;
+    double perf_per_op[PERF_EVENT_COUNT];
+};
+
+/**
+ * Microbenchmark Runner
+ *
+ * Ad-hoc "time a loop once" numbers are dominated by cold caches, frequency
+ * ramp-up and scheduler noise. Each benchmark here gets:
+ *
+ * 1. Warmup: untimed ops (page faults, i-cache, branch predictor)
+ * 2. Throughput: N repetitions of a timed block -> mean/stddev/median ns/op
+ * 3. Latency: individually rdtscp-bracketed ops -> p50..p99.99 histogram,
+ *    with the empty-bracket overhead measured and subtracted
+ *
+ * Runs pinned; results print as a table and persist as JSON (one benchmark
+ * per line) so successive commits can be diffed with --baseline.
+ *
+ * When the PMU is reachable the throughput reps are also bracketed with the
+ * perf counter group, so a regression shows up as "more L1 misses/op" or
+ * "more branch misses/op" rather than just "slower".
+ */
+class BenchmarkRunner {
+private:
+    BenchmarkConfig config_;
+    double tsc_ghz_;
+    uint64_t timer_overhead_ticks_{0};
+    std::vector<BenchmarkResult> results_;
+    PerfCounterGroup perf_;
+
+public:
+    explicit BenchmarkRunner(const BenchmarkConfig& config = BenchmarkConfig{})
+        : config_(config) {
+        if (config_.core >= 0 && !ThreadUtils::pin_to_core(config_.core)) {
+            std::cerr << "[Bench] Failed to pin to core " << config_.core << std::endl;
+        }
+        tsc_ghz_ = LatencyTracker::calibrate_tsc_ghz();
+        timer_overhead_ticks_ = measure_timer_overhead();
+
+        if (!perf_.open()) {
+            std::cerr << "[Bench] perf_event_open unavailable - no hardware counters" << std::endl;
+        }
+    }
+
+    /**
+     * Benchmark op() - called once per operation
+     *
+     * @param between_reps Called (untimed) before each repetition / the latency
+     *                     pass, e.g. to drain a queue the op fills
+     */
+    template<typename Op>
+    void run(const std::string& name, Op&& op,
+             const std::function<void()>& between_reps = nullptr) {
+        for (uint64_t i = 0; i < config_.warmup_ops; ++i) {
+            op();
+        }
+
+        // Throughput repetitions
+        BenchmarkResult result{};
+        std::vector<double> rep_ns;
+        rep_ns.reserve(config_.repetitions);
+        uint64_t perf_totals[PERF_EVENT_COUNT] = {};
+        for (uint32_t r = 0; r < config_.repetitions; ++r) {
+            if (between_reps) between_reps();
+
+            PerfReading perf_start{};
+            PerfReading perf_end{};
+            if (perf_.is_open()) perf_.read(perf_start);
+
+            const uint64_t start = LatencyTracker::rdtscp();
+            for (uint64_t i = 0; i < config_.ops_per_rep; ++i) {
+                op();
+            }
+            const uint64_t end = LatencyTracker::rdtscp();
+
+            if (perf_.is_open()) {
+                perf_.read(perf_end);
+                for (size_t e = 0; e < PERF_EVENT_COUNT; ++e) {
+                    perf_totals[e] += perf_end.values[e] - perf_start.values[e];
+                }
+            }
+            rep_ns.push_back(static_cast<double>(end - start) / tsc_ghz_ / config_.ops_per_rep);
+        }
+
+        result.has_perf = perf_.is_open();
+        const double total_ops = static_cast<double>(config_.ops_per_rep) * config_.repetitions;
+        for (size_t e = 0; e < PERF_EVENT_COUNT; ++e) {
+            result.perf_per_op[e] = perf_totals[e] / total_ops;
+        }
+
+        // Per-op latency distribution (reported in ns)
+        if (between_reps) between_reps();
+        for (uint64_t i = 0; i < config_.latency_samples; ++i) {
+            if (between_reps && config_.ops_per_rep > 0 && i > 0 && i % config_.ops_per_rep == 0) {
+                between_reps();
+            }
+            const uint64_t start = LatencyTracker::rdtscp();
+            op();
+            const uint64_t end = LatencyTracker::rdtscp();
+            const uint64_t ticks = end - start;
+            const uint64_t net = ticks > timer_overhead_ticks_ ? ticks - timer_overhead_ticks_ : 0;
+            result.latency.record(static_cast<uint64_t>(net / tsc_ghz_ + 0.5));
+        }
+
+        result.name = name;
+        result.ops_per_rep = config_.ops_per_rep;
+        result.repetitions = config_.repetitions;
+        summarize(rep_ns, result);
+        print(result);
+        results_.push_back(std::move(result));
+    }
+
+    /**
+     * Persist results - one benchmark object per line (easy to diff/grep)
+     */
+    bool write_json(const std::string& path, const std::string& commit) const {
+        std::ofstream out(path);
+        if (!out.is_open()) {
+            return false;
+        }
+
+        out << "{\n  \"commit\": \"" << commit << "\",\n  \"tsc_ghz\": " << tsc_ghz_
+            << ",\n  \"timer_overhead_ticks\": " << timer_overhead_ticks_ << ",\n  \"benchmarks\": [\n";
+        for (size_t i = 0; i < results_.size(); ++i) {
+            const auto& r = results_[i];
+            char buf[512];
+            snprintf(buf, sizeof(buf),
+                     "    {\"name\": \"%s\", \"ops_per_rep\": %lu, \"repetitions\": %u, "
+                     "\"mean_ns\": %.3f, \"stddev_ns\": %.3f, \"min_ns\": %.3f, "
+                     "\"median_ns\": %.3f, \"max_ns\": %.3f, ",
+                     r.name.c_str(), r.ops_per_rep, r.repetitions,
+                     r.mean_ns, r.stddev_ns, r.min_ns, r.median_ns, r.max_ns);
+            out << buf << r.latency.to_json("latency_ns");
+            if (r.has_perf) {
+                out << ", \"perf_per_op\": {";
+                for (size_t e = 0; e < PERF_EVENT_COUNT; ++e) {
+                    snprintf(buf, sizeof(buf), "%s\"%s\": %.4f", e ? ", " : "", perf_event_name(e),
+                             r.perf_per_op[e]);
+                    out << buf;
+                }
+                out << "}";
+            }
+            out << "}" << (i + 1 < results_.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+        return true;
+    }
+
+    /**
+     * Compare median ns/op against a previous run's JSON
+     * Flags anything slower by more than threshold_pct, and any hardware
+     * counter per op that grew by more than threshold_pct (and > 0.01/op,
+     * so near-zero miss rates don't flag on noise)
+     *
+     * @return number of regressions found
+     */
+    int compare_with(const std::string& baseline_path, double threshold_pct = 5.0) const {
+        std::ifstream in(baseline_path);
+        if (!in.is_open()) {
+            std::cerr << "[Bench] Baseline not found: " << baseline_path << std::endl;
+            return 0;
+        }
+
+        std::cout << "\n=== Comparison vs " << baseline_path << " (median ns/op) ===" << std::endl;
+        int regressions = 0;
+        std::string line;
+        while (std::getline(in, line)) {
+            const std::string name = extract_string(line, "\"name\": \"");
+            const double base = extract_number(line, "\"median_ns\": ");
+            if (name.empty() || base <= 0.0) continue;
+
+            for (const auto& r : results_) {
+                if (r.name != name) continue;
+                const double delta = (r.median_ns - base) / base * 100.0;
+                const bool regressed = delta > threshold_pct;
+                regressions += regressed ? 1 : 0;
+                printf("%-36s %9.2f -> %9.2f  %+7.1f%% %s\n", name.c_str(), base, r.median_ns,
+                       delta, regressed ? "REGRESSION" : "");
+
+                if (!r.has_perf) continue;
+                for (size_t e = 0; e < PERF_EVENT_COUNT; ++e) {
+                    const std::string key = std::string("\"") + perf_event_name(e) + "\": ";
+                    if (line.find(key) == std::string::npos) continue;
+                    const double base_ev = extract_number(line, key.c_str());
+                    const double now_ev = r.perf_per_op[e];
+                    if (now_ev - base_ev > 0.01 && now_ev > base_ev * (1.0 + threshold_pct / 100.0)) {
+                        regressions++;
+                        printf("  %-34s %9.3f -> %9.3f /op  REGRESSION\n", perf_event_name(e), base_ev, now_ev);
+                    }
+                }
+            }
+        }
+        return regressions;
+    }
+
+    /**
+     * Per-benchmark overrides (e.g. fewer ops for bounded queues)
+     */
+    BenchmarkConfig& config() noexcept { return config_; }
+
+    [[nodiscard]] double tsc_ghz() const noexcept { return tsc_ghz_; }
+    [[nodiscard]] const std::vector<BenchmarkResult>& results() const noexcept { return results_; }
+
+    static void print_header() {
+        printf("%-36s %9s %9s %9s %9s %9s %9s\n",
+               "benchmark", "median", "stddev", "p50", "p99", "p99.9", "max");
+        printf("%-36s %9s %9s %9s %9s %9s %9s\n",
+               "", "ns/op", "ns/op", "ns", "ns", "ns", "ns");
+    }
+
+private:
+    /**
+     * Cost of an empty rdtscp...rdtscp bracket - min over many tries
+     */
+    static uint64_t measure_timer_overhead() noexcept {
+        uint64_t best = UINT64_MAX;
+        for (int i = 0; i < 10000; ++i) {
+            const uint64_t start = LatencyTracker::rdtscp();
+            const uint64_t end = LatencyTracker::rdtscp();
+            best = std::min(best, end - start);
+        }
+        return best;
+    }
+
+    static void summarize(std::vector<double>& samples, BenchmarkResult& result) {
+        std::sort(samples.begin(), samples.end());
+        double sum = 0.0;
+        for (double s : samples) sum += s;
+        const double mean = sum / samples.size();
+        double var = 0.0;
+        for (double s : samples) var += (s - mean) * (s - mean);
+
+        result.mean_ns = mean;
+        result.stddev_ns = samples.size() > 1 ? std::sqrt(var / (samples.size() - 1)) : 0.0;
+        result.min_ns = samples.front();
+        result.max_ns = samples.back();
+        result.median_ns = samples[samples.size() / 2];
+    }
+
+    static void print(const BenchmarkResult& r) {
+        printf("%-36s %9.2f %9.2f %9lu %9lu %9lu %9lu\n",
+               r.name.c_str(), r.median_ns, r.stddev_ns,
+               r.latency.percentile(50.0), r.latency.percentile(99.0),
+               r.latency.percentile(99.9), r.latency.max());
+        if (r.has_perf) {
+            const double cycles = r.perf_per_op[0];
+            printf("  cycles/op=%.1f ipc=%.2f l1d_miss/op=%.3f llc_miss/op=%.4f br_miss/op=%.3f "
+                   "itlb_miss/op=%.4f\n",
+                   cycles, cycles > 0 ? r.perf_per_op[1] / cycles : 0.0,
+                   r.perf_per_op[2], r.perf_per_op[3], r.perf_per_op[4], r.perf_per_op[5]);
+        }
+    }
+
+    static std::string extract_string(const std::string& line, const char* key) {
+        const size_t pos = line.find(key);
+        if (pos == std::string::npos) return {};
+        const size_t start = pos + strlen(key);
+        const size_t end = line.find('"', start);
+        return end == std::string::npos ? std::string{} : line.substr(start, end - start);
+    }
+
+    static double extract_number(const std::string& line, const char* key) {
+        const size_t pos = line.find(key);
+        if (pos == std::string::npos) return 0.0;
+        return std::atof(line.c_str() + pos + strlen(key));
+    }
+};
+
+} // namespace hft
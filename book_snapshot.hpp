@@ -0,0 +1,513 @@
+#pragma once
+
+#include "types.hpp"
+#include "utils.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace hft {
+
+/**
+ * Per-symbol book state - plain data, as stored in the snapshot file
+ * Every field is an absolute value (no deltas), so re-applying an update
+ * that is already reflected is harmless - what makes fuzzy checkpoints
+ * and resume-at-sequence correct.
+ *
+ * Top of book and last trade only, from QUOTE and TRADE events. Order-level
+ * feeds (ITCH, SBE MBO) carry their book as ORDER_* / BOOK_LEVEL events,
+ * which are not persisted: for them a restore gives the last quote or
+ * trade, not resting orders or depth - those still need the venue's
+ * snapshot cycle.
+ */
+struct BookEntry {
+    uint64_t bid_price;
+    uint64_t ask_price;
+    uint32_t bid_size;
+    uint32_t ask_size;
+    uint64_t last_trade_price;
+    uint32_t last_trade_qty;
+    uint32_t flags;             // HAS_QUOTE / HAS_TRADE
+    uint64_t last_sequence;     // Feed sequence of the last update
+    uint64_t exchange_ns;       // Exchange timestamp of the last update
+
+    static constexpr uint32_t HAS_QUOTE = 1 << 0;
+    static constexpr uint32_t HAS_TRADE = 1 << 1;
+};
+static_assert(sizeof(BookEntry) == 56, "BookEntry is part of the snapshot file format");
+static_assert(std::is_trivially_copyable_v<BookEntry>);
+
+/**
+ * Live per-symbol books, written by the engine thread only
+ *
+ * One cache line per symbol: a seqlock version (odd while the engine is
+ * writing) plus the entry, so the checkpoint thread can copy any symbol
+ * consistently without ever making the engine wait. A dense dirty byte
+ * per symbol (one bit per snapshot image) lets a checkpoint find changed
+ * symbols by scanning 1 byte instead of 1 line per symbol. Engine cost
+ * per event: three extra plain stores; fences are compiler-only on x86.
+ */
+class SymbolBooks {
+public:
+    struct alignas(64) Slot {
+        std::atomic<uint32_t> version{0};
+        BookEntry entry{};
+    };
+    static_assert(sizeof(Slot) == 64);
+
+private:
+    std::unique_ptr<Slot[]> slots_;
+    std::unique_ptr<std::atomic<uint8_t>[]> dirty_;
+    size_t capacity_;
+
+    // Last applied feed sequence - published after the book write
+    alignas(64) std::atomic<uint64_t> applied_sequence_{0};
+
+public:
+    static constexpr uint8_t ALL_IMAGES = 0x3;
+
+    explicit SymbolBooks(size_t capacity)
+        : slots_(std::make_unique<Slot[]>(capacity)),
+          dirty_(std::make_unique<std::atomic<uint8_t>[]>(capacity)),
+          capacity_(capacity) {}
+
+    [[nodiscard]] size_t capacity() const noexcept { return capacity_; }
+
+    /**
+     * Engine thread: fold one event into its symbol's book
+     * Symbols beyond capacity are ignored.
+     */
+    inline void apply(const MarketEvent& event) noexcept {
+        if ((event.type != MessageType::QUOTE && event.type != MessageType::TRADE) ||
+            event.symbol_id >= capacity_) [[unlikely]] {
+            applied_sequence_.store(event.sequence, std::memory_order_release);
+            return;
+        }
+        Slot& slot = slots_[event.symbol_id];
+        const uint32_t v = slot.version.load(std::memory_order_relaxed);
+        slot.version.store(v + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        BookEntry& e = slot.entry;
+        if (event.type == MessageType::QUOTE) {
+            e.bid_price = event.data.quote.bid_price;
+            e.ask_price = event.data.quote.ask_price;
+            e.bid_size = event.data.quote.bid_size;
+            e.ask_size = event.data.quote.ask_size;
+            e.flags |= BookEntry::HAS_QUOTE;
+        } else {
+            e.last_trade_price = event.data.trade.price;
+            e.last_trade_qty = event.data.trade.quantity;
+            e.flags |= BookEntry::HAS_TRADE;
+        }
+        e.last_sequence = event.sequence;
+        e.exchange_ns = event.exchange_timestamp_ns;
+
+        slot.version.store(v + 2, std::memory_order_release);
+        // Plain store, no RMW: racing a checkpoint's clear only costs a re-copy
+        dirty_[event.symbol_id].store(ALL_IMAGES, std::memory_order_relaxed);
+        applied_sequence_.store(event.sequence, std::memory_order_release);
+    }
+
+    /**
+     * Any thread: consistent copy of one symbol
+     * @return The (even) version copied
+     */
+    uint32_t read(size_t symbol, BookEntry& out) const noexcept {
+        const Slot& slot = slots_[symbol];
+        while (true) {
+            const uint32_t v1 = slot.version.load(std::memory_order_acquire);
+            if (v1 & 1) {
+                SpinWait::pause();
+                continue;
+            }
+            std::memcpy(&out, &slot.entry, sizeof(BookEntry));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.version.load(std::memory_order_relaxed) == v1) {
+                return v1;
+            }
+        }
+    }
+
+    /**
+     * Checkpoint side: was the symbol written since image_bit was cleared?
+     */
+    [[nodiscard]] bool dirty(size_t symbol, uint8_t image_bit) const noexcept {
+        return dirty_[symbol].load(std::memory_order_relaxed) & image_bit;
+    }
+
+    /**
+     * Clear before reading the book - a write landing after the clear sets
+     * the bit again and is picked up by the next checkpoint
+     */
+    void clean(size_t symbol, uint8_t image_bit) noexcept {
+        dirty_[symbol].fetch_and(static_cast<uint8_t>(~image_bit), std::memory_order_acq_rel);
+    }
+
+    void mark_dirty(size_t symbol, uint8_t image_bits) noexcept {
+        dirty_[symbol].fetch_or(image_bits, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] uint64_t applied_sequence() const noexcept {
+        return applied_sequence_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Restore path - before the engine thread starts
+     */
+    void load(size_t symbol, const BookEntry& entry, uint64_t applied_sequence) noexcept {
+        slots_[symbol].entry = entry;
+        applied_sequence_.store(applied_sequence, std::memory_order_relaxed);
+    }
+};
+
+/**
+ * Book Snapshot File - warm restart
+ *
+ * A memory-mapped file with two complete book images (A/B). Each
+ * checkpoint rewrites the older image and then marks it COMPLETE with a
+ * higher generation, so a crash mid-checkpoint always leaves the other
+ * image intact. Only symbols written since that image was last
+ * checkpointed are copied - cost follows update activity, plus a 1-byte
+ * per symbol scan - and the copy runs on the housekeeping thread.
+ *
+ * Checkpoints are fuzzy: the sequence recorded is the engine's applied
+ * sequence when the copy started; entries may already include later
+ * updates. Resuming incremental processing at that sequence re-applies
+ * them, which is harmless (BookEntry holds absolute values).
+ *
+ * Process restart needs no msync - MAP_SHARED pages live in the page
+ * cache. sync() is there for host crash durability.
+ *
+ * What is restored is BookEntry state only - see its limits for
+ * order-level feeds.
+ *
+ * On open, each image is validated (magic, format version, layout,
+ * session tag, COMPLETE, checksum over every entry) and the newest valid
+ * one is loaded - unless it is older than max_age_ns: a snapshot left by
+ * an earlier run would resume at a sequence the restarted feed has not
+ * reached, so that is a cold start too.
+ */
+struct BookSnapshotConfig {
+    std::string path{"book_snapshot.bin"};
+    size_t capacity{65536};             // Symbol ids 0..capacity-1
+    uint64_t session{0};                // Tag (e.g. trading date); mismatch = cold start, 0 = any
+    uint64_t interval_ns{100000000};    // Checkpoint period (100ms)
+    uint64_t max_age_ns{300000000000};  // Newest image older = cold start (5 min), 0 = any
+};
+
+class BookSnapshot {
+public:
+    static constexpr uint64_t MAGIC = 0x484654424F4F4B31ULL;   // "HFTBOOK1"
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+private:
+    enum SlotState : uint32_t { EMPTY = 0, WRITING = 1, COMPLETE = 2 };
+
+    struct alignas(64) FileHeader {
+        uint64_t magic;
+        uint32_t format_version;
+        uint32_t entry_size;
+        uint64_t capacity;
+        uint64_t session;
+    };
+
+    struct alignas(64) ImageHeader {
+        std::atomic<uint32_t> state;
+        uint32_t reserved;
+        uint64_t generation;
+        uint64_t sequence;          // Resume point
+        uint64_t checksum;          // XOR of entry_hash over all entries
+        uint64_t written_ns;        // CLOCK_REALTIME
+        uint64_t entries_copied;    // By the checkpoint that wrote it
+    };
+
+    static constexpr size_t DATA_OFFSET = 4096;
+
+    BookSnapshotConfig cfg_;
+    SymbolBooks books_;
+
+    int fd_{-1};
+    uint8_t* map_{nullptr};
+    size_t map_size_{0};
+    FileHeader* file_header_{nullptr};
+    ImageHeader* images_[2]{};
+    BookEntry* entries_[2]{};
+
+    int active_{-1};            // Newest COMPLETE image
+    uint64_t generation_{0};
+
+    bool restored_{false};
+    const char* cold_reason_{"no valid image"};
+    uint64_t resume_sequence_{0};
+    uint64_t restore_ns_{0};
+    uint64_t last_checkpoint_ns_{0};
+
+    uint64_t checkpoints_{0};
+    uint64_t entries_copied_{0};
+    uint64_t last_checkpoint_cost_ns_{0};
+    uint64_t max_checkpoint_cost_ns_{0};
+
+public:
+    explicit BookSnapshot(const BookSnapshotConfig& cfg = BookSnapshotConfig{})
+        : cfg_(cfg), books_(cfg.capacity) {}
+
+    ~BookSnapshot() {
+        if (map_) munmap(map_, map_size_);
+        if (fd_ >= 0) close(fd_);
+    }
+
+    BookSnapshot(const BookSnapshot&) = delete;
+    BookSnapshot& operator=(const BookSnapshot&) = delete;
+
+    /**
+     * Map (creating or re-initializing if needed) and restore the newest
+     * valid image into the live books - before the engine starts
+     *
+     * @return false if the file cannot be mapped (snapshots off)
+     */
+    bool open() {
+        const uint64_t start = now_ns();
+        map_size_ = DATA_OFFSET + 2 * cfg_.capacity * sizeof(BookEntry);
+
+        fd_ = ::open(cfg_.path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd_ < 0) {
+            return false;
+        }
+        struct stat st;
+        const bool sized = fstat(fd_, &st) == 0 && static_cast<size_t>(st.st_size) == map_size_;
+        if (!sized && ftruncate(fd_, static_cast<off_t>(map_size_)) != 0) {
+            return false;
+        }
+        void* p = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, 0);
+        if (p == MAP_FAILED) {
+            map_ = nullptr;
+            return false;
+        }
+        map_ = static_cast<uint8_t*>(p);
+        file_header_ = reinterpret_cast<FileHeader*>(map_);
+        for (int i = 0; i < 2; ++i) {
+            images_[i] = reinterpret_cast<ImageHeader*>(map_ + sizeof(FileHeader) + i * sizeof(ImageHeader));
+            entries_[i] = reinterpret_cast<BookEntry*>(map_ + DATA_OFFSET + i * cfg_.capacity * sizeof(BookEntry));
+        }
+
+        if (!sized) {
+            cold_reason_ = "new file";
+        } else if (!header_matches()) {
+            cold_reason_ = file_header_->session != cfg_.session && cfg_.session != 0
+                               ? "session mismatch" : "layout mismatch";
+        } else {
+            restore();
+        }
+        if (!restored_) {
+            initialize();
+        }
+        restore_ns_ = now_ns() - start;
+        return true;
+    }
+
+    /**
+     * Live books the engine writes (SymbolBooks::apply)
+     */
+    SymbolBooks& books() noexcept { return books_; }
+    const SymbolBooks& books() const noexcept { return books_; }
+
+    [[nodiscard]] bool restored() const noexcept { return restored_; }
+    [[nodiscard]] const char* cold_reason() const noexcept { return cold_reason_; }
+    [[nodiscard]] uint64_t resume_sequence() const noexcept { return resume_sequence_; }
+    [[nodiscard]] uint64_t restore_ns() const noexcept { return restore_ns_; }
+    [[nodiscard]] uint64_t checkpoints() const noexcept { return checkpoints_; }
+    [[nodiscard]] uint64_t entries_copied() const noexcept { return entries_copied_; }
+
+    /**
+     * Housekeeping task: checkpoint if interval_ns has passed
+     */
+    void maybe_checkpoint() {
+        if (map_ && now_ns() - last_checkpoint_ns_ >= cfg_.interval_ns) {
+            checkpoint();
+        }
+    }
+
+    /**
+     * Write the older image from the live books and make it current
+     * One thread at a time (housekeeping, or the owner after shutdown).
+     */
+    void checkpoint() {
+        if (!map_) {
+            return;
+        }
+        const uint64_t start = now_ns();
+        const int target = active_ == 0 ? 1 : 0;
+        ImageHeader& image = *images_[target];
+        BookEntry* entries = entries_[target];
+        const uint8_t image_bit = static_cast<uint8_t>(1 << target);
+
+        // Everything applied up to here is in the books we are about to read
+        const uint64_t sequence = books_.applied_sequence();
+
+        image.state.store(WRITING, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        uint64_t checksum = image.checksum;
+        uint64_t copied_count = 0;
+        BookEntry entry;
+        for (size_t i = 0; i < cfg_.capacity; ++i) {
+            if (!books_.dirty(i, image_bit)) {
+                continue;
+            }
+            books_.clean(i, image_bit);
+            (void)books_.read(i, entry);
+            checksum ^= entry_hash(entries[i], i) ^ entry_hash(entry, i);
+            entries[i] = entry;
+            copied_count++;
+        }
+
+        image.generation = ++generation_;
+        image.sequence = sequence;
+        image.checksum = checksum;
+        image.written_ns = wall_ns();
+        image.entries_copied = copied_count;
+        image.state.store(COMPLETE, std::memory_order_release);
+        active_ = target;
+
+        checkpoints_++;
+        entries_copied_ += copied_count;
+        last_checkpoint_ns_ = now_ns();
+        last_checkpoint_cost_ns_ = last_checkpoint_ns_ - start;
+        if (last_checkpoint_cost_ns_ > max_checkpoint_cost_ns_) {
+            max_checkpoint_cost_ns_ = last_checkpoint_cost_ns_;
+        }
+    }
+
+    /**
+     * Flush to disk (host crash durability) - not needed for process restart
+     */
+    bool sync() noexcept {
+        return map_ && msync(map_, map_size_, MS_SYNC) == 0;
+    }
+
+    void print() const {
+        printf("[BookSnapshot] %s - %s%s%s, %lu checkpoints, %lu entries copied, "
+               "last %.1f us, max %.1f us\n",
+               cfg_.path.c_str(), restored_ ? "restored" : "cold start (",
+               restored_ ? "" : cold_reason_, restored_ ? "" : ")",
+               checkpoints_, entries_copied_,
+               static_cast<double>(last_checkpoint_cost_ns_) / 1e3,
+               static_cast<double>(max_checkpoint_cost_ns_) / 1e3);
+    }
+
+private:
+    bool header_matches() const noexcept {
+        return file_header_->magic == MAGIC &&
+               file_header_->format_version == FORMAT_VERSION &&
+               file_header_->entry_size == sizeof(BookEntry) &&
+               file_header_->capacity == cfg_.capacity &&
+               (cfg_.session == 0 || file_header_->session == cfg_.session);
+    }
+
+    /**
+     * Newest COMPLETE image whose checksum verifies -> live books
+     */
+    void restore() noexcept {
+        int best = -1;
+        for (int i = 0; i < 2; ++i) {
+            const ImageHeader& image = *images_[i];
+            if (image.state.load(std::memory_order_acquire) != COMPLETE) continue;
+            if (best >= 0 && image.generation <= images_[best]->generation) continue;
+            if (compute_checksum(i) != image.checksum) continue;
+            best = i;
+        }
+        if (best < 0) {
+            return;
+        }
+
+        const ImageHeader& image = *images_[best];
+        const uint64_t wall = wall_ns();
+        if (cfg_.max_age_ns != 0 &&
+            (image.written_ns > wall || wall - image.written_ns > cfg_.max_age_ns)) {
+            cold_reason_ = "image too old";
+            return;
+        }
+        for (size_t s = 0; s < cfg_.capacity; ++s) {
+            books_.load(s, entries_[best][s], image.sequence);
+        }
+        active_ = best;
+        generation_ = image.generation;
+        resume_sequence_ = image.sequence;
+        restored_ = true;
+        // Live books equal the restored image; the other one is rewritten
+        // in full by its first checkpoint
+        const uint8_t other_bit = static_cast<uint8_t>(1 << (best == 0 ? 1 : 0));
+        for (size_t s = 0; s < cfg_.capacity; ++s) {
+            books_.mark_dirty(s, other_bit);
+        }
+
+        // The other image may be torn or stale - mark it WRITING so it is
+        // never chosen until a checkpoint rewrites it
+        const int other = best == 0 ? 1 : 0;
+        images_[other]->checksum = compute_checksum(other);
+        images_[other]->state.store(WRITING, std::memory_order_release);
+    }
+
+    /**
+     * Fresh file (or unusable one): zero images, both EMPTY
+     */
+    void initialize() noexcept {
+        std::memset(map_, 0, map_size_);
+        file_header_->magic = MAGIC;
+        file_header_->format_version = FORMAT_VERSION;
+        file_header_->entry_size = sizeof(BookEntry);
+        file_header_->capacity = cfg_.capacity;
+        file_header_->session = cfg_.session;
+        for (int i = 0; i < 2; ++i) {
+            images_[i]->checksum = compute_checksum(i);
+        }
+        active_ = -1;
+        generation_ = 0;
+    }
+
+    uint64_t compute_checksum(int image) const noexcept {
+        uint64_t checksum = 0;
+        for (size_t i = 0; i < cfg_.capacity; ++i) {
+            checksum ^= entry_hash(entries_[image][i], i);
+        }
+        return checksum;
+    }
+
+    /**
+     * Position-dependent 64-bit mix of one entry (XOR-combinable, so a
+     * checkpoint updates the image checksum in O(entries copied))
+     */
+    static uint64_t entry_hash(const BookEntry& entry, size_t index) noexcept {
+        uint64_t words[sizeof(BookEntry) / 8];
+        std::memcpy(words, &entry, sizeof(words));
+        uint64_t h = 0x9E3779B97F4A7C15ULL * (index + 1);
+        for (const uint64_t w : words) {
+            h ^= w + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+            h *= 0xBF58476D1CE4E5B9ULL;
+        }
+        return h ^ (h >> 31);
+    }
+
+    static uint64_t now_ns() noexcept {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+    }
+
+    static uint64_t wall_ns() noexcept {
+        timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+    }
+};
+
+} // namespace hft
@@ -0,0 +1,341 @@
+#pragma once
+
+#include "types.hpp"
+#include "utils.hpp"
+#include "latency_histogram.hpp"
+#include <time.h>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+
+namespace hft {
+
+/**
+ * Exchange-to-Local Clock Skew and One-Way Latency
+ *
+ * A MarketEvent carries two unrelated clocks: the exchange's send timestamp
+ * and our receive TSC. Their difference d = local - exchange is
+ *
+ *     d(t) = one-way latency(t) + clock offset(t)
+ *
+ * and the offset drifts (two oscillators, NTP/PTP slewing one of them).
+ * The fastest packets see only the fixed path latency, so the lower
+ * envelope of d tracks offset + path floor:
+ *
+ * - min filter: the minimum of d over each window_ns of local time
+ * - drift: least-squares line through the last fit_windows minima, pushed
+ *   down so no minimum lies below it (lower envelope)
+ * - one-way latency of a packet = d - line(t) + path_floor_ns
+ *
+ * So latency is measured above the path's own floor - path_floor_ns adds
+ * back the known fibre/switch minimum if you have it. Different epochs
+ * (ITCH: ns since midnight) just end up in the offset.
+ *
+ * Per channel, next to exchange -> receive (the network, exchange
+ * gateway and our NIC/kernel), ClockSkewMonitor records receive -> engine
+ * (our own code) - which of the two grew answers "is it them or us".
+ */
+struct ClockSkewConfig {
+    uint64_t window_ns{1000000000};     // Min-filter window (local time)
+    uint64_t path_floor_ns{0};          // Known minimum one-way latency, added back
+    uint32_t fit_windows{16};           // Window minima in the drift fit
+    bool exchange_is_local_tsc{false};  // Simulators on this host stamp TSC, not ns
+};
+
+/**
+ * TSC -> local wall clock (CLOCK_REALTIME ns)
+ * Anchored once; TSC vs realtime drift (NTP slew) is absorbed by the
+ * skew estimator's drift term like any other.
+ */
+class LocalClock {
+private:
+    uint64_t anchor_tsc_{0};
+    uint64_t anchor_ns_{0};
+    double ns_per_tick_{1.0};
+
+public:
+    void calibrate(double tsc_ghz) noexcept {
+        timespec ts;
+        const uint64_t before = LatencyTracker::rdtscp();
+        clock_gettime(CLOCK_REALTIME, &ts);
+        const uint64_t after = LatencyTracker::rdtscp();
+        anchor_tsc_ = before + (after - before) / 2;
+        anchor_ns_ = static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+        ns_per_tick_ = tsc_ghz > 0.0 ? 1.0 / tsc_ghz : 1.0;
+    }
+
+    [[nodiscard]] uint64_t to_ns(uint64_t tsc) const noexcept {
+        const int64_t ticks = static_cast<int64_t>(tsc - anchor_tsc_);
+        return anchor_ns_ + static_cast<uint64_t>(static_cast<int64_t>(static_cast<double>(ticks) * ns_per_tick_));
+    }
+};
+
+/**
+ * Min-filtered offset + drift tracker for one channel
+ * Not thread-safe - owned by the consuming thread.
+ */
+class ClockSkewEstimator {
+public:
+    static constexpr size_t MAX_FIT = 32;
+    static constexpr int64_t MAX_DRIFT_PPB = 1000000;   // 1000 ppm - beyond that it is not drift
+
+private:
+    struct Point {
+        int64_t t;      // Local time of the window minimum
+        int64_t d;      // local - exchange at that point
+    };
+
+    ClockSkewConfig cfg_;
+    size_t fit_windows_{16};
+
+    bool started_{false};
+    int64_t window_start_{0};
+    int64_t window_min_{INT64_MAX};
+    int64_t window_min_t_{0};
+
+    Point points_[MAX_FIT];
+    size_t num_points_{0};
+    size_t next_point_{0};
+
+    // Offset model: base_d_ + (t - base_t_) * drift_ppb_ / 1e9
+    bool fitted_{false};
+    int64_t base_t_{0};
+    int64_t base_d_{0};
+    int64_t drift_ppb_{0};
+    int64_t last_offset_{0};
+
+    uint64_t samples_{0};
+    uint64_t below_floor_{0};
+
+public:
+    explicit ClockSkewEstimator(const ClockSkewConfig& cfg = ClockSkewConfig{}) noexcept {
+        configure(cfg);
+    }
+
+    void configure(const ClockSkewConfig& cfg) noexcept {
+        cfg_ = cfg;
+        fit_windows_ = cfg.fit_windows == 0 ? 1 : (cfg.fit_windows > MAX_FIT ? MAX_FIT : cfg.fit_windows);
+        started_ = false;
+        window_min_ = INT64_MAX;
+        num_points_ = 0;
+        next_point_ = 0;
+        fitted_ = false;
+        drift_ppb_ = 0;
+        samples_ = 0;
+        below_floor_ = 0;
+    }
+
+    /**
+     * One packet
+     *
+     * @param exchange_ns Exchange send timestamp
+     * @param local_ns    Local receive time (LocalClock)
+     * @return Estimated one-way latency in ns
+     */
+    uint64_t observe(uint64_t exchange_ns, uint64_t local_ns) noexcept {
+        const int64_t t = static_cast<int64_t>(local_ns);
+        const int64_t d = static_cast<int64_t>(local_ns - exchange_ns);
+
+        if (!started_) [[unlikely]] {
+            started_ = true;
+            window_start_ = t;
+        }
+        if (t - window_start_ >= static_cast<int64_t>(cfg_.window_ns)) [[unlikely]] {
+            close_window(t);
+        }
+        if (d < window_min_) {
+            window_min_ = d;
+            window_min_t_ = t;
+        }
+        samples_++;
+
+        // Until the first window closes the running minimum is the best guess
+        last_offset_ = fitted_ ? predict(t) : window_min_;
+        int64_t latency = d - last_offset_;
+        if (latency < 0) {
+            // Faster than the modelled floor - offset stepped or drift is off;
+            // the next window close refits
+            below_floor_++;
+            latency = 0;
+        }
+        return static_cast<uint64_t>(latency) + cfg_.path_floor_ns;
+    }
+
+    /**
+     * local - exchange floor at the last sample (offset + path floor)
+     */
+    [[nodiscard]] int64_t offset_ns() const noexcept { return last_offset_; }
+    [[nodiscard]] int64_t drift_ppb() const noexcept { return drift_ppb_; }
+    [[nodiscard]] bool fitted() const noexcept { return fitted_; }
+    [[nodiscard]] uint64_t samples() const noexcept { return samples_; }
+    [[nodiscard]] uint64_t below_floor() const noexcept { return below_floor_; }
+
+private:
+    [[nodiscard]] int64_t predict(int64_t t) const noexcept {
+        return base_d_ + (t - base_t_) * drift_ppb_ / 1000000000LL;
+    }
+
+    void close_window(int64_t now) noexcept {
+        if (window_min_ != INT64_MAX) {
+            points_[next_point_] = {window_min_t_, window_min_};
+            next_point_ = (next_point_ + 1) % fit_windows_;
+            if (num_points_ < fit_windows_) num_points_++;
+            refit();
+        }
+        window_min_ = INT64_MAX;
+        window_start_ = now;
+    }
+
+    /**
+     * Least squares through the window minima, then lowered so every
+     * minimum is on or above the line. Once per window - not hot.
+     */
+    void refit() noexcept {
+        const Point& newest = points_[(next_point_ + fit_windows_ - 1) % fit_windows_];
+        base_t_ = newest.t;
+
+        double slope = 0.0;
+        if (num_points_ >= 2) {
+            double sx = 0, sy = 0, sxx = 0, sxy = 0;
+            for (size_t i = 0; i < num_points_; ++i) {
+                const double x = static_cast<double>(points_[i].t - base_t_);
+                const double y = static_cast<double>(points_[i].d - newest.d);
+                sx += x;
+                sy += y;
+                sxx += x * x;
+                sxy += x * y;
+            }
+            const double n = static_cast<double>(num_points_);
+            const double var = sxx - sx * sx / n;
+            if (var > 0.0) {
+                slope = (sxy - sx * sy / n) / var;
+            }
+        }
+        int64_t ppb = static_cast<int64_t>(slope * 1e9);
+        if (ppb > MAX_DRIFT_PPB) ppb = MAX_DRIFT_PPB;
+        if (ppb < -MAX_DRIFT_PPB) ppb = -MAX_DRIFT_PPB;
+        drift_ppb_ = ppb;
+
+        // Lower envelope: line through the newest minimum, shifted down to
+        // the lowest point
+        base_d_ = newest.d;
+        int64_t lowest = 0;
+        for (size_t i = 0; i < num_points_; ++i) {
+            const int64_t below = points_[i].d - predict(points_[i].t);
+            if (below < lowest) lowest = below;
+        }
+        base_d_ += lowest;
+        fitted_ = true;
+    }
+};
+
+/**
+ * Per-channel exchange -> receive and receive -> engine latency
+ *
+ * on_event() runs on the engine thread (a clock conversion, the estimator
+ * and two histogram increments). The published fields are relaxed atomics
+ * so any thread can watch a channel live; the histograms are read by the
+ * owner (print() after the engine stops).
+ */
+class ClockSkewMonitor {
+public:
+    static constexpr size_t MAX_CHANNELS = 16;
+
+    struct Channel {
+        ClockSkewEstimator estimator;
+        LatencyHistogram wire_ns;       // Exchange -> receive
+        LatencyHistogram internal_ns;   // Receive -> engine pop
+
+        // Live view for other threads
+        alignas(64) std::atomic<uint64_t> samples{0};
+        std::atomic<uint64_t> wire_ewma_ns{0};      // 1/16 EWMA of exchange -> receive
+        std::atomic<uint64_t> last_exchange_ns{0};  // Newest exchange timestamp seen
+        std::atomic<int64_t> offset_ns{0};
+        std::atomic<int64_t> drift_ppb{0};
+    };
+
+private:
+    ClockSkewConfig cfg_;
+    LocalClock clock_;
+    double tsc_ghz_{3.0};
+    std::unique_ptr<Channel[]> channels_;
+
+public:
+    explicit ClockSkewMonitor(const ClockSkewConfig& cfg = ClockSkewConfig{})
+        : cfg_(cfg), channels_(std::make_unique<Channel[]>(MAX_CHANNELS)) {
+        for (size_t i = 0; i < MAX_CHANNELS; ++i) {
+            channels_[i].estimator.configure(cfg_);
+        }
+    }
+
+    /**
+     * Anchor the local clock - on the consuming thread, before the first event
+     */
+    void start(double tsc_ghz) noexcept {
+        tsc_ghz_ = tsc_ghz;
+        clock_.calibrate(tsc_ghz);
+    }
+
+    /**
+     * @param pop_tsc When the engine popped the event
+     */
+    void on_event(const MarketEvent& event, uint64_t pop_tsc) noexcept {
+        Channel& ch = channels_[event.channel_id & (MAX_CHANNELS - 1)];
+
+        const uint64_t local_ns = clock_.to_ns(event.recv_timestamp_ns);
+        const uint64_t exchange_ns = cfg_.exchange_is_local_tsc
+            ? clock_.to_ns(event.exchange_timestamp_ns)
+            : event.exchange_timestamp_ns;
+
+        const uint64_t wire = ch.estimator.observe(exchange_ns, local_ns);
+        ch.wire_ns.record(wire);
+        ch.internal_ns.record(LatencyTracker::tsc_to_ns(pop_tsc - event.recv_timestamp_ns, tsc_ghz_));
+
+        // Single writer - plain load/store, no RMW
+        const uint64_t ewma = ch.wire_ewma_ns.load(std::memory_order_relaxed);
+        ch.wire_ewma_ns.store(ewma + (static_cast<int64_t>(wire - ewma) >> 4), std::memory_order_relaxed);
+        ch.last_exchange_ns.store(exchange_ns, std::memory_order_relaxed);
+        ch.offset_ns.store(ch.estimator.offset_ns(), std::memory_order_relaxed);
+        ch.drift_ppb.store(ch.estimator.drift_ppb(), std::memory_order_relaxed);
+        // Release: readers that see samples > 0 also see the anchored clock
+        ch.samples.store(ch.samples.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    [[nodiscard]] const Channel& channel(uint8_t channel_id) const noexcept {
+        return channels_[channel_id & (MAX_CHANNELS - 1)];
+    }
+
+    /**
+     * Local time of a TSC reading on the monitor's clock
+     */
+    [[nodiscard]] uint64_t local_ns(uint64_t tsc) const noexcept {
+        return clock_.to_ns(tsc);
+    }
+
+    /**
+     * Per-channel summary - which side of the NIC the latency is on
+     */
+    void print() const {
+        for (size_t i = 0; i < MAX_CHANNELS; ++i) {
+            const Channel& ch = channels_[i];
+            if (ch.wire_ns.count() == 0) continue;
+
+            printf("[ClockSkew] Channel %zu - offset %ld ns, drift %.3f ppm, %lu below floor\n",
+                   i, static_cast<long>(ch.estimator.offset_ns()),
+                   static_cast<double>(ch.estimator.drift_ppb()) / 1000.0, ch.estimator.below_floor());
+            char name[48];
+            snprintf(name, sizeof(name), "  ch%zu exchange->recv", i);
+            ch.wire_ns.print(name);
+            snprintf(name, sizeof(name), "  ch%zu recv->engine", i);
+            ch.internal_ns.print(name);
+
+            const uint64_t wire_p99 = ch.wire_ns.percentile(99.0);
+            const uint64_t internal_p99 = ch.internal_ns.percentile(99.0);
+            printf("[ClockSkew] Channel %zu - p99 tail is %s\n", i,
+                   wire_p99 >= internal_p99 ? "upstream (network / exchange / NIC)" : "local (our code)");
+        }
+    }
+};
+
+} // namespace hft
@@ -0,0 +1,272 @@
+#pragma once
+
+#include "spsc_queue.hpp"
+#include "types.hpp"
+#include "utils.hpp"
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+
+namespace hft {
+
+/**
+ * Timestamp-Ordered Merge of Several Event Queues
+ *
+ * One engine consuming several feed handlers (venues, channels) gets one
+ * queue per feed and no global order. The merger holds the head event of
+ * every input and emits the smallest key - exchange timestamp or receive
+ * TSC - through a loser tree (tournament tree) of input indices:
+ *
+ *   tree_[0]        overall winner
+ *   tree_[1..P-1]   loser of the match at that node, P = inputs rounded up
+ *                   to a power of two
+ *
+ * After emitting, the winner's input is refilled and only its leaf-to-root
+ * path is replayed - log2(P) compares against cached keys, one per level,
+ * no pointer chasing. That shortcut holds for the winner's leaf only: an
+ * empty input receiving an event (or a drain) rebuilds the tree, O(P),
+ * on the path that is about to wait anyway. Keys, tree and bookkeeping for
+ * 16 inputs fit in three cache lines; head events sit in their own line each.
+ *
+ * Bounded wait: while an input is empty, its next event could still sort
+ * first, so the winner is held until its age (now - receive TSC) reaches
+ * wait_ns, then emitted anyway. wait_ns trades added latency for order:
+ * cover feed-to-feed processing skew for RECV_TSC, cross-venue clock and
+ * path skew for EXCHANGE_TS. An event that still arrives behind an emitted
+ * key is emitted as-is and counted late (never dropped). With every input
+ * non-empty, nothing waits.
+ *
+ * Single consumer (the engine thread); each input keeps its own producer.
+ */
+enum class MergeKey : uint8_t {
+    EXCHANGE_TS,    // exchange_timestamp_ns - venue order
+    RECV_TSC        // recv_timestamp_ns - our arrival order
+};
+
+struct EventMergerConfig {
+    MergeKey key{MergeKey::EXCHANGE_TS};
+    uint64_t wait_ns{20000};        // Hold the winner this long for empty inputs
+};
+
+template<typename Queue = SPSCQueue<MarketEvent, 65536>, size_t MaxInputs = 16>
+class EventMerger {
+    static_assert(MaxInputs >= 2 && MaxInputs <= 32 && std::has_single_bit(MaxInputs),
+                  "MaxInputs: power of two, at most 32 (empty-input mask)");
+
+public:
+    static constexpr uint64_t NO_EVENT = UINT64_MAX;
+
+private:
+    // Hot bookkeeping - keys, tree and masks: three lines at 16 inputs
+    alignas(64) uint64_t key_[MaxInputs];       // Head key per input, NO_EVENT if none staged
+    alignas(64) uint8_t tree_[MaxInputs];       // Loser tree (see above)
+    uint32_t empty_mask_{0};                    // Inputs with nothing staged
+    uint32_t leaves_{1};                        // P
+    uint32_t num_inputs_{0};
+    uint64_t wait_ticks_{0};
+    uint64_t last_key_{0};
+    MergeKey key_kind_;
+
+    Queue* inputs_[MaxInputs]{};
+    alignas(64) MarketEvent head_[MaxInputs];
+
+    EventMergerConfig cfg_;
+
+    // Stats (owner thread)
+    uint64_t emitted_{0};
+    uint64_t late_{0};
+    uint64_t forced_{0};            // Emitted on wait expiry with an input empty
+
+public:
+    explicit EventMerger(const EventMergerConfig& cfg = EventMergerConfig{}) noexcept
+        : key_kind_(cfg.key), cfg_(cfg) {
+        set_tsc_ghz(3.0);
+        for (size_t i = 0; i < MaxInputs; ++i) {
+            key_[i] = NO_EVENT;
+        }
+        rebuild();
+    }
+
+    EventMerger(const EventMerger&) = delete;
+    EventMerger& operator=(const EventMerger&) = delete;
+
+    /**
+     * Add an input queue - before the consumer starts
+     * @return false when MaxInputs are in use
+     */
+    bool add_input(Queue& queue) noexcept {
+        if (num_inputs_ == MaxInputs) {
+            return false;
+        }
+        const uint32_t index = num_inputs_++;
+        inputs_[index] = &queue;
+        key_[index] = NO_EVENT;
+        empty_mask_ |= 1u << index;
+        leaves_ = std::bit_ceil(num_inputs_ < 2 ? 2u : num_inputs_);
+        rebuild();
+        return true;
+    }
+
+    /**
+     * Wait window in TSC ticks - call from the consumer after calibrating
+     */
+    void set_tsc_ghz(double tsc_ghz) noexcept {
+        wait_ticks_ = static_cast<uint64_t>(static_cast<double>(cfg_.wait_ns) * tsc_ghz);
+    }
+
+    /**
+     * Next event in key order, if one may be emitted now
+     *
+     * Hot path with every input non-empty: one winner copy, one pop to
+     * refill, log2(P) compares. Empty inputs cost a try_pop each per call
+     * (a cached index compare, then one producer-line load).
+     */
+    [[nodiscard]] inline bool poll(MarketEvent& out) noexcept {
+        if (empty_mask_ != 0) [[unlikely]] {
+            refill_empty();
+        }
+
+        const uint32_t winner = tree_[0];
+        const uint64_t key = key_[winner];
+        if (key == NO_EVENT) {
+            return false;
+        }
+        if (empty_mask_ != 0) [[unlikely]] {
+            // Someone may still hold an earlier event - wait out the window
+            if (LatencyTracker::rdtsc() - head_[winner].recv_timestamp_ns < wait_ticks_) {
+                return false;
+            }
+            forced_++;
+        }
+
+        out = head_[winner];
+        if (key < last_key_) [[unlikely]] {
+            late_++;
+        } else {
+            last_key_ = key;
+        }
+        emitted_++;
+
+        stage(winner);
+        replay(winner);
+        return true;
+    }
+
+    /**
+     * Unordered pass-through: staged heads first, then straight from the
+     * queues, never holding anything back
+     *
+     * For the engine's warmup: each feed finishes warming once its queue is
+     * empty, which must mean the consumer has every synthetic event in hand
+     * - an event parked in a head slot by poll() would surface after the
+     * last feed flips LIVE.
+     */
+    [[nodiscard]] bool drain(MarketEvent& out) noexcept {
+        for (uint32_t i = 0; i < num_inputs_; ++i) {
+            if (key_[i] != NO_EVENT) {
+                out = head_[i];
+                key_[i] = NO_EVENT;
+                empty_mask_ |= 1u << i;
+                rebuild();
+                return true;
+            }
+        }
+        for (uint32_t i = 0; i < num_inputs_; ++i) {
+            if (inputs_[i]->try_pop(out)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    [[nodiscard]] size_t inputs() const noexcept { return num_inputs_; }
+    [[nodiscard]] uint64_t emitted() const noexcept { return emitted_; }
+    [[nodiscard]] uint64_t late() const noexcept { return late_; }
+    [[nodiscard]] uint64_t forced() const noexcept { return forced_; }
+
+    void print() const {
+        printf("[EventMerger] %u inputs (%s order, wait %lu ns): %lu emitted, %lu late, %lu after wait expiry\n",
+               num_inputs_, key_kind_ == MergeKey::EXCHANGE_TS ? "exchange" : "receive",
+               cfg_.wait_ns, emitted_, late_, forced_);
+    }
+
+private:
+    [[nodiscard]] inline uint64_t key_of(const MarketEvent& event) const noexcept {
+        return key_kind_ == MergeKey::EXCHANGE_TS ? event.exchange_timestamp_ns : event.recv_timestamp_ns;
+    }
+
+    /**
+     * Pop input's next event into its head slot (or mark it empty)
+     */
+    inline void stage(uint32_t input) noexcept {
+        if (inputs_[input]->try_pop(head_[input])) {
+            key_[input] = key_of(head_[input]);
+        } else {
+            key_[input] = NO_EVENT;
+            empty_mask_ |= 1u << input;
+        }
+    }
+
+    [[gnu::noinline]] void refill_empty() noexcept {
+        const uint32_t before = empty_mask_;
+        uint32_t mask = before;
+        while (mask != 0) {
+            const uint32_t input = static_cast<uint32_t>(std::countr_zero(mask));
+            mask &= mask - 1;
+            if (inputs_[input]->try_pop(head_[input])) {
+                key_[input] = key_of(head_[input]);
+                empty_mask_ &= ~(1u << input);
+            }
+        }
+        if (empty_mask_ != before) {
+            rebuild();
+        }
+    }
+
+    /**
+     * Ties go to the lower input index - deterministic order
+     * Bitwise, not short-circuit: which input wins is data-dependent, so a
+     * branch here mispredicts about half the time (setcc + cmov instead)
+     */
+    [[nodiscard]] inline bool beats(uint32_t a, uint32_t b) const noexcept {
+        const uint64_t ka = key_[a];
+        const uint64_t kb = key_[b];
+        return (ka < kb) | ((ka == kb) & (a < b));
+    }
+
+    /**
+     * Re-run the matches on the winner's path after its key changed
+     * (the stored losers are exactly its opponents)
+     */
+    inline void replay(uint32_t input) noexcept {
+        uint32_t winner = input;
+        for (uint32_t node = (input + leaves_) >> 1; node != 0; node >>= 1) {
+            const uint32_t loser = tree_[node];
+            const bool swap = beats(loser, winner);
+            tree_[node] = static_cast<uint8_t>(swap ? winner : loser);
+            winner = swap ? loser : winner;
+        }
+        tree_[0] = static_cast<uint8_t>(winner);
+    }
+
+    /**
+     * Full bottom-up build - setup, and any key change off the winner's
+     * leaf; padding leaves never win
+     */
+    void rebuild() noexcept {
+        uint8_t winners[2 * MaxInputs];
+        for (uint32_t leaf = 0; leaf < leaves_; ++leaf) {
+            winners[leaves_ + leaf] = static_cast<uint8_t>(leaf);
+        }
+        for (uint32_t node = leaves_ - 1; node != 0; --node) {
+            const uint8_t left = winners[2 * node];
+            const uint8_t right = winners[2 * node + 1];
+            const bool left_wins = beats(left, right);
+            winners[node] = left_wins ? left : right;
+            tree_[node] = left_wins ? right : left;
+        }
+        tree_[0] = winners[1];
+    }
+};
+
+} // namespace hft
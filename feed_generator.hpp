@@ -0,0 +1,354 @@
+#pragma once
+
+#include "types.hpp"
+#include "utils.hpp"
+#include "market_scenario.hpp"
+#include <iostream>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <errno.h>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstring>
+
+namespace hft {
+
+/**
+ * Fill a TRADE packet from one 64-bit random draw
+ * Shared by the paced generator and the high-rate senders
+ */
+inline void fill_trade_packet(MarketDataPacket& packet, uint64_t seq, uint64_t rand) {
+    std::memset(&packet, 0, sizeof(packet));
+    
+    packet.msg_type = MessageType::TRADE;
+    packet.version = 1;
+    packet.payload_size = sizeof(TradeMessage);
+    packet.packet_sequence = seq;
+    
+    // Fill in trade data
+    auto& trade = packet.payload.trade;
+    trade.timestamp_ns = LatencyTracker::rdtsc();
+    trade.sequence_num = seq;
+    trade.symbol_id = 12345; // AAPL
+    trade.trade_id = seq;
+    trade.price = 1500000 + (rand % 10000); // $150.00 +/- $1.00
+    trade.quantity = 100 + ((rand >> 16) % 1000);
+    trade.side = ((rand >> 40) & 1) == 0 ? 'B' : 'S';
+}
+
+/**
+ * TSC-driven token bucket for busy-wait pacing
+ * 
+ * sleep_until() has ~50us granularity and wakes late under load - useless
+ * above ~20K pps. Reading the TSC in a spin loop paces to within a few
+ * nanoseconds and lets the sender batch whatever tokens have accrued.
+ * 
+ * - rate: sustained packets/sec
+ * - depth: how many tokens can accumulate while the sender is busy
+ * - add(): inject extra tokens above depth (microbursts)
+ * 
+ * Burst tokens are held apart from the capped refill and spent after it,
+ * so elapsed time keeps converting at the full rate while a burst drains
+ * - the sustained rate does not dip after each burst.
+ */
+class TscTokenBucket {
+private:
+    double tokens_per_tick_;
+    double depth_;
+    double tokens_{0.0};            // Refill, capped at depth
+    double burst_tokens_{0.0};      // From add(), uncapped
+    uint64_t last_tsc_;
+
+public:
+    TscTokenBucket(double rate_per_sec, double depth, double tsc_ghz) noexcept
+        : tokens_per_tick_(rate_per_sec / (tsc_ghz * 1e9))
+        , depth_(depth)
+        , last_tsc_(LatencyTracker::rdtsc()) {}
+    
+    /**
+     * Refill from elapsed TSC ticks and take up to max whole tokens
+     */
+    uint32_t acquire(uint32_t max, uint64_t now_tsc) noexcept {
+        const double refill = static_cast<double>(now_tsc - last_tsc_) * tokens_per_tick_;
+        last_tsc_ = now_tsc;
+        tokens_ = std::min(tokens_ + refill, depth_);
+        
+        const uint32_t n = static_cast<uint32_t>(std::min(tokens_ + burst_tokens_, static_cast<double>(max)));
+        const double from_refill = std::min(tokens_, static_cast<double>(n));
+        tokens_ -= from_refill;
+        burst_tokens_ -= n - from_refill;
+        return n;
+    }
+    
+    void add(double tokens) noexcept {
+        burst_tokens_ += tokens;
+    }
+};
+
+/**
+ * High-rate generator configuration
+ */
+struct HighRateConfig {
+    std::string multicast_ip{"233.54.12.1"};
+    uint16_t base_port{15000};
+    uint32_t packets_per_second{1000000};   // Per sender thread
+    uint64_t total_packets{0};              // Per sender thread, 0 = infinite
+    uint32_t batch_size{32};                // Datagrams per sendmmsg call
+    uint32_t num_threads{1};                // One channel (port) per thread
+    uint32_t burst_packets{0};              // Microburst size, 0 = none
+    uint32_t burst_interval_us{1000};       // Time between microbursts
+    int first_core{-1};                     // Pin thread i to first_core + i
+    bool use_scenario{false};               // Scenario content + Hawkes timing
+    ScenarioConfig scenario;
+    uint32_t signal_every{0};               // Every Nth trade is a strategy signal, 0 = none
+};
+
+/**
+ * Per-thread counters, one cache line each (read by reporting thread)
+ */
+struct alignas(64) SenderStats {
+    std::atomic<uint64_t> packets_sent{0};
+    std::atomic<uint64_t> syscalls{0};
+    std::atomic<uint64_t> would_block{0};
+    std::atomic<bool> done{false};
+};
+
+/**
+ * High-Rate Sender - one channel, one thread
+ * 
+ * - sendmmsg() pushes a whole batch per syscall (~1us amortized over 32 packets)
+ * - Packet buffers and mmsghdr vectors built once, only headers rewritten per send
+ * - Send timestamp (TSC) stamped into each packet as the batch is built,
+ *   once pacing has released it (scenario mode: its scheduled send time);
+ *   EAGAIN retries do not restamp
+ * - Sequence numbers are clean per channel (anomaly injection lives in paced mode)
+ */
+class HighRateSender {
+private:
+    int socket_fd_{-1};
+    sockaddr_in dest_addr_{};
+    uint64_t sequence_{1};
+    uint64_t rng_state_;
+    
+    std::vector<MarketDataPacket> packets_;
+    std::vector<iovec> iovecs_;
+    std::vector<mmsghdr> msgs_;
+
+public:
+    explicit HighRateSender(uint64_t seed) : rng_state_(seed | 1) {}
+    
+    ~HighRateSender() {
+        if (socket_fd_ >= 0) {
+            close(socket_fd_);
+        }
+    }
+    
+    HighRateSender(const HighRateSender&) = delete;
+    HighRateSender& operator=(const HighRateSender&) = delete;
+    
+    bool initialize(const std::string& ip, uint16_t port, uint32_t batch_size) {
+        socket_fd_ = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (socket_fd_ < 0) {
+            std::cerr << "[HighRate] Failed to create socket" << std::endl;
+            return false;
+        }
+        
+        int ttl = 1;
+        setsockopt(socket_fd_, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+        
+        // Large send buffer absorbs bursts without EAGAIN
+        int sndbuf = 16 * 1024 * 1024;
+        setsockopt(socket_fd_, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+        
+        dest_addr_.sin_family = AF_INET;
+        dest_addr_.sin_port = htons(port);
+        if (inet_pton(AF_INET, ip.c_str(), &dest_addr_.sin_addr) != 1) {
+            std::cerr << "[HighRate] Invalid address " << ip << std::endl;
+            return false;
+        }
+        
+        // Pre-build batch vectors - nothing allocated in the send loop
+        packets_.resize(batch_size);
+        iovecs_.resize(batch_size);
+        msgs_.resize(batch_size);
+        for (uint32_t i = 0; i < batch_size; ++i) {
+            iovecs_[i].iov_base = &packets_[i];
+            iovecs_[i].iov_len = sizeof(MarketDataPacket);
+            std::memset(&msgs_[i], 0, sizeof(mmsghdr));
+            msgs_[i].msg_hdr.msg_name = &dest_addr_;
+            msgs_[i].msg_hdr.msg_namelen = sizeof(dest_addr_);
+            msgs_[i].msg_hdr.msg_iov = &iovecs_[i];
+            msgs_[i].msg_hdr.msg_iovlen = 1;
+        }
+        
+        return true;
+    }
+    
+    /**
+     * Busy-paced send loop - runs until total_packets sent or stop is set
+     */
+    void run(const HighRateConfig& cfg, double tsc_ghz, SenderStats& stats,
+             const std::atomic<bool>& stop) {
+        if (cfg.use_scenario) {
+            run_scenario(cfg, tsc_ghz, stats, stop);
+            return;
+        }
+        
+        TscTokenBucket bucket(cfg.packets_per_second, cfg.batch_size, tsc_ghz);
+        
+        const uint64_t burst_interval_tsc =
+            static_cast<uint64_t>(cfg.burst_interval_us * 1000.0 * tsc_ghz);
+        uint64_t next_burst_tsc = LatencyTracker::rdtsc() + burst_interval_tsc;
+        uint64_t sent = 0;
+        
+        while (!stop.load(std::memory_order_relaxed) &&
+               (cfg.total_packets == 0 || sent < cfg.total_packets)) {
+            const uint64_t now = LatencyTracker::rdtsc();
+            
+            if (cfg.burst_packets > 0 && now >= next_burst_tsc) {
+                bucket.add(cfg.burst_packets);
+                next_burst_tsc += burst_interval_tsc;
+            }
+            
+            uint32_t n = bucket.acquire(cfg.batch_size, now);
+            if (n == 0) {
+                SpinWait::pause();
+                continue;
+            }
+            if (cfg.total_packets != 0 && sent + n > cfg.total_packets) {
+                n = static_cast<uint32_t>(cfg.total_packets - sent);
+            }
+            
+            for (uint32_t i = 0; i < n; ++i) {
+                fill_trade_packet(packets_[i], sequence_, next_random());
+                if (cfg.signal_every != 0 && sequence_ % cfg.signal_every == 0) {
+                    make_signal(packets_[i]);
+                }
+                sequence_++;
+            }
+            
+            uint32_t accepted = 0;
+            const bool ok = send_batch(n, stats, stop, accepted);
+            sent += accepted;
+            stats.packets_sent.store(sent, std::memory_order_relaxed);
+            if (!ok) {
+                break;
+            }
+        }
+        
+        stats.done.store(true, std::memory_order_release);
+    }
+
+    /**
+     * Scenario-paced loop - every packet leaves at its simulated arrival time
+     * 
+     * Hawkes bursts and auction spikes come through as real microbursts: all
+     * packets already due are batched into one sendmmsg, the first packet not
+     * yet due is staged until the TSC reaches it.
+     */
+    void run_scenario(const HighRateConfig& cfg, double tsc_ghz, SenderStats& stats,
+                      const std::atomic<bool>& stop) {
+        ScenarioConfig scenario_cfg = cfg.scenario;
+        scenario_cfg.mean_rate = cfg.packets_per_second;
+        if (!scenario_cfg.valid()) {
+            std::cerr << "[HighRate] Invalid scenario config" << std::endl;
+            stats.done.store(true, std::memory_order_release);
+            return;
+        }
+        MarketScenario scenario(scenario_cfg, rng_state_);
+        
+        // Exchange timestamp = TSC at the scheduled send, like the uniform
+        // senders' rdtsc() stamp
+        const uint64_t start_tsc = LatencyTracker::rdtsc();
+        scenario.set_clock(start_tsc, tsc_ghz);
+        MarketDataPacket staged;
+        uint64_t staged_due_tsc = start_tsc +
+            static_cast<uint64_t>(scenario.next(staged, sequence_++) * tsc_ghz);
+        uint64_t sent = 0;
+        
+        while (!stop.load(std::memory_order_relaxed) &&
+               (cfg.total_packets == 0 || sent < cfg.total_packets)) {
+            uint32_t n = 0;
+            while (n < cfg.batch_size && LatencyTracker::rdtsc() >= staged_due_tsc &&
+                   (cfg.total_packets == 0 || sent + n < cfg.total_packets)) {
+                packets_[n++] = staged;
+                staged_due_tsc = start_tsc +
+                    static_cast<uint64_t>(scenario.next(staged, sequence_++) * tsc_ghz);
+            }
+            
+            if (n == 0) {
+                SpinWait::pause();
+                continue;
+            }
+            
+            uint32_t accepted = 0;
+            const bool ok = send_batch(n, stats, stop, accepted);
+            sent += accepted;
+            stats.packets_sent.store(sent, std::memory_order_relaxed);
+            if (!ok) {
+                break;
+            }
+        }
+        
+        const auto& ss = scenario.stats();
+        std::cout << "[HighRate] Scenario mix - Adds: " << ss.adds << ", Cancels: " << ss.cancels
+                  << ", Modifies: " << ss.modifies << ", Trades: " << ss.trades
+                  << ", Quotes: " << ss.quotes << ", Excited: " << ss.excited_events << std::endl;
+        
+        stats.done.store(true, std::memory_order_release);
+    }
+
+private:
+    /**
+     * Large buy print - trips TradingEngine::handle_trade's signal
+     */
+    static void make_signal(MarketDataPacket& packet) noexcept {
+        packet.payload.trade.side = 'B';
+        packet.payload.trade.quantity = 20000;
+    }
+    
+    // xorshift64* - a few cycles, good enough for synthetic prices
+    uint64_t next_random() noexcept {
+        rng_state_ ^= rng_state_ >> 12;
+        rng_state_ ^= rng_state_ << 25;
+        rng_state_ ^= rng_state_ >> 27;
+        return rng_state_ * 0x2545F4914F6CDD1DULL;
+    }
+    
+    /**
+     * Send n prepared packets, retrying partial sends and backpressure
+     * (EAGAIN / ENOBUFS) until done or stop is set
+     * @param accepted Packets the kernel took, also when returning false
+     * @return false on hard socket error or stop
+     */
+    bool send_batch(uint32_t n, SenderStats& stats, const std::atomic<bool>& stop, uint32_t& accepted) {
+        uint32_t offset = 0;
+        while (offset < n) {
+            const int rc = sendmmsg(socket_fd_, &msgs_[offset], n - offset, MSG_DONTWAIT);
+            stats.syscalls.fetch_add(1, std::memory_order_relaxed);
+            
+            if (rc < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) {
+                    stats.would_block.fetch_add(1, std::memory_order_relaxed);
+                    if (stop.load(std::memory_order_relaxed)) {
+                        accepted = offset;
+                        return false;
+                    }
+                    SpinWait::pause();
+                    continue;
+                }
+                std::cerr << "[HighRate] sendmmsg failed: " << strerror(errno) << std::endl;
+                accepted = offset;
+                return false;
+            }
+            offset += static_cast<uint32_t>(rc);
+        }
+        accepted = offset;
+        return true;
+    }
+};
+
+} // namespace hft
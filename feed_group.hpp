@@ -0,0 +1,375 @@
+#pragma once
+
+#include "feed_handler_impl.hpp"
+#include "utils.hpp"
+#include "logger.hpp"
+#include "watchdog.hpp"
+#include "warmup.hpp"
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+
+namespace hft {
+
+// External global for shutdown signaling
+extern std::atomic<bool> g_running;
+
+/**
+ * Hybrid Busy-Poll / epoll Feed Group
+ *
+ * One pinned core serving many channels. A busy-polling core per feed is
+ * right for the liquid channels and a waste for the long tail, so each
+ * channel is either:
+ *
+ *   hot   polled every loop iteration (poll_once, as FeedHandler::run)
+ *   cold  parked in an epoll set that is checked with a zero timeout every
+ *         cold_check_interval iterations; readable channels are drained.
+ *         Cold sockets get SO_BUSY_POLL / SO_PREFER_BUSY_POLL so the check
+ *         picks packets off the device queue instead of waiting for softirq.
+ *
+ * Every rate_window_ns the measured message rate (the handler's
+ * messages_received(): MoldUDP64 message counts, one per packet for
+ * packet-sequenced protocols) moves channels between
+ * the two: promote at >= promote_rate, demote after demote_windows
+ * consecutive windows below demote_rate (hysteresis - a channel near one
+ * threshold does not flap).
+ *
+ * Cold channels pay up to cold_check_interval iterations of extra latency
+ * (plus a drain behind other cold channels); polling cost per iteration
+ * is proportional to the hot set only. Every channel keeps its own
+ * PacketManager and channel id. All handlers run on this thread, so they
+ * may share one event queue (it stays single-producer).
+ *
+ * A channel whose source reports a receive error is taken out of both
+ * sets and reported once; the others carry on.
+ *
+ * Handler: a BasicFeedHandler whose Source has fd() (UDPReceiver,
+ * RecvmmsgReceiver); enable_busy_poll() is used when present.
+ */
+struct FeedGroupConfig {
+    uint32_t cold_check_interval{64};       // Hot-loop iterations between epoll checks
+    uint64_t rate_window_ns{100000000};     // Rate measurement window (100ms)
+    uint64_t promote_rate{2000};            // msgs/s: cold -> hot
+    uint64_t demote_rate{200};              // msgs/s: hot -> cold
+    uint32_t demote_windows{3};             // Quiet windows before demotion
+    int busy_poll_us{50};                   // SO_BUSY_POLL on cold sockets (0 = off)
+    bool start_hot{false};                  // Initial placement
+};
+
+template<typename Handler>
+class FeedGroup {
+public:
+    static constexpr size_t MAX_CHANNELS = 64;
+
+private:
+    struct Channel {
+        Handler* handler{nullptr};
+        int fd{-1};
+        bool hot{false};
+        bool failed{false};             // Receive error - polled no more
+        uint32_t quiet_windows{0};
+        uint64_t window_packets{0};
+        uint64_t window_start_messages{0};
+        uint64_t rate{0};               // Last window, msgs/s
+        uint64_t packets{0};
+        uint64_t promotions{0};
+        uint64_t demotions{0};
+    };
+
+    FeedGroupConfig cfg_;
+    int core_id_;
+    int epoll_fd_{-1};
+
+    Channel channels_[MAX_CHANNELS];
+    size_t num_channels_{0};
+    uint8_t hot_[MAX_CHANNELS];         // Dense hot list for the poll loop
+    size_t num_hot_{0};
+
+    Heartbeat heartbeat_;
+
+    uint64_t epoll_checks_{0};
+    uint64_t cold_wakeups_{0};
+    bool busy_poll_ok_{true};
+
+public:
+    explicit FeedGroup(int core_id = 0, const FeedGroupConfig& cfg = FeedGroupConfig{}) noexcept
+        : cfg_(cfg), core_id_(core_id), epoll_fd_(epoll_create1(0)) {}
+
+    ~FeedGroup() {
+        if (epoll_fd_ >= 0) {
+            close(epoll_fd_);
+        }
+    }
+
+    FeedGroup(const FeedGroup&) = delete;
+    FeedGroup& operator=(const FeedGroup&) = delete;
+
+    /**
+     * Add an initialized handler - before run()
+     */
+    bool add(Handler& handler) noexcept {
+        if (epoll_fd_ < 0 || num_channels_ == MAX_CHANNELS) {
+            return false;
+        }
+        Channel& ch = channels_[num_channels_];
+        ch.handler = &handler;
+        ch.fd = handler.source().fd();
+        if (ch.fd < 0) {
+            return false;
+        }
+        if constexpr (requires { handler.source().enable_busy_poll(1); }) {
+            if (cfg_.busy_poll_us > 0 && !handler.source().enable_busy_poll(cfg_.busy_poll_us)) {
+                busy_poll_ok_ = false;
+            }
+        }
+        const uint8_t index = static_cast<uint8_t>(num_channels_++);
+        if (cfg_.start_hot) {
+            make_hot(index);
+        } else if (!make_cold(index)) {
+            num_channels_--;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Loop heartbeat - register with a Watchdog before run()
+     */
+    Heartbeat& heartbeat() noexcept {
+        return heartbeat_;
+    }
+
+    /**
+     * Group loop - runs on the group's core
+     *
+     * Warmup goes through the first handler only: every handler is the
+     * same template instantiation, so that trains the shared code, and
+     * warming later handlers after the system flips LIVE would feed
+     * synthetic events to a live engine. A group is one feed for
+     * begin_warmup().
+     */
+    void run() {
+        if (!ThreadUtils::pin_to_core(core_id_)) {
+            std::cerr << "[FeedGroup] Failed to pin to core " << core_id_ << std::endl;
+            LOG_WARN("FeedGroup: failed to pin to core - latency will be unpredictable");
+        }
+        if (!ThreadUtils::set_realtime_priority()) {
+            std::cerr << "[FeedGroup] SCHED_FIFO unavailable (needs CAP_SYS_NICE)" << std::endl;
+            LOG_WARN("FeedGroup: SCHED_FIFO unavailable - running at normal priority");
+        }
+        if (!busy_poll_ok_) {
+            std::cerr << "[FeedGroup] SO_BUSY_POLL refused (needs CAP_NET_ADMIN above net.core.busy_read)"
+                      << std::endl;
+        }
+
+        const double tsc_ghz = LatencyTracker::calibrate_tsc_ghz(20);
+        const uint64_t window_ticks = static_cast<uint64_t>(cfg_.rate_window_ns * tsc_ghz);
+
+        std::cout << "[FeedGroup] Started on core " << core_id_ << " - " << num_channels_
+                  << " channels, " << num_hot_ << " hot" << std::endl;
+        LOG_INFO("FeedGroup thread started");
+
+        Prefault::stack();
+        heartbeat_.attach("FeedGroup");
+        if (!is_live() && num_channels_ > 0) {
+            channels_[0].handler->warmup();
+        }
+
+        uint32_t until_cold_check = cfg_.cold_check_interval;
+        uint64_t window_start = LatencyTracker::rdtsc();
+        for (size_t i = 0; i < num_channels_; ++i) {
+            channels_[i].window_start_messages = channels_[i].handler->messages_received();
+        }
+
+        while (g_running.load(std::memory_order_acquire)) {
+            heartbeat_.beat();
+            const uint64_t now = LatencyTracker::rdtsc();
+            bool received = false;
+
+            for (size_t i = 0; i < num_hot_; ++i) {
+                Channel& ch = channels_[hot_[i]];
+                const ssize_t bytes = ch.handler->poll_once(now);
+                if (bytes > 0) {
+                    ch.window_packets++;
+                    received = true;
+                } else if (bytes < 0) [[unlikely]] {
+                    fail(hot_[i--]);    // Swaps the last hot channel into slot i
+                }
+            }
+
+            if (--until_cold_check == 0) [[unlikely]] {
+                until_cold_check = cfg_.cold_check_interval;
+                received |= poll_cold(now);
+            }
+
+            if (now - window_start >= window_ticks) [[unlikely]] {
+                rebalance(now - window_start, tsc_ghz);
+                window_start = now;
+            }
+
+            if (!received) {
+                SpinWait::pause();
+            }
+        }
+
+        heartbeat_.detach();
+        for (size_t i = 0; i < num_channels_; ++i) {
+            channels_[i].handler->filter_offline();
+        }
+        print();
+        std::cout << "[FeedGroup] Stopped" << std::endl;
+    }
+
+    [[nodiscard]] size_t channels() const noexcept { return num_channels_; }
+    [[nodiscard]] size_t hot_channels() const noexcept { return num_hot_; }
+    [[nodiscard]] bool is_hot(size_t index) const noexcept { return channels_[index].hot; }
+    [[nodiscard]] uint64_t epoll_checks() const noexcept { return epoll_checks_; }
+    [[nodiscard]] uint64_t cold_wakeups() const noexcept { return cold_wakeups_; }
+
+    /**
+     * Per-channel placement and rates - after run() returns
+     */
+    void print() const {
+        printf("[FeedGroup] %zu channels (%zu hot), %lu epoll checks, %lu cold wakeups\n",
+               num_channels_, num_hot_, epoll_checks_, cold_wakeups_);
+        for (size_t i = 0; i < num_channels_; ++i) {
+            const Channel& ch = channels_[i];
+            printf("[FeedGroup]   ch%zu %-4s %lu msgs/s (last window), %lu packets, %lu promotions, %lu demotions\n",
+                   i, ch.failed ? "err" : ch.hot ? "hot" : "cold", ch.rate, ch.packets + ch.window_packets, ch.promotions, ch.demotions);
+        }
+    }
+
+private:
+    /**
+     * Zero-timeout epoll check: drain readable cold channels, and give
+     * every cold handler its housekeeping timers (they are not polled)
+     */
+    bool poll_cold(uint64_t now) {
+        if (num_hot_ == num_channels_) {
+            return false;
+        }
+        epoll_checks_++;
+
+        epoll_event events[MAX_CHANNELS];
+        const int ready = epoll_wait(epoll_fd_, events, static_cast<int>(MAX_CHANNELS), 0);
+        for (int e = 0; e < ready; ++e) {
+            Channel& ch = channels_[events[e].data.u32];
+            cold_wakeups_++;
+            // Level-triggered, but a batching source may hold datagrams in
+            // user space - drain until the source itself reports empty
+            ssize_t bytes;
+            while ((bytes = ch.handler->poll_once(now)) > 0) {
+                ch.window_packets++;
+            }
+            if (bytes < 0) [[unlikely]] {
+                fail(static_cast<uint8_t>(events[e].data.u32));
+            }
+        }
+
+        for (size_t i = 0; i < num_channels_; ++i) {
+            if (!channels_[i].hot && !channels_[i].failed) {
+                channels_[i].handler->service_timers(now);
+            }
+        }
+        return ready > 0;
+    }
+
+    /**
+     * Rate per channel over the closed window; move channels across
+     */
+    void rebalance(uint64_t window_ticks, double tsc_ghz) {
+        const uint64_t window_ns = LatencyTracker::tsc_to_ns(window_ticks, tsc_ghz);
+        if (window_ns == 0) {
+            return;
+        }
+        for (size_t i = 0; i < num_channels_; ++i) {
+            Channel& ch = channels_[i];
+            const uint64_t messages = ch.handler->messages_received();
+            ch.rate = (messages - ch.window_start_messages) * 1000000000ULL / window_ns;
+            ch.window_start_messages = messages;
+            ch.packets += ch.window_packets;
+            ch.window_packets = 0;
+            if (ch.failed) {
+                continue;
+            }
+
+            const uint8_t index = static_cast<uint8_t>(i);
+            if (!ch.hot) {
+                if (ch.rate >= cfg_.promote_rate) {
+                    (void)epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, ch.fd, nullptr);
+                    make_hot(index);
+                    ch.promotions++;
+                    log_move(i, "promoted to hot");
+                }
+            } else if (ch.rate < cfg_.demote_rate) {
+                if (++ch.quiet_windows >= cfg_.demote_windows && make_cold(index)) {
+                    ch.demotions++;
+                    log_move(i, "demoted to cold");
+                }
+            } else {
+                ch.quiet_windows = 0;
+            }
+        }
+    }
+
+    /**
+     * Receive error: out of the hot list and the epoll set, reported once
+     */
+    void fail(uint8_t index) {
+        Channel& ch = channels_[index];
+        if (ch.hot) {
+            remove_hot(index);
+        } else {
+            (void)epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, ch.fd, nullptr);
+        }
+        ch.hot = false;
+        ch.failed = true;
+        std::cerr << "[FeedGroup] Receive error on channel " << static_cast<int>(index)
+                  << " - no longer polled" << std::endl;
+        char msg[96];
+        snprintf(msg, sizeof(msg), "FeedGroup: channel %d receive error - no longer polled", index);
+        LOG_ERROR(msg);
+    }
+
+    void remove_hot(uint8_t index) noexcept {
+        for (size_t i = 0; i < num_hot_; ++i) {
+            if (hot_[i] == index) {
+                hot_[i] = hot_[--num_hot_];
+                break;
+            }
+        }
+    }
+
+    void make_hot(uint8_t index) noexcept {
+        channels_[index].hot = true;
+        channels_[index].quiet_windows = 0;
+        hot_[num_hot_++] = index;
+    }
+
+    bool make_cold(uint8_t index) noexcept {
+        Channel& ch = channels_[index];
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u32 = index;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, ch.fd, &ev) != 0) {
+            return false;
+        }
+        if (ch.hot) {
+            remove_hot(index);
+        }
+        ch.hot = false;
+        ch.quiet_windows = 0;
+        return true;
+    }
+
+    void log_move(size_t index, const char* what) {
+        char msg[128];
+        snprintf(msg, sizeof(msg), "FeedGroup: channel %zu %s (%lu msgs/s)", index, what, channels_[index].rate);
+        LOG_INFO(msg);
+    }
+};
+
+} // namespace hft
@@ -7,11 +7,55 @@
 #include "packet_manager.hpp"
 #include "logger.hpp"
 #include "memory_pool.hpp"
+#include "pcap_reader.hpp"
+#include "feed_protocol.hpp"
+#include "feed_health.hpp"
+#include "watchdog.hpp"
+#include "housekeeping.hpp"
+#include "md_broadcast.hpp"
+#include "symbol_filter.hpp"
+#include "perf_counters.hpp"
+#include "jitter_probe.hpp"
+#include "warmup.hpp"
+#include <vector>
+#include <algorithm>
 #include <iostream>
 #include <atomic>
+#include <utility>
 
 namespace hft {
 
+// External global for shutdown signaling
+extern std::atomic<bool> g_running;
+
+/**
+ * Feed thread -> housekeeping: gap fill requests and state transitions
+ */
+struct FeedNotice {
+    enum Kind : uint8_t { GAP_FILL, STATE };
+    Kind kind;
+    FeedState state;
+    GapFillRequest gap;
+};
+
+/**
+ * Feed thread -> housekeeping: owner-only counters, copied on the stats timer
+ * (the shared FeedHandlerStats atomics are read directly)
+ */
+struct FeedStatsSnapshot {
+    uint64_t duplicates;
+    uint64_t gaps_detected;
+    uint64_t gaps_filled;
+    uint64_t out_of_order;
+    uint64_t resequenced;
+    uint64_t dropped_overflow;
+    uint64_t resumes_abandoned;
+    uint64_t next_expected;
+    uint64_t min_latency_ns;
+    uint64_t max_latency_ns;
+    MemoryPool<MarketEvent, 8192>::Stats pool;
+};
+
 /**
  * Feed Handler Implementation
  * 
@@ -23,10 +67,26 @@ namespace hft {
  * - Busy polls (no blocking)
  * 
  * Runs on dedicated CPU core with RT priority
+ * 
+ * Compiled per deployment for one packet source and one wire protocol, so
+ * the receive -> sequence -> decode loop is fully inlined with no branch
+ * on feed type:
+ * 
+ * Source (packet source policy) - receive_internal(const uint8_t*&)
+ *   returning >0 bytes, 0 = nothing yet, -1 = error / end of stream;
+ *   optional prefault(), optional last_capture_ns() (hardware capture
+ *   timestamp of the last packet - replay() tracks the replayed span).
+ *   Provided: UDPReceiver (socket), RecvmmsgReceiver (batched socket),
+ *   PcapReader / ItchFileReader (replay). A kernel-bypass
+ *   source (ef_vi, AF_XDP) implements the same call over its RX ring.
+ * 
+ * Protocol (wire protocol policy) - see feed_protocol.hpp. Provided:
+ *   NativeProtocol, ItchProtocol, SbeProtocol.
  */
-class FeedHandler {
+template<typename Source, typename Protocol>
+class BasicFeedHandler {
 private:
-    UDPReceiver receiver_;
+    Source source_;
     SPSCQueue<MarketEvent, 65536>& event_queue_;
     FeedHandlerStats& stats_;
     
@@ -34,38 +94,307 @@ private:
     PacketManager packet_manager_;
     RecoveryFeedManager recovery_manager_;
     
+    // Wire protocol (decoder state and counters)
+    Protocol protocol_;
+    
+    // Hardware counters for parse/sequence regions (HFT_PERF_COUNTERS builds)
+    PerfCounters perf_;
+    
+    // Idle-loop gap detection (core stolen while waiting for data)
+    JitterMonitor jitter_;
+    
+    // Advanced every loop iteration - watched by Watchdog
+    Heartbeat heartbeat_;
+    
     // Memory pool for market events (optional - demonstrates usage)
     MemoryPool<MarketEvent, 8192> event_pool_;
     
     uint64_t expected_sequence_{0};
     int core_id_;
+    uint8_t channel_id_{0};     // Stamped on every event
+    
+    // Warm restart point (book snapshot) - applied after the warmup resync
+    bool resume_pending_{false};
+    uint64_t resume_sequence_{0};
+    
+    // Gap state published to the circuit breaker (optional)
+    FeedHealth* health_{nullptr};
+    FeedState published_state_{FeedState::INITIAL};
+    
+    // Shared-memory fan-out to local strategy processes (optional)
+    BroadcastPublisher* broadcast_{nullptr};
+    
+    // Wire messages in sequenced packets (MoldUDP64 message count; one per
+    // packet for packet-sequenced protocols) - owner thread
+    uint64_t messages_received_{0};
+    
+    // Capture-clock span of the last replay (sources with last_capture_ns())
+    uint64_t capture_first_ns_{0};
+    uint64_t capture_last_ns_{0};
+    
+    // Subscription filter, read once per packet (optional)
+    SymbolFilter* filter_{nullptr};
+    int filter_reader_{-1};
+    
+    // Periodic work is timed by a Housekeeper (attach_housekeeping): the
+    // hot loop only sees flag bits, the formatting/printing/logging happens
+    // on the housekeeping thread behind two SPSC queues
+    HousekeepingFlags housekeeping_;
+    static constexpr uint8_t MAINTENANCE_DUE = 1 << 0;
+    static constexpr uint8_t SNAPSHOT_DUE = 1 << 1;
+    SPSCQueue<FeedNotice, 256> notices_;
+    SPSCQueue<FeedStatsSnapshot, 16> snapshots_;
+    uint64_t notices_dropped_{0};
+    
+    // Housekeeping-thread side
+    uint64_t last_log_ns_{0};
     
-    // Maintenance timer for periodic checks
-    uint64_t last_maintenance_time_{0};
     static constexpr uint64_t MAINTENANCE_INTERVAL_NS = 100000000ULL; // 100ms
-    uint64_t last_log_time_{0};
-    static constexpr uint64_t LOG_INTERVAL_NS = 5000000000ULL; // 5 seconds
+    static constexpr uint64_t STATS_INTERVAL_NS = 1000000000ULL;      // 1 second
+    static constexpr uint64_t LOG_INTERVAL_NS = 5000000000ULL;        // 5 seconds
+    static constexpr uint64_t JITTER_THRESHOLD_NS = 10000;            // 10us idle-loop gap
 
 public:
-    FeedHandler(SPSCQueue<MarketEvent, 65536>& queue, 
+    BasicFeedHandler(SPSCQueue<MarketEvent, 65536>& queue, 
                FeedHandlerStats& stats,
                int core_id = 0,
                bool use_huge_pages = false)
         : event_queue_(queue), stats_(stats), event_pool_(use_huge_pages), core_id_(core_id) {
         
-        // Setup gap fill callback
+        // Gap fill requests leave the feed thread as notices
         packet_manager_.set_gap_fill_callback([this](const GapFillRequest& req) {
-            handle_gap_fill_request(req);
+            post_notice(FeedNotice{FeedNotice::GAP_FILL, packet_manager_.get_state(), req});
         });
+        packet_manager_.set_gap_recovery(recovery_manager_.can_retransmit());
         
         LOG_INFO("FeedHandler initialized");
     }
     
     /**
-     * Initialize UDP receiver
+     * Wire protocol policy (decode counters: protocol().print(tag))
+     */
+    const Protocol& protocol() const noexcept {
+        return protocol_;
+    }
+    
+    /**
+     * Channel id stamped on every event - set before run()/replay()
+     * when several feed handlers feed one engine
+     */
+    void set_channel_id(uint8_t channel_id) noexcept {
+        channel_id_ = channel_id;
+    }
+    
+    [[nodiscard]] uint8_t channel_id() const noexcept {
+        return channel_id_;
+    }
+    
+    /**
+     * Publish gap state (RECOVERING / STALE) to the circuit breaker on
+     * every PacketManager transition - set before run()/replay()
+     */
+    void set_feed_health(FeedHealth* health) noexcept {
+        health_ = health;
+    }
+    
+    /**
+     * Also publish every normalized event (and feed state) to a shared
+     * memory ring for local subscriber processes - set before run()/replay()
+     * Warmup traffic is not published.
+     */
+    void set_broadcast(BroadcastPublisher* broadcast) noexcept {
+        broadcast_ = broadcast;
+    }
+    
+    /**
+     * Drop messages for unsubscribed symbols during decode - set before
+     * run()/replay(); several handlers may share one filter
+     * This thread reports an RCU quiescent state every poll iteration and
+     * goes offline when it stops (FeedGroup: filter_offline()).
+     * Warmup traffic is not filtered.
+     * @return false when the filter has no reader slot left
+     */
+    bool set_symbol_filter(SymbolFilter* filter) noexcept {
+        const int reader = filter ? filter->add_reader() : -1;
+        if (filter && reader < 0) {
+            return false;
+        }
+        filter_ = filter;
+        filter_reader_ = reader;
+        return true;
+    }
+    
+    /**
+     * Warm restart: sequence from the restored book snapshot - before run()
+     * Incremental processing continues there instead of at the first
+     * packet seen; the missed range goes through gap recovery.
+     */
+    void resume_from(uint64_t sequence) {
+        resume_pending_ = true;
+        resume_sequence_ = sequence;
+        packet_manager_.resume_from(sequence);
+    }
+    
+    /**
+     * Drive maintenance and stats from a housekeeping thread - before run()
+     * 
+     * Timers: PacketManager gap timeouts/retries every 100ms and a stats
+     * snapshot every second (logged every 5s). The task drains this feed's
+     * notices and snapshots on the housekeeping thread.
+     */
+    void attach_housekeeping(Housekeeper& housekeeper) {
+        housekeeper.add_timer(housekeeping_, MAINTENANCE_DUE, MAINTENANCE_INTERVAL_NS);
+        housekeeper.add_timer(housekeeping_, SNAPSHOT_DUE, STATS_INTERVAL_NS);
+        housekeeper.add_task([this]() { service_housekeeping(); });
+    }
+    
+    /**
+     * Consumer side of the housekeeping queues: gap/state notices (log,
+     * recovery requests) and stats snapshots (print, log)
+     * Housekeeping thread only - or the replay thread, which is both sides.
+     */
+    void service_housekeeping() {
+        FeedNotice notice;
+        while (notices_.try_pop(notice)) {
+            handle_notice(notice);
+        }
+        FeedStatsSnapshot snapshot;
+        while (snapshots_.try_pop(snapshot)) {
+            print_stats(snapshot);
+            const uint64_t now = Housekeeper::now_ns();
+            if (now - last_log_ns_ >= LOG_INTERVAL_NS) {
+                log_stats(snapshot);
+                last_log_ns_ = now;
+            }
+        }
+    }
+    
+    /**
+     * Notices lost to a full queue (housekeeping not keeping up)
+     */
+    [[nodiscard]] uint64_t notices_dropped() const noexcept {
+        return notices_dropped_;
+    }
+    
+    /**
+     * Loop heartbeat - register with a Watchdog before run()
+     */
+    Heartbeat& heartbeat() noexcept {
+        return heartbeat_;
+    }
+    
+    /**
+     * Packet source - open captures / read receive stats through this
+     */
+    Source& source() noexcept {
+        return source_;
+    }
+    
+    /**
+     * Initialize UDP receiver (socket sources)
      */
     bool init(const std::string& multicast_ip, uint16_t port) {
-        return receiver_.initialize(multicast_ip, port);
+        return source_.initialize(multicast_ip, port);
+    }
+    
+    /**
+     * Fault in receive buffer, event pool and the outbound event queue
+     * Call before the pipeline threads start (touches shared queue memory)
+     */
+    void prefault() noexcept {
+        if constexpr (requires { source_.prefault(); }) {
+            source_.prefault();
+        }
+        event_pool_.prefault();
+        event_queue_.prefault();
+    }
+    
+    /**
+     * Warmup: synthetic packets through the real sequence -> parse -> queue
+     * path until per-packet latency stops improving
+     * 
+     * Runs on the feed thread after pinning, so it is this core's i-cache,
+     * branch predictors and TLB that get trained. The engine consumes the
+     * synthetic events with order sends suppressed. Afterwards the feed
+     * state machine is resynced, stats are zeroed and - once every feed
+     * counted by begin_warmup() has done the same - the system goes LIVE.
+     * 
+     * @return Number of synthetic packets processed
+     */
+    uint64_t warmup(const WarmupConfig& cfg = WarmupConfig{}) {
+        LOG_INFO("FeedHandler warmup started");
+        
+        // Subscribers must never see synthetic events, and every one of
+        // them must reach the engine whatever the subscription
+        BroadcastPublisher* const broadcast = std::exchange(broadcast_, nullptr);
+        SymbolFilter* const filter = std::exchange(filter_, nullptr);
+        
+        std::vector<uint64_t> samples(cfg.window);
+        alignas(64) uint8_t packet[ItchPacketBuilder::MAX_PACKET_SIZE];
+        uint64_t seq = 1;
+        uint64_t total = 0;
+        uint64_t first_p50 = 0;
+        uint64_t prev_p50 = 0;
+        uint32_t stable = 0;
+        
+        while (g_running.load(std::memory_order_relaxed) && total < cfg.max_packets) {
+            for (uint64_t i = 0; i < cfg.window; ++i) {
+                const size_t size = Protocol::make_warmup_packet(packet, seq);
+                
+                // Stay well inside the queue - a full queue would time the drop path
+                while (event_queue_.size() > event_queue_.capacity() / 2 &&
+                       g_running.load(std::memory_order_relaxed)) {
+                    SpinWait::pause();
+                }
+                
+                heartbeat_.beat();
+                const uint64_t start = LatencyTracker::rdtsc();
+                on_packet(packet, size, start);
+                samples[i] = LatencyTracker::rdtscp() - start;
+            }
+            total += cfg.window;
+            
+            std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+            const uint64_t p50 = samples[samples.size() / 2];
+            if (first_p50 == 0) first_p50 = p50;
+            
+            const uint64_t diff = p50 > prev_p50 ? p50 - prev_p50 : prev_p50 - p50;
+            stable = (prev_p50 > 0 && diff * 100.0 <= cfg.stable_pct * prev_p50) ? stable + 1 : 0;
+            prev_p50 = p50;
+            
+            if (total >= cfg.min_packets && stable >= cfg.stable_windows) {
+                break;
+            }
+        }
+        
+        // Engine must consume every synthetic event before orders are enabled
+        while (!event_queue_.empty() && g_running.load(std::memory_order_relaxed)) {
+            SpinWait::pause();
+        }
+        
+        packet_manager_.trigger_resync();
+        if (resume_pending_) {
+            packet_manager_.resume_from(resume_sequence_);
+        }
+        broadcast_ = broadcast;
+        if (broadcast_) {
+            broadcast_->set_feed_state(channel_id_, packet_manager_.get_state());
+        }
+        filter_ = filter;
+        publish_feed_state();
+        packet_manager_.reset_stats();
+        stats_.reset();
+        jitter_.skip();
+        
+        const bool live = finish_warmup();
+        
+        char msg[192];
+        snprintf(msg, sizeof(msg), "Warmup complete: %lu packets, p50 %lu -> %lu ticks%s - %s",
+                 total, first_p50, prev_p50, stable >= cfg.stable_windows ? "" : " (not stable)",
+                 live ? "LIVE" : "waiting for other feeds");
+        std::cout << "[FeedHandler] " << msg << std::endl;
+        LOG_INFO(msg);
+        return total;
     }
     
     /**
@@ -74,96 +403,260 @@ public:
      */
     void run() {
         // Pin to CPU core - avoid context switches
-        ThreadUtils::pin_to_core(core_id_);
+        if (!ThreadUtils::pin_to_core(core_id_)) {
+            std::cerr << "[FeedHandler] Failed to pin to core " << core_id_ << std::endl;
+            LOG_WARN("FeedHandler: failed to pin to core - latency will be unpredictable");
+        }
         
         // Set real-time priority (requires privileges)
-        ThreadUtils::set_realtime_priority();
+        if (!ThreadUtils::set_realtime_priority()) {
+            std::cerr << "[FeedHandler] SCHED_FIFO unavailable (needs CAP_SYS_NICE)" << std::endl;
+            LOG_WARN("FeedHandler: SCHED_FIFO unavailable - running at normal priority");
+        }
+        
+        jitter_.configure(LatencyTracker::calibrate_tsc_ghz(20), JITTER_THRESHOLD_NS);
+        
+        // Counters are per-thread - open after pinning, on this thread
+        HFT_PERF_OPEN(perf_, "FeedHandler");
         
         std::cout << "[FeedHandler] Started on core " << core_id_ << std::endl;
         LOG_INFO("FeedHandler thread started");
         
-        uint64_t spin_count = 0;
-        constexpr uint64_t STATS_INTERVAL = 1000000; // Print stats every 1M iterations
-        
-        last_maintenance_time_ = LatencyTracker::rdtsc();
-        last_log_time_ = last_maintenance_time_;
+        Prefault::stack();
+        heartbeat_.attach("FeedHandler");
+        if (!is_live()) {
+            warmup();
+        }
         
         while (g_running.load(std::memory_order_acquire)) {
+            heartbeat_.beat();
             const uint64_t current_time = LatencyTracker::rdtsc();
             
-            // Periodic maintenance (gap timeout checks, etc.)
-            if (current_time - last_maintenance_time_ > MAINTENANCE_INTERVAL_NS) {
-                packet_manager_.periodic_maintenance(current_time);
-                last_maintenance_time_ = current_time;
-                
-                // Log memory pool stats periodically
-                if (current_time - last_log_time_ > LOG_INTERVAL_NS) {
-                    log_stats();
-                    last_log_time_ = current_time;
-                }
-            }
-            
             // Busy poll for packets - no blocking!
-            uint8_t* buffer_ptr = nullptr;
-            ssize_t bytes_received = receiver_.receive_internal(buffer_ptr);
+            const ssize_t bytes_received = poll_once(current_time);
             
             if (bytes_received > 0) {
-                // Timestamp immediately on receive - critical for latency measurement
-                const uint64_t recv_tsc = LatencyTracker::rdtsc();
-                
-                stats_.packets_received.fetch_add(1, std::memory_order_relaxed);
-                
-                // Process packet with gap/duplicate handling
-                process_packet(buffer_ptr, bytes_received, recv_tsc);
-                
-                // Check for buffered packets that are now ready
-                auto ready_packets = packet_manager_.get_ready_packets();
-                for (const auto& packet_data : ready_packets) {
-                    // Process buffered packet
-                    process_buffered_packet(packet_data.data(), packet_data.size(), recv_tsc);
-                }
+                jitter_.skip();
                 
             } else if (bytes_received == 0) {
                 // No data - spin wait with pause
+                jitter_.sample(current_time);
                 SpinWait::pause();
-                spin_count++;
             } else {
                 // Error occurred
                 std::cerr << "[FeedHandler] Receive error" << std::endl;
                 break;
             }
+        }
+        
+        heartbeat_.detach();
+        filter_offline();
+        
+        // Owner-only detail (histogram, per-thread counters), off the clock now
+        if (jitter_.gap_count() > 0) {
+            std::cout << "[FeedHandler] Jitter - Idle gaps > " << jitter_.threshold_ns() << "ns: "
+                      << jitter_.gap_count()
+                      << ", p99: " << jitter_.gaps_ns().percentile(99.0) << "ns"
+                      << ", Max: " << jitter_.max_gap_ns() << "ns" << std::endl;
+        }
+        perf_.print("FeedHandler");
+        std::cout << "[FeedHandler] Stopped" << std::endl;
+    }
+    
+    /**
+     * One step of the receive loop: due housekeeping, one receive,
+     * sequence/decode/queue. run() spins on it; FeedGroup interleaves many
+     * handlers on one core with it.
+     * 
+     * @return >0 bytes handled, 0 nothing pending, -1 source error
+     */
+    inline ssize_t poll_once(uint64_t current_time) {
+        service_timers(current_time);
+        
+        const uint8_t* buffer_ptr = nullptr;
+        const ssize_t bytes = source_.receive_internal(buffer_ptr);
+        if (bytes > 0) {
+            // Timestamp immediately on receive - critical for latency measurement
+            const uint64_t recv_tsc = LatencyTracker::rdtsc();
+            on_packet(buffer_ptr, static_cast<size_t>(bytes), recv_tsc);
+        }
+        return bytes;
+    }
+    
+    /**
+     * This thread stopped reading the symbol filter for good (end of
+     * run(); FeedGroup calls it for each handler when the group stops)
+     */
+    void filter_offline() noexcept {
+        if (filter_) {
+            filter_->offline(filter_reader_);
+        }
+    }
+    
+    /**
+     * Housekeeping timers - one byte load unless something is due - and
+     * the filter reader's quiescent state, between packets
+     * (FeedGroup calls this for channels it is not polling)
+     */
+    inline void service_timers(uint64_t current_time) noexcept {
+        if (filter_) {
+            filter_->quiescent(filter_reader_);
+        }
+        if (housekeeping_.pending()) [[unlikely]] {
+            run_due_housekeeping(current_time);
+            jitter_.skip();
+        }
+    }
+    
+    /**
+     * Offline replay loop - drives the same parse/sequence path from a capture
+     * 
+     * No pacing: packets are pushed as fast as the stack can absorb them, so
+     * this measures the saturation rate of parsing + sequencing on real data.
+     * Runs on the calling thread (caller decides pinning).
+     * 
+     * The source must already be open (PcapReader filtered to this channel's
+     * group/port, or ItchFileReader) and return -1 at the end.
+     * 
+     * @param max_packets Stop after this many packets (0 = whole file)
+     * @return Number of packets replayed
+     */
+    uint64_t replay(uint64_t max_packets = 0) {
+        LOG_INFO("FeedHandler replay started");
+        HFT_PERF_OPEN(perf_, "FeedHandler");
+        
+        uint64_t replayed = 0;
+        const uint8_t* buffer_ptr = nullptr;
+        capture_first_ns_ = 0;
+        capture_last_ns_ = 0;
+        
+        while (g_running.load(std::memory_order_relaxed) &&
+               (max_packets == 0 || replayed < max_packets)) {
+            const ssize_t bytes = source_.receive_internal(buffer_ptr);
+            if (bytes < 0) {
+                break; // End of capture
+            }
             
-            // Periodic stats logging (non-critical path)
-            if (spin_count % STATS_INTERVAL == 0) {
-                print_stats();
+            const uint64_t recv_tsc = LatencyTracker::rdtsc();
+            if constexpr (requires { source_.last_capture_ns(); }) {
+                capture_last_ns_ = source_.last_capture_ns();
+                if (capture_first_ns_ == 0) {
+                    capture_first_ns_ = capture_last_ns_;
+                }
+            }
+            on_packet(buffer_ptr, static_cast<size_t>(bytes), recv_tsc);
+            replayed++;
+            
+            // No housekeeping thread in replay - this thread is the consumer
+            if (!notices_.empty()) [[unlikely]] {
+                service_housekeeping();
+            }
+            if (filter_) {
+                filter_->quiescent(filter_reader_);
             }
         }
+        filter_offline();
         
-        std::cout << "[FeedHandler] Stopped" << std::endl;
+        packet_manager_.periodic_maintenance(LatencyTracker::rdtsc());
+        publish_feed_state();
+        service_housekeeping();
+        return replayed;
+    }
+    
+    /**
+     * Hardware capture timestamps (ns since epoch) of the first and last
+     * packet of the last replay() - 0 if the source has none
+     */
+    [[nodiscard]] uint64_t capture_first_ns() const noexcept {
+        return capture_first_ns_;
+    }
+    
+    [[nodiscard]] uint64_t capture_last_ns() const noexcept {
+        return capture_last_ns_;
+    }
+    
+    /**
+     * Push one raw packet through parse + sequencing + queue, no socket
+     * For benchmarks and tools that source packets themselves
+     */
+    void inject_packet(const uint8_t* data, size_t size, uint64_t recv_tsc) {
+        on_packet(data, size, recv_tsc);
+    }
+
+    /**
+     * Sequencing statistics (for replay/benchmark reports)
+     */
+    const PacketManager& packet_manager() const noexcept {
+        return packet_manager_;
+    }
+    
+    /**
+     * Per-region hardware counters (empty unless built with HFT_PERF_COUNTERS)
+     */
+    const PerfCounters& perf_counters() const noexcept {
+        return perf_;
+    }
+    
+    /**
+     * Messages received in sequenced packets, duplicates included - owner
+     * thread (FeedGroup rates channels on it)
+     */
+    [[nodiscard]] uint64_t messages_received() const noexcept {
+        return messages_received_;
+    }
+    
+    /**
+     * Idle-loop gap statistics (counters safe from any thread)
+     */
+    const JitterMonitor& jitter_monitor() const noexcept {
+        return jitter_;
     }
 
 private:
     /**
-     * Parse and normalize market data packet
-     * Now with industry-standard gap and duplicate handling
+     * Per-packet work shared by live and replay loops
      */
-    void process_packet(const uint8_t* data, size_t size, uint64_t recv_tsc) {
-        // Basic validation
-        if (size < sizeof(MarketDataPacket)) {
-            return;
-        }
+    void on_packet(const uint8_t* data, size_t size, uint64_t recv_tsc) {
+        stats_.packets_received.fetch_add(1, std::memory_order_relaxed);
         
-        // In production: avoid memcpy, work directly with packet buffer
-        const auto* packet = reinterpret_cast<const MarketDataPacket*>(data);
+        // Sequence range from the protocol header - short packets and
+        // unsequenced ones (heartbeats) go no further
+        uint64_t sequence = 0;
+        uint64_t count = 1;
+        if (protocol_.sequence(data, size, sequence, count)) {
+            messages_received_ += count;
+            process_packet(data, size, sequence, count, recv_tsc);
+        }
         
+        // Check for buffered packets that are now ready
+        auto ready_packets = packet_manager_.get_ready_packets();
+        for (const auto& packet_data : ready_packets) {
+            // Process buffered packet (sequenced when it was buffered)
+            if (protocol_.sequence(packet_data.data(), packet_data.size(), sequence, count)) {
+                decode_and_queue(packet_data.data(), packet_data.size(), sequence, recv_tsc);
+            }
+        }
+    }
+    
+    /**
+     * Gap/duplicate handling, then decode
+     */
+    void process_packet(const uint8_t* data, size_t size, uint64_t sequence, uint64_t count,
+                        uint64_t recv_tsc) {
         // ==== INDUSTRY STANDARD GAP/DUPLICATE HANDLING ====
         // Use PacketManager to handle sequencing, gaps, and duplicates
-        const bool should_process = packet_manager_.process_packet(
-            packet->packet_sequence,
-            data,
-            size,
-            recv_tsc
-        );
+        bool should_process;
+        {
+            HFT_PERF_SCOPE(perf_, PerfRegion::SEQUENCE);
+            should_process = packet_manager_.process_packet(
+                sequence,
+                data,
+                size,
+                recv_tsc,
+                count
+            );
+        }
+        publish_feed_state();
         
         // Update statistics from packet manager
         const auto& pm_stats = packet_manager_.get_stats();
@@ -178,60 +671,90 @@ private:
         }
         
         // Packet passed all checks - proceed with parsing
-        parse_and_queue_packet(packet, recv_tsc);
+        decode_and_queue(data, size, sequence, recv_tsc);
     }
     
     /**
-     * Process buffered packet (from resequence buffer)
+     * Gap state -> circuit breaker, on transitions only (a compare per packet)
      */
-    void process_buffered_packet(const uint8_t* data, size_t size, uint64_t recv_tsc) {
-        if (size < sizeof(MarketDataPacket)) {
-            return;
+    inline void publish_feed_state() noexcept {
+        const FeedState state = packet_manager_.get_state();
+        if (state != published_state_) [[unlikely]] {
+            published_state_ = state;
+            if (health_) {
+                health_->on_feed_state(channel_id_, state);
+            }
+            if (broadcast_) {
+                broadcast_->set_feed_state(channel_id_, state);
+            }
+            post_notice(FeedNotice{FeedNotice::STATE, state, GapFillRequest{}});
         }
-        
-        const auto* packet = reinterpret_cast<const MarketDataPacket*>(data);
-        parse_and_queue_packet(packet, recv_tsc);
     }
     
     /**
-     * Parse packet and push to queue
-     * Separated from process_packet for reuse with buffered packets
+     * Hot thread side of the timers: owner-only work, no I/O
      */
-    void parse_and_queue_packet(const MarketDataPacket* packet, uint64_t recv_tsc) {
-        // Create normalized event
-        MarketEvent event{};
-        event.recv_timestamp_ns = recv_tsc;
-        event.type = packet->msg_type;
-        
-        // Parse based on message type
-        switch (packet->msg_type) {
-            case MessageType::TRADE: {
-                const auto& trade = packet->payload.trade;
-                event.exchange_timestamp_ns = trade.timestamp_ns;
-                event.symbol_id = trade.symbol_id;
-                event.data.trade.price = trade.price;
-                event.data.trade.quantity = trade.quantity;
-                event.data.trade.side = trade.side;
-                break;
-            }
-            
-            case MessageType::QUOTE: {
-                const auto& quote = packet->payload.quote;
-                event.exchange_timestamp_ns = quote.timestamp_ns;
-                event.symbol_id = quote.symbol_id;
-                event.data.quote.bid_price = quote.bid_price;
-                event.data.quote.ask_price = quote.ask_price;
-                event.data.quote.bid_size = quote.bid_size;
-                event.data.quote.ask_size = quote.ask_size;
-                break;
-            }
-            
-            case MessageType::HEARTBEAT:
-                // Just update sequence, don't push to queue
-                return;
-                
-            default:
-                return; // Unknown message type
+    [[gnu::noinline]] void run_due_housekeeping(uint64_t current_time) noexcept {
+        const uint8_t due = housekeeping_.take();
+        if (due & MAINTENANCE_DUE) {
+            // Gap timeouts / retries - retries come back out as notices
+            packet_manager_.periodic_maintenance(current_time);
+            publish_feed_state();
+        }
+        if (due & SNAPSHOT_DUE) {
+            const auto& pm = packet_manager_.get_stats();
+            const FeedStatsSnapshot snapshot{
+                .duplicates = pm.duplicates,
+                .gaps_detected = pm.gaps_detected,
+                .gaps_filled = pm.gaps_filled,
+                .out_of_order = pm.out_of_order,
+                .resequenced = pm.resequenced,
+                .dropped_overflow = pm.dropped_overflow,
+                .resumes_abandoned = pm.resumes_abandoned,
+                .next_expected = packet_manager_.get_next_expected(),
+                .min_latency_ns = stats_.min_latency_ns,
+                .max_latency_ns = stats_.max_latency_ns,
+                .pool = event_pool_.get_stats()
+            };
+            (void)snapshots_.try_push(snapshot);   // Full = housekeeping behind; next one will do
+        }
+    }
+    
+    void post_notice(const FeedNotice& notice) noexcept {
+        if (!notices_.try_push(notice)) [[unlikely]] {
+            notices_dropped_++;
+        }
+    }
+    
+    /**
+     * Decode straight from the packet buffer and push every event - with
+     * a subscription installed, only events for subscribed symbols
+     * (the packet is already sequenced either way)
+     */
+    void decode_and_queue(const uint8_t* data, size_t size, uint64_t sequence, uint64_t recv_tsc) {
+        HFT_PERF_SCOPE(perf_, PerfRegion::PARSE);
+        auto sink = [this, sequence, recv_tsc](const MarketEvent& decoded) {
+            MarketEvent event = decoded;
+            event.sequence = sequence;
+            event.channel_id = channel_id_;
+            queue_event(event, recv_tsc);
+        };
+        const SubscriptionSet* const subscribed = filter_ ? filter_->current() : nullptr;
+        if (subscribed) {
+            protocol_.decode(data, size, recv_tsc, sink,
+                             [subscribed](uint32_t symbol) { return subscribed->contains(symbol); });
+        } else {
+            protocol_.decode(data, size, recv_tsc, sink);
+        }
+    }
+    
+    /**
+     * Push a normalized event and account parse latency
+     */
+    void queue_event(const MarketEvent& event, uint64_t recv_tsc) {
+        // Local subscribers first - never blocks, independent of the engine queue
+        if (broadcast_) {
+            broadcast_->publish(event);
         }
         
         // Push to lock-free queue - non-blocking
@@ -251,28 +774,32 @@ private:
     }
     
     /**
-     * Handle gap fill request callback
+     * Gap fill request / state transition - housekeeping thread
      * In production: sends request to recovery feed
      */
-    void handle_gap_fill_request(const GapFillRequest& req) {
-        char msg[256];
-        snprintf(msg, sizeof(msg), "GAP DETECTED: sequences %lu to %lu (gap size: %lu)",
-                req.start_seq, req.end_seq, (req.end_seq - req.start_seq + 1));
-        LOG_WARN(msg);
-        
-        std::cout << "[FeedHandler] " << msg << std::endl;
-        
-        // In production: send recovery request
-        // Examples:
-        // 1. CME MDP 3.0: Send TCP request to Replay channel
-        // 2. NASDAQ ITCH: Send MOLD UDP retransmit request
-        // 3. NYSE Pillar: Send Retransmission request
-        
-        recovery_manager_.request_retransmission(req.start_seq, req.end_seq);
+    void handle_notice(const FeedNotice& notice) {
+        if (notice.kind == FeedNotice::GAP_FILL) {
+            const GapFillRequest& req = notice.gap;
+            char msg[256];
+            snprintf(msg, sizeof(msg), "GAP DETECTED: sequences %lu to %lu (gap size: %lu)",
+                    req.start_seq, req.end_seq, (req.end_seq - req.start_seq + 1));
+            LOG_WARN(msg);
+            
+            std::cout << "[FeedHandler] " << msg << std::endl;
+            
+            // In production: send recovery request
+            // Examples:
+            // 1. CME MDP 3.0: Send TCP request to Replay channel
+            // 2. NASDAQ ITCH: Send MOLD UDP retransmit request
+            // 3. NYSE Pillar: Send Retransmission request
+            
+            recovery_manager_.request_retransmission(req.start_seq, req.end_seq);
+            return;
+        }
         
         // Log state transition
         const char* state_str = "UNKNOWN";
-        switch (packet_manager_.get_state()) {
+        switch (notice.state) {
             case FeedState::INITIAL:
                 state_str = "INITIAL";
                 break;
@@ -292,14 +819,16 @@ private:
         std::cout << "[FeedHandler] Feed state: " << state_str << std::endl;
     }
     
-    void print_stats() {
+    /**
+     * Housekeeping thread: shared atomics read live, owner-only counters
+     * from the snapshot
+     */
+    void print_stats(const FeedStatsSnapshot& snapshot) const {
         const uint64_t recv = stats_.packets_received.load(std::memory_order_relaxed);
         const uint64_t proc = stats_.packets_processed.load(std::memory_order_relaxed);
         const uint64_t drop = stats_.packets_dropped.load(std::memory_order_relaxed);
         const uint64_t gaps = stats_.sequence_gaps.load(std::memory_order_relaxed);
         
-        const auto& pm_stats = packet_manager_.get_stats();
-        
         if (proc > 0) {
             std::cout << "[FeedHandler] Stats - "
                       << "Recv: " << recv
@@ -307,29 +836,37 @@ private:
                       << ", Drop: " << drop
                       << ", Gaps: " << gaps
                       << ", Avg Latency: " << static_cast<int>(stats_.avg_latency_ns()) << "ns"
-                      << ", Min: " << stats_.min_latency_ns << "ns"
-                      << ", Max: " << stats_.max_latency_ns << "ns"
+                      << ", Min: " << snapshot.min_latency_ns << "ns"
+                      << ", Max: " << snapshot.max_latency_ns << "ns"
                       << std::endl;
             
             std::cout << "[PacketMgr] Stats - "
-                      << "Duplicates: " << pm_stats.duplicates
-                      << ", Gaps Detected: " << pm_stats.gaps_detected
-                      << ", Gaps Filled: " << pm_stats.gaps_filled
-                      << ", Out-of-Order: " << pm_stats.out_of_order
-                      << ", Resequenced: " << pm_stats.resequenced
-                      << ", Overflow Drops: " << pm_stats.dropped_overflow
-                      << ", Next Expected: " << packet_manager_.get_next_expected()
+                      << "Duplicates: " << snapshot.duplicates
+                      << ", Gaps Detected: " << snapshot.gaps_detected
+                      << ", Gaps Filled: " << snapshot.gaps_filled
+                      << ", Out-of-Order: " << snapshot.out_of_order
+                      << ", Resequenced: " << snapshot.resequenced
+                      << ", Overflow Drops: " << snapshot.dropped_overflow
+                      << ", Next Expected: " << snapshot.next_expected
                       << std::endl;
+            
+            if (snapshot.resumes_abandoned > 0) {
+                std::cout << "[PacketMgr] Warm-restart resume point abandoned - feed restarted below it or the gap since is unrecoverable"
+                          << std::endl;
+            }
+            
+            if (jitter_.gap_count() > 0) {
+                std::cout << "[FeedHandler] Jitter - Idle gaps > " << jitter_.threshold_ns() << "ns: "
+                          << jitter_.gap_count()
+                          << ", Max: " << jitter_.max_gap_ns() << "ns" << std::endl;
+            }
         }
     }
     
     /**
      * Log statistics to async logger
      */
-    void log_stats() {
-        const auto& pm_stats = packet_manager_.get_stats();
-        const auto pool_stats = event_pool_.get_stats();
-        
+    void log_stats(const FeedStatsSnapshot& snapshot) const {
         char msg[512];
         snprintf(msg, sizeof(msg), 
                 "Stats: Packets(recv=%lu proc=%lu drop=%lu) PacketMgr(dup=%lu gaps=%lu) "
@@ -337,15 +874,19 @@ private:
                 stats_.packets_received.load(std::memory_order_relaxed),
                 stats_.packets_processed.load(std::memory_order_relaxed),
                 stats_.packets_dropped.load(std::memory_order_relaxed),
-                pm_stats.duplicates, pm_stats.gaps_detected,
-                pool_stats.allocations, pool_stats.deallocations,
-                pool_stats.in_use, pool_stats.failures);
+                snapshot.duplicates, snapshot.gaps_detected,
+                snapshot.pool.allocations, snapshot.pool.deallocations,
+                snapshot.pool.in_use, snapshot.pool.failures);
         LOG_INFO(msg);
     }
 };
 
-// External global for shutdown signaling
-extern std::atomic<bool> g_running;
+/**
+ * Deployments - one fully inlined hot loop each
+ */
+using FeedHandler = BasicFeedHandler<UDPReceiver, NativeProtocol>;
+using ItchFeedHandler = BasicFeedHandler<UDPReceiver, ItchProtocol>;
+using SbeFeedHandler = BasicFeedHandler<UDPReceiver, SbeProtocol>;
 
 } // namespace hft
 
@@ -0,0 +1,273 @@
+#pragma once
+
+#include "spsc_queue.hpp"
+#include "types.hpp"
+#include "utils.hpp"
+#include "packet_manager.hpp"
+#include "clock_skew.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+namespace hft {
+
+// External global for shutdown signaling
+extern std::atomic<bool> g_running;
+
+/**
+ * Feed Health Circuit Breaker
+ *
+ * PacketManager only changes state on sequence gaps - a feed that is
+ * gap-free but late (congested switch, slow exchange gateway, an engine
+ * falling behind its queue) keeps the strategy quoting on a stale view.
+ *
+ * One byte per channel, zero = healthy, otherwise a mask of reasons:
+ *
+ *   LATENCY  exchange -> receive EWMA above max_wire_latency_ns
+ *   AGE      newest exchange timestamp older than max_age_ns (local now,
+ *            corrected for clock offset)
+ *   QUEUE    engine queue deeper than max_queue_depth
+ *   GAP      PacketManager RECOVERING or STALE
+ *
+ * GAP is set/cleared by the feed thread on the state transition itself;
+ * the rest are evaluated off the hot path by the health thread (run())
+ * from ClockSkewMonitor's live channel fields and the queue indices.
+ * A reason trips at once and clears only after recover_ns without it.
+ *
+ * Engine side: healthy(channel) is one relaxed byte load from a line that
+ * is written only on transitions - it stays in the engine's cache, so the
+ * check is free while nothing changes.
+ */
+struct FeedHealthConfig {
+    uint64_t max_wire_latency_ns{100000};   // 100us exchange -> receive EWMA
+    uint64_t max_age_ns{0};                 // 0 = off; set above the quietest expected gap
+    size_t max_queue_depth{32768};          // Half the engine queue
+    uint64_t recover_ns{10000000};          // 10ms clean before a reason clears
+    uint64_t poll_interval_us{100};         // Health thread period
+};
+
+class FeedHealth {
+public:
+    static constexpr size_t MAX_CHANNELS = ClockSkewMonitor::MAX_CHANNELS;
+
+    enum Reason : uint8_t {
+        HEALTHY = 0,
+        LATENCY = 1 << 0,
+        AGE = 1 << 1,
+        QUEUE = 1 << 2,
+        GAP = 1 << 3
+    };
+
+    using EventQueue = SPSCQueue<MarketEvent, 65536>;
+
+private:
+    // Engine-read line: written only on transitions
+    alignas(64) std::atomic<uint8_t> flags_[MAX_CHANNELS]{};
+
+    // Health thread state
+    struct Watch {
+        const EventQueue* queue{nullptr};
+        uint64_t clean_since_ns[3]{};   // LATENCY, AGE, QUEUE: first clean evaluation
+        uint64_t trips{0};
+        uint64_t unhealthy_ns{0};
+        uint64_t max_wire_ewma_ns{0};
+        uint64_t max_age_ns{0};
+        size_t max_queue_depth{0};
+    };
+
+    alignas(64) FeedHealthConfig cfg_;
+    const ClockSkewMonitor* clock_skew_{nullptr};
+    Watch watch_[MAX_CHANNELS];
+    uint64_t last_eval_ns_{0};
+    uint64_t evaluations_{0};
+
+    // Feed-thread gap transitions (readable anywhere)
+    alignas(64) std::atomic<uint64_t> gap_trips_{0};
+
+public:
+    explicit FeedHealth(const FeedHealthConfig& cfg = FeedHealthConfig{}) noexcept
+        : cfg_(cfg) {}
+
+    /**
+     * Latency / age source - the engine's monitor (enable_clock_skew)
+     * Call before run().
+     */
+    void watch_clock_skew(const ClockSkewMonitor* monitor) noexcept {
+        clock_skew_ = monitor;
+    }
+
+    /**
+     * Queue the channel's events are pushed to. Call before run().
+     */
+    void watch_queue(uint8_t channel_id, const EventQueue& queue) noexcept {
+        watch_[channel_id & (MAX_CHANNELS - 1)].queue = &queue;
+    }
+
+    // ---- Engine side ----
+
+    /**
+     * Hot path: true if the channel may be quoted on
+     */
+    [[nodiscard]] inline bool healthy(uint8_t channel_id) const noexcept {
+        return flags_[channel_id & (MAX_CHANNELS - 1)].load(std::memory_order_relaxed) == HEALTHY;
+    }
+
+    [[nodiscard]] uint8_t reasons(uint8_t channel_id) const noexcept {
+        return flags_[channel_id & (MAX_CHANNELS - 1)].load(std::memory_order_relaxed);
+    }
+
+    // ---- Feed side ----
+
+    /**
+     * Feed thread, on a PacketManager state change
+     * INITIAL counts as healthy - no view yet is covered by AGE.
+     */
+    void on_feed_state(uint8_t channel_id, FeedState state) noexcept {
+        auto& flags = flags_[channel_id & (MAX_CHANNELS - 1)];
+        if (state == FeedState::RECOVERING || state == FeedState::STALE) {
+            if ((flags.fetch_or(GAP, std::memory_order_relaxed) & GAP) == 0) {
+                gap_trips_.fetch_add(1, std::memory_order_relaxed);
+            }
+        } else {
+            flags.fetch_and(static_cast<uint8_t>(~GAP), std::memory_order_relaxed);
+        }
+    }
+
+    // ---- Health thread ----
+
+    /**
+     * Evaluate LATENCY / AGE / QUEUE for every watched channel
+     *
+     * @param now_tsc Current TSC (same clock as the events' recv timestamps)
+     * @param tsc_ghz Hold-down timing
+     */
+    void evaluate(uint64_t now_tsc, double tsc_ghz) noexcept {
+        const uint64_t now_ns = LatencyTracker::tsc_to_ns(now_tsc, tsc_ghz);
+        const uint64_t elapsed = last_eval_ns_ != 0 ? now_ns - last_eval_ns_ : 0;
+        last_eval_ns_ = now_ns;
+        evaluations_++;
+
+        for (size_t i = 0; i < MAX_CHANNELS; ++i) {
+            Watch& w = watch_[i];
+            uint8_t bad = HEALTHY;
+            bool watched = false;
+
+            if (clock_skew_) {
+                const auto& ch = clock_skew_->channel(static_cast<uint8_t>(i));
+                // Acquire pairs with on_event: the monitor's clock is anchored
+                if (ch.samples.load(std::memory_order_acquire) > 0) {
+                    watched = true;
+                    const uint64_t ewma = ch.wire_ewma_ns.load(std::memory_order_relaxed);
+                    if (ewma > w.max_wire_ewma_ns) w.max_wire_ewma_ns = ewma;
+                    if (cfg_.max_wire_latency_ns != 0 && ewma > cfg_.max_wire_latency_ns) {
+                        bad |= LATENCY;
+                    }
+
+                    // Age beyond the path floor: now - (exchange time mapped to local)
+                    const int64_t seen = static_cast<int64_t>(ch.last_exchange_ns.load(std::memory_order_relaxed)) +
+                                         ch.offset_ns.load(std::memory_order_relaxed);
+                    const int64_t age = static_cast<int64_t>(clock_skew_->local_ns(now_tsc)) - seen;
+                    const uint64_t age_ns = age > 0 ? static_cast<uint64_t>(age) : 0;
+                    if (age_ns > w.max_age_ns) w.max_age_ns = age_ns;
+                    if (cfg_.max_age_ns != 0 && age_ns > cfg_.max_age_ns) {
+                        bad |= AGE;
+                    }
+                }
+            }
+
+            if (w.queue) {
+                watched = true;
+                const size_t depth = w.queue->size();
+                if (depth > w.max_queue_depth) w.max_queue_depth = depth;
+                if (depth > cfg_.max_queue_depth) {
+                    bad |= QUEUE;
+                }
+            }
+
+            if (watched) {
+                update(i, bad, now_ns, elapsed);
+            }
+        }
+    }
+
+    /**
+     * Health thread loop until shutdown - not pinned, sleeps between passes
+     */
+    void run() {
+        const double tsc_ghz = LatencyTracker::calibrate_tsc_ghz(20);
+        while (g_running.load(std::memory_order_acquire)) {
+            evaluate(LatencyTracker::rdtsc(), tsc_ghz);
+            std::this_thread::sleep_for(std::chrono::microseconds(cfg_.poll_interval_us));
+        }
+    }
+
+    [[nodiscard]] uint64_t trips(uint8_t channel_id) const noexcept {
+        return watch_[channel_id & (MAX_CHANNELS - 1)].trips;
+    }
+    [[nodiscard]] uint64_t gap_trips() const noexcept {
+        return gap_trips_.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] uint64_t evaluations() const noexcept { return evaluations_; }
+
+    /**
+     * Per-channel summary - call after the health thread stops
+     */
+    void print() const {
+        printf("[FeedHealth] %lu evaluations, %lu gap trips\n", evaluations_, gap_trips());
+        for (size_t i = 0; i < MAX_CHANNELS; ++i) {
+            const Watch& w = watch_[i];
+            if (w.max_wire_ewma_ns == 0 && w.max_age_ns == 0 && w.max_queue_depth == 0 && w.trips == 0) {
+                continue;
+            }
+            printf("[FeedHealth] Channel %zu - trips %lu, unhealthy %.3f ms, "
+                   "max wire EWMA %lu ns, max age %lu ns, max queue %zu, now 0x%x\n",
+                   i, w.trips, static_cast<double>(w.unhealthy_ns) / 1e6,
+                   w.max_wire_ewma_ns, w.max_age_ns, w.max_queue_depth,
+                   reasons(static_cast<uint8_t>(i)));
+        }
+    }
+
+private:
+    /**
+     * Trip new reasons at once; clear a reason after recover_ns clean
+     * Only transitions touch the engine-read line.
+     */
+    void update(size_t i, uint8_t bad, uint64_t now_ns, uint64_t elapsed) noexcept {
+        Watch& w = watch_[i];
+        auto& flags = flags_[i];
+        const uint8_t current = flags.load(std::memory_order_relaxed);
+        if (current != HEALTHY) {
+            w.unhealthy_ns += elapsed;
+        }
+
+        uint8_t set = 0;
+        uint8_t clear = 0;
+        for (uint8_t bit = 0; bit < 3; ++bit) {
+            const uint8_t reason = static_cast<uint8_t>(1 << bit);
+            if (bad & reason) {
+                w.clean_since_ns[bit] = 0;
+                if (!(current & reason)) set |= reason;
+            } else if (current & reason) {
+                if (w.clean_since_ns[bit] == 0) {
+                    w.clean_since_ns[bit] = now_ns;
+                } else if (now_ns - w.clean_since_ns[bit] >= cfg_.recover_ns) {
+                    clear |= reason;
+                    w.clean_since_ns[bit] = 0;
+                }
+            }
+        }
+
+        if (set) [[unlikely]] {
+            if (flags.fetch_or(set, std::memory_order_relaxed) == HEALTHY) {
+                w.trips++;
+            }
+        }
+        if (clear) [[unlikely]] {
+            flags.fetch_and(static_cast<uint8_t>(~clear), std::memory_order_relaxed);
+        }
+    }
+};
+
+} // namespace hft
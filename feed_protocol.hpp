@@ -0,0 +1,283 @@
+#pragma once
+
+#include "types.hpp"
+#include "utils.hpp"
+#include "protocol_schema.hpp"
+#include "itch_decoder.hpp"
+#include "sbe_decoder.hpp"
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+namespace hft {
+
+/**
+ * Feed Protocol Policies
+ *
+ * BasicFeedHandler<Source, Protocol> is compiled once per venue format, so
+ * the hot loop calls these directly - inlined, no virtual calls, no branch
+ * on feed type. A protocol policy provides:
+ *
+ *   bool sequence(data, size, seq&, count&)   Sequence range of a packet;
+ *                                             false = not sequenced (short
+ *                                             packet, heartbeat) - dropped
+ *   void decode(data, size, recv_tsc, sink, accept)
+ *                                             sink(const MarketEvent&) per
+ *                                             normalized event; a message
+ *                                             whose symbol id fails
+ *                                             accept(uint32_t) is dropped
+ *                                             right after that field is read,
+ *                                             before normalization (default
+ *                                             AllSymbols)
+ *   static size_t make_warmup_packet(buf, seq&)
+ *                                             Synthetic traffic that runs
+ *                                             every decode branch; advances
+ *                                             seq past the packet
+ *   void print(tag) const                     Decode counters
+ *
+ * Warmup packets must fit in ItchPacketBuilder::MAX_PACKET_SIZE bytes.
+ */
+
+/**
+ * NATIVE: one MarketDataPacket per datagram (types.hpp), packet-sequenced
+ * Decoded through the generated schema (protocol_schema.hpp).
+ */
+class NativeProtocol {
+private:
+    uint64_t filtered_{0};
+
+public:
+    static constexpr const char* NAME = "native";
+
+    [[nodiscard]] bool sequence(const uint8_t* data, size_t size,
+                                uint64_t& seq, uint64_t& count) const noexcept {
+        if (size < sizeof(MarketDataPacket)) {
+            return false;
+        }
+        seq = schema::native::Sequence::load(data);
+        count = 1;
+        return true;
+    }
+
+    template<typename Sink, typename Accept = AllSymbols>
+    void decode(const uint8_t* data, size_t size, uint64_t recv_tsc, Sink&& sink,
+                const Accept& accept = Accept{}) noexcept {
+        // Every message type has the symbol at the same payload offset
+        if (size >= sizeof(MarketDataPacket) && !accept(schema::native::SymbolId::load(data))) {
+            filtered_++;
+            return;
+        }
+        MarketEvent event{};
+        event.recv_timestamp_ns = recv_tsc;
+        // Heartbeats and unknown types carry no event
+        if (schema::native::Schema::decode(data, size, event) == schema::DecodeResult::DECODED) {
+            sink(event);
+        }
+    }
+
+    /**
+     * Mix of message types so every parse branch is exercised; every 16th
+     * trade is a large buy so the strategy's order path runs too (sends
+     * are suppressed in WARMUP)
+     */
+    static size_t make_warmup_packet(uint8_t* buffer, uint64_t& seq) noexcept {
+        auto& packet = *reinterpret_cast<MarketDataPacket*>(buffer);
+        const uint64_t s = seq++;
+        packet.version = 1;
+        packet.packet_sequence = s;
+        const uint64_t now = LatencyTracker::rdtsc();
+        const uint32_t symbol = static_cast<uint32_t>(s % 64);
+
+        switch (s % 3) {
+            case 0: {
+                packet.msg_type = MessageType::TRADE;
+                packet.payload_size = sizeof(TradeMessage);
+                auto& trade = packet.payload.trade;
+                trade.timestamp_ns = now;
+                trade.sequence_num = s;
+                trade.symbol_id = symbol;
+                trade.trade_id = static_cast<uint32_t>(s);
+                trade.price = 1500000 + (s % 100) * 100;
+                trade.quantity = (s % 16 == 0) ? 20000 : 100;
+                trade.side = (s % 16 == 0) ? 'B' : 'S';
+                break;
+            }
+            case 1: {
+                packet.msg_type = MessageType::QUOTE;
+                packet.payload_size = sizeof(QuoteMessage);
+                auto& quote = packet.payload.quote;
+                quote.timestamp_ns = now;
+                quote.sequence_num = s;
+                quote.symbol_id = symbol;
+                quote.bid_price = 1500000;
+                quote.ask_price = 1500000 + ((s % 4 == 1) ? 2000 : 100);
+                quote.bid_size = 500;
+                quote.ask_size = 500;
+                break;
+            }
+            default: {
+                packet.msg_type = MessageType::ORDER_ADD;
+                packet.payload_size = sizeof(OrderMessage);
+                auto& order = packet.payload.order;
+                order.timestamp_ns = now;
+                order.sequence_num = s;
+                order.symbol_id = symbol;
+                order.order_id = s;
+                order.price = 1500000;
+                order.quantity = 100;
+                order.side = 'B';
+                break;
+            }
+        }
+        return sizeof(MarketDataPacket);
+    }
+
+    void print(const char* tag) const {
+        if (filtered_ > 0) {
+            std::cout << "[" << tag << "] Native - Filtered: " << filtered_ << std::endl;
+        }
+    }
+
+    [[nodiscard]] uint64_t filtered() const noexcept { return filtered_; }
+};
+
+/**
+ * ITCH: NASDAQ ITCH 5.0 over MoldUDP64, message-sequenced
+ */
+class ItchProtocol {
+private:
+    ItchDecoder decoder_;
+
+public:
+    static constexpr const char* NAME = "itch";
+
+    /**
+     * Heartbeat / end of session consume no sequence numbers - keep them
+     * away from the duplicate filter (every heartbeat repeats a sequence)
+     */
+    [[nodiscard]] bool sequence(const uint8_t* data, size_t size,
+                                uint64_t& seq, uint64_t& count) const noexcept {
+        itch::MoldHeader header;
+        if (!itch::parse_mold_header(data, size, header) ||
+            header.message_count == 0 || header.message_count == itch::MOLD_END_OF_SESSION) {
+            return false;
+        }
+        seq = header.sequence;
+        count = header.message_count;
+        return true;
+    }
+
+    template<typename Sink, typename Accept = AllSymbols>
+    void decode(const uint8_t* data, size_t size, uint64_t recv_tsc, Sink&& sink,
+                const Accept& accept = Accept{}) noexcept {
+        decoder_.decode_packet(data, size, recv_tsc, sink, accept);
+    }
+
+    /**
+     * Add / replace / execute / cancel / delete / trade per packet, so
+     * every table handler runs; every 16th trade is a large buy
+     */
+    static size_t make_warmup_packet(uint8_t* buffer, uint64_t& seq) noexcept {
+        ItchPacketBuilder builder;
+        builder.begin(seq);
+        const uint64_t now = LatencyTracker::rdtsc();
+        const uint16_t locate = static_cast<uint16_t>(1 + seq % 64);
+        const uint64_t ref = seq * 2;
+        const bool big = (seq / 6) % 16 == 0;
+
+        (void)builder.add_order(locate, now, ref, 'B', 100, 1500000);
+        (void)builder.order_replace(locate, now, ref, ref + 1, 200, 1500100);
+        (void)builder.order_executed(locate, now, ref + 1, 50, seq);
+        (void)builder.order_cancel(locate, now, ref + 1, 50);
+        (void)builder.order_delete(locate, now, ref + 1);
+        (void)builder.trade(locate, now, 0, big ? 'B' : 'S', big ? 20000 : 100, 1500000, seq);
+
+        seq += builder.count();
+        std::memcpy(buffer, builder.data(), builder.size());
+        return builder.size();
+    }
+
+    void print(const char* tag) const {
+        std::cout << "[" << tag << "] ITCH - Decoded: " << decoder_.decoded()
+                  << ", Skipped types: " << decoder_.skipped()
+                  << ", Malformed: " << decoder_.malformed()
+                  << ", Filtered: " << decoder_.filtered() << std::endl;
+    }
+
+    /**
+     * Decode counters (decoded / skipped types / malformed / filtered)
+     */
+    const ItchDecoder& decoder() const noexcept {
+        return decoder_;
+    }
+};
+
+/**
+ * SBE: CME MDP 3.0 style SBE, packet-sequenced, many entries per packet
+ */
+class SbeProtocol {
+private:
+    SbeDecoder decoder_;
+
+public:
+    static constexpr const char* NAME = "sbe";
+
+    [[nodiscard]] bool sequence(const uint8_t* data, size_t size,
+                                uint64_t& seq, uint64_t& count) const noexcept {
+        if (size < sbe::PACKET_HEADER_SIZE) {
+            return false;
+        }
+        seq = sbe::PacketHeader(data).msg_seq_num();
+        count = 1;
+        return true;
+    }
+
+    template<typename Sink, typename Accept = AllSymbols>
+    void decode(const uint8_t* data, size_t size, uint64_t recv_tsc, Sink&& sink,
+                const Accept& accept = Accept{}) noexcept {
+        decoder_.decode_packet(data, size, recv_tsc, sink, accept);
+    }
+
+    /**
+     * A 4-level book update plus a trade summary per packet; every 16th
+     * trade is a large buy
+     */
+    static size_t make_warmup_packet(uint8_t* buffer, uint64_t& seq) noexcept {
+        SbePacketBuilder builder;
+        const uint64_t s = seq++;
+        const uint64_t now = LatencyTracker::rdtsc();
+        const int32_t security = static_cast<int32_t>(1 + s % 64);
+        const bool big = s % 16 == 0;
+
+        builder.begin(static_cast<uint32_t>(s), now);
+        (void)builder.begin_book(now);
+        for (uint8_t level = 1; level <= 4; ++level) {
+            (void)builder.add_book_entry(security, 1500000 - level * 100, 500, level, 'B',
+                                         static_cast<uint8_t>(s % 3));
+        }
+        (void)builder.begin_trades(now);
+        (void)builder.add_trade_entry(security, 1500000, big ? 20000 : 100, big ? 'B' : 'S',
+                                      static_cast<uint32_t>(s));
+
+        const size_t size = builder.size();
+        std::memcpy(buffer, builder.data(), size);
+        return size;
+    }
+
+    void print(const char* tag) const {
+        std::cout << "[" << tag << "] SBE - Messages: " << decoder_.messages()
+                  << ", Entries: " << decoder_.entries()
+                  << ", Skipped: " << decoder_.skipped()
+                  << ", Malformed: " << decoder_.malformed()
+                  << ", Filtered: " << decoder_.filtered() << std::endl;
+    }
+
+    /**
+     * Decode counters (messages / entries / skipped / malformed / filtered)
+     */
+    const SbeDecoder& decoder() const noexcept {
+        return decoder_;
+    }
+};
+
+} // namespace hft
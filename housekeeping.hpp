@@ -0,0 +1,170 @@
+#pragma once
+
+#include "utils.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <time.h>
+
+namespace hft {
+
+// External global for shutdown signaling
+extern std::atomic<bool> g_running;
+
+/**
+ * Housekeeping Flags
+ *
+ * Timer bits the housekeeping thread raises for a hot thread. The hot loop
+ * does one relaxed byte load per iteration and only takes (exchange) the
+ * bits when one is set - the line is written once per timer period.
+ */
+class HousekeepingFlags {
+private:
+    alignas(64) std::atomic<uint8_t> bits_{0};
+
+public:
+    /**
+     * Housekeeping thread - release pairs with take()
+     */
+    void raise(uint8_t bits) noexcept {
+        bits_.fetch_or(bits, std::memory_order_release);
+    }
+
+    /**
+     * Hot path: anything due?
+     */
+    [[nodiscard]] inline bool pending() const noexcept {
+        return bits_.load(std::memory_order_relaxed) != 0;
+    }
+
+    /**
+     * Hot thread: claim every due bit
+     */
+    [[nodiscard]] uint8_t take() noexcept {
+        return bits_.exchange(0, std::memory_order_acquire);
+    }
+};
+
+/**
+ * Housekeeping Thread
+ *
+ * Everything periodic that used to run inside the hot loops - gap timeout
+ * checks, stats formatting, printing, logging - is driven from here:
+ *
+ * - timers: raise a HousekeepingFlags bit every interval; the hot thread
+ *   does the minimal owner-only part (e.g. PacketManager maintenance,
+ *   copying a stats snapshot into an SPSC queue)
+ * - tasks: run on this thread every pass; they drain those queues and do
+ *   the slow part (snprintf, std::cout, the async logger, recovery requests)
+ *
+ * Not pinned unless a housekeeping core is given; sleeps between passes.
+ * Register everything before run(). Tasks run once more after shutdown so
+ * nothing queued is lost.
+ */
+class Housekeeper {
+public:
+    static constexpr size_t MAX_TIMERS = 16;
+    static constexpr size_t MAX_TASKS = 16;
+
+private:
+    struct Timer {
+        HousekeepingFlags* flags{nullptr};
+        uint8_t bits{0};
+        uint64_t interval_ns{0};
+        uint64_t next_ns{0};
+    };
+
+    Timer timers_[MAX_TIMERS];
+    size_t num_timers_{0};
+    std::function<void()> tasks_[MAX_TASKS];
+    size_t num_tasks_{0};
+
+    int core_id_;
+    uint64_t poll_us_;
+    uint64_t passes_{0};
+
+public:
+    explicit Housekeeper(int core_id = -1, uint64_t poll_us = 1000) noexcept
+        : core_id_(core_id), poll_us_(poll_us) {}
+
+    /**
+     * Raise bits on flags every interval_ns
+     */
+    bool add_timer(HousekeepingFlags& flags, uint8_t bits, uint64_t interval_ns) noexcept {
+        if (num_timers_ == MAX_TIMERS) {
+            return false;
+        }
+        timers_[num_timers_++] = Timer{&flags, bits, interval_ns, 0};
+        return true;
+    }
+
+    /**
+     * Run fn on the housekeeping thread every pass
+     */
+    template<typename Fn>
+    bool add_task(Fn&& fn) {
+        if (num_tasks_ == MAX_TASKS) {
+            return false;
+        }
+        tasks_[num_tasks_++] = std::forward<Fn>(fn);
+        return true;
+    }
+
+    /**
+     * Housekeeping loop until shutdown
+     */
+    void run() {
+        if (core_id_ >= 0 && !ThreadUtils::pin_to_core(core_id_)) {
+            std::cerr << "[Housekeeper] Failed to pin to core " << core_id_ << std::endl;
+        }
+
+        const uint64_t start = now_ns();
+        for (size_t i = 0; i < num_timers_; ++i) {
+            timers_[i].next_ns = start + timers_[i].interval_ns;
+        }
+
+        while (g_running.load(std::memory_order_acquire)) {
+            pass(now_ns());
+            std::this_thread::sleep_for(std::chrono::microseconds(poll_us_));
+        }
+
+        // Final drain - hot threads may have queued work on their way out
+        run_tasks();
+    }
+
+    /**
+     * One pass: raise due timers, then run every task
+     */
+    void pass(uint64_t now) {
+        for (size_t i = 0; i < num_timers_; ++i) {
+            Timer& t = timers_[i];
+            if (now >= t.next_ns) {
+                t.flags->raise(t.bits);
+                // Skip missed periods rather than raising a burst
+                t.next_ns = now + t.interval_ns;
+            }
+        }
+        run_tasks();
+        passes_++;
+    }
+
+    [[nodiscard]] uint64_t passes() const noexcept { return passes_; }
+
+    static uint64_t now_ns() noexcept {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+    }
+
+private:
+    void run_tasks() {
+        for (size_t i = 0; i < num_tasks_; ++i) {
+            tasks_[i]();
+        }
+    }
+};
+
+} // namespace hft
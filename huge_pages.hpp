@@ -0,0 +1,358 @@
+#pragma once
+
+#include <sys/mman.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <utility>
+
+namespace hft {
+
+/**
+ * Huge Page Text and Stacks
+ *
+ * Hot-path code is spread over many 4KB pages (templates, inlined helpers,
+ * logger, queue code) - more pages than the iTLB holds, so after any
+ * excursion through other code the first packet pays page walks. One 2MB
+ * page covers the whole hot path with a single iTLB entry.
+ *
+ * - remap_text(): copies the executable's .text onto huge pages and swaps
+ *   the copy in with one mremap() - the code running the remap is never
+ *   unmapped, it just continues on the new pages
+ * - HugePageThread: pthread whose stack is 2MB-page backed, so stack
+ *   accesses on the hot threads stop competing for dTLB entries
+ *
+ * Backing is hugetlbfs (MAP_HUGETLB, needs vm.nr_hugepages) with a
+ * fallback to transparent huge pages (MADV_HUGEPAGE, needs THP set to
+ * madvise or always). Everything fails soft: on error the process keeps
+ * its 4KB pages.
+ *
+ * Call remap_text() early in main(), before other threads exist and before
+ * Prefault::lock_all_memory(). Remapped text is anonymous memory - perf
+ * and gdb lose symbols for it (use perf map files or skip in profiling runs).
+ *
+ * Binaries smaller than 2MB need their text segment 2MB-aligned to have
+ * anything to remap: make production HUGE_TEXT=1
+ */
+class HugePages {
+public:
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    /**
+     * Move the executable's text segment onto 2MB pages
+     *
+     * @return bytes remapped (0 = nothing remapped, process unchanged)
+     */
+    static size_t remap_text() noexcept {
+        uintptr_t start = 0;
+        uintptr_t end = 0;
+        uintptr_t next = 0;
+        if (!find_text_mapping(start, end, next)) {
+            std::cerr << "[HugePages] Executable text mapping not found" << std::endl;
+            return 0;
+        }
+
+        // Whole huge pages only - extend the tail into the gap before the
+        // next mapping when the linker left one (HUGE_TEXT=1 builds)
+        const uintptr_t from = align_up(start);
+        uintptr_t to = align_down(end);
+        if (align_up(end) <= next) {
+            to = align_up(end);
+        }
+        if (to <= from) {
+            std::cerr << "[HugePages] Text (" << (end - start) / 1024
+                      << " KB) spans no aligned 2MB page - build with HUGE_TEXT=1" << std::endl;
+            return 0;
+        }
+
+        const size_t size = to - from;
+        const size_t copy = std::min(end, to) - from;
+
+        for (const bool hugetlb : {true, false}) {
+            void* staging = map_aligned(size, hugetlb);
+            if (!staging) continue;
+
+            std::memcpy(staging, reinterpret_cast<const void*>(from), copy);
+            if (mprotect(staging, size, PROT_READ | PROT_EXEC) == 0 &&
+                mremap(staging, size, size, MREMAP_MAYMOVE | MREMAP_FIXED,
+                       reinterpret_cast<void*>(from)) != MAP_FAILED) {
+                std::cout << "[HugePages] Remapped " << size / 1024 << " KB of text onto "
+                          << (hugetlb ? "hugetlb" : "THP") << " pages ("
+                          << huge_kb(reinterpret_cast<const void*>(from)) << " KB huge)" << std::endl;
+                return size;
+            }
+            munmap(staging, size);
+        }
+
+        std::cerr << "[HugePages] Text remap failed - no hugetlb pages (vm.nr_hugepages) "
+                     "and no THP (transparent_hugepage=never?)" << std::endl;
+        return 0;
+    }
+
+    /**
+     * Huge-page backed memory in the mapping containing addr (from smaps)
+     * THP (AnonHugePages) and hugetlbfs (Private/Shared_Hugetlb) both count.
+     */
+    [[nodiscard]] static size_t huge_kb(const void* addr) noexcept {
+        FILE* f = fopen("/proc/self/smaps", "r");
+        if (!f) return 0;
+
+        const uintptr_t target = reinterpret_cast<uintptr_t>(addr);
+        bool in_mapping = false;
+        size_t kb = 0;
+        char line[512];
+        while (fgets(line, sizeof(line), f)) {
+            unsigned long lo = 0;
+            unsigned long hi = 0;
+            if (sscanf(line, "%lx-%lx ", &lo, &hi) == 2) {     // Mapping header line
+                if (in_mapping) break;
+                in_mapping = target >= lo && target < hi;
+                continue;
+            }
+            if (!in_mapping) continue;
+
+            unsigned long value = 0;
+            if (sscanf(line, "AnonHugePages: %lu", &value) == 1 ||
+                sscanf(line, "Private_Hugetlb: %lu", &value) == 1 ||
+                sscanf(line, "Shared_Hugetlb: %lu", &value) == 1) {
+                kb += value;
+            }
+        }
+        fclose(f);
+        return kb;
+    }
+
+    /**
+     * 2MB-aligned anonymous mapping on huge pages
+     *
+     * @param hugetlb true: MAP_HUGETLB; false: THP via MADV_HUGEPAGE
+     * @return nullptr on failure
+     */
+    [[nodiscard]] static void* map_aligned(size_t size, bool hugetlb) noexcept {
+        if (hugetlb) {
+            void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            return p == MAP_FAILED ? nullptr : p;
+        }
+
+        // THP only backs 2MB-aligned ranges - over-allocate and trim
+        void* raw = mmap(nullptr, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) return nullptr;
+
+        const uintptr_t base = reinterpret_cast<uintptr_t>(raw);
+        const uintptr_t aligned = align_up(base);
+        if (aligned > base) {
+            munmap(raw, aligned - base);
+        }
+        const uintptr_t tail = aligned + size;
+        const uintptr_t raw_end = base + size + HUGE_PAGE_SIZE;
+        if (raw_end > tail) {
+            munmap(reinterpret_cast<void*>(tail), raw_end - tail);
+        }
+
+        void* p = reinterpret_cast<void*>(aligned);
+        madvise(p, size, MADV_HUGEPAGE);
+        return p;
+    }
+
+    static constexpr uintptr_t align_up(uintptr_t v) noexcept {
+        return (v + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    }
+
+    static constexpr uintptr_t align_down(uintptr_t v) noexcept {
+        return v & ~(HUGE_PAGE_SIZE - 1);
+    }
+
+private:
+    /**
+     * Executable mapping of our own binary in /proc/self/maps
+     *
+     * @param next Start of the following mapping (free gap = [end, next))
+     */
+    static bool find_text_mapping(uintptr_t& start, uintptr_t& end, uintptr_t& next) noexcept {
+        char exe[512];
+        const ssize_t len = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+        if (len <= 0) return false;
+        exe[len] = '\0';
+
+        FILE* f = fopen("/proc/self/maps", "r");
+        if (!f) return false;
+
+        bool found = false;
+        char line[1024];
+        while (fgets(line, sizeof(line), f)) {
+            unsigned long lo = 0;
+            unsigned long hi = 0;
+            char perms[8] = {};
+            if (sscanf(line, "%lx-%lx %7s", &lo, &hi, perms) != 3) continue;
+
+            if (found) {
+                next = lo;
+                fclose(f);
+                return true;
+            }
+
+            const char* path = strchr(line, '/');
+            if (perms[2] != 'x' || !path) continue;
+            if (strncmp(path, exe, static_cast<size_t>(len)) == 0 &&
+                (path[len] == '\n' || path[len] == '\0')) {
+                start = lo;
+                end = hi;
+                found = true;
+            }
+        }
+        fclose(f);
+        next = found ? UINTPTR_MAX : 0;
+        return found;
+    }
+};
+
+/**
+ * Thread stack on huge pages
+ *
+ * Layout inside one reservation: [guard (PROT_NONE)][stack, 2MB aligned]
+ * The guard catches overflow the same way the default pthread guard does.
+ */
+class HugePageStack {
+private:
+    void* reservation_{nullptr};
+    size_t reservation_size_{0};
+    void* stack_{nullptr};
+    size_t size_{0};
+    bool hugetlb_{false};
+
+public:
+    HugePageStack() = default;
+
+    ~HugePageStack() {
+        release();
+    }
+
+    HugePageStack(const HugePageStack&) = delete;
+    HugePageStack& operator=(const HugePageStack&) = delete;
+
+    /**
+     * @param size Rounded up to a whole number of 2MB pages
+     */
+    bool allocate(size_t size) noexcept {
+        release();
+        size_ = HugePages::align_up(size);
+
+        // Room to align plus at least one guard page below the stack
+        reservation_size_ = size_ + 2 * HugePages::HUGE_PAGE_SIZE;
+        void* reservation = mmap(nullptr, reservation_size_, PROT_NONE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (reservation == MAP_FAILED) {
+            return false;
+        }
+        reservation_ = reservation;
+
+        const uintptr_t base = reinterpret_cast<uintptr_t>(reservation_);
+        void* want = reinterpret_cast<void*>(HugePages::align_up(base + 4096));
+
+        void* p = mmap(want, size_, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_STACK | MAP_HUGETLB, -1, 0);
+        hugetlb_ = p != MAP_FAILED;
+        if (!hugetlb_) {
+            p = mmap(want, size_, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_STACK, -1, 0);
+            if (p == MAP_FAILED) {
+                release();
+                return false;
+            }
+            madvise(p, size_, MADV_HUGEPAGE);
+        }
+        stack_ = p;
+        return true;
+    }
+
+    void release() noexcept {
+        if (reservation_) {
+            munmap(reservation_, reservation_size_);
+        }
+        reservation_ = nullptr;
+        reservation_size_ = 0;
+        stack_ = nullptr;
+        size_ = 0;
+        hugetlb_ = false;
+    }
+
+    [[nodiscard]] void* base() const noexcept { return stack_; }
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+    [[nodiscard]] bool hugetlb() const noexcept { return hugetlb_; }
+};
+
+/**
+ * Thread with a huge-page stack
+ *
+ * Drop-in for std::thread on the pipeline threads:
+ *   HugePageThread t;
+ *   t.start([&] { engine.run(); });
+ *   ...
+ *   t.join();
+ *
+ * Falls back to a default pthread stack if no huge-page memory is available.
+ */
+class HugePageThread {
+private:
+    static constexpr size_t DEFAULT_STACK_SIZE = 4 * 1024 * 1024;
+
+    pthread_t thread_{};
+    bool started_{false};
+    HugePageStack stack_;
+    std::function<void()> fn_;
+
+public:
+    HugePageThread() = default;
+
+    ~HugePageThread() {
+        join();
+    }
+
+    HugePageThread(const HugePageThread&) = delete;
+    HugePageThread& operator=(const HugePageThread&) = delete;
+
+    template<typename Fn>
+    bool start(Fn&& fn, size_t stack_size = DEFAULT_STACK_SIZE) noexcept {
+        if (started_) return false;
+        fn_ = std::forward<Fn>(fn);
+
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        if (stack_.allocate(stack_size)) {
+            pthread_attr_setstack(&attr, stack_.base(), stack_.size());
+        } else {
+            std::cerr << "[HugePages] Stack allocation failed - using default thread stack" << std::endl;
+        }
+
+        started_ = pthread_create(&thread_, &attr, &HugePageThread::entry, this) == 0;
+        pthread_attr_destroy(&attr);
+        return started_;
+    }
+
+    void join() noexcept {
+        if (started_) {
+            pthread_join(thread_, nullptr);
+            started_ = false;
+        }
+        stack_.release();
+    }
+
+    [[nodiscard]] bool huge_stack() const noexcept { return stack_.base() != nullptr; }
+    [[nodiscard]] const HugePageStack& stack() const noexcept { return stack_; }
+
+private:
+    static void* entry(void* self) {
+        static_cast<HugePageThread*>(self)->fn_();
+        return nullptr;
+    }
+};
+
+} // namespace hft
@@ -0,0 +1,54 @@
+#include "utils.hpp"
+#include "jitter_probe.hpp"
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+
+using namespace hft;
+
+/**
+ * CORE JITTER CHECK
+ *
+ * Pre-flight check for a trading host: validates kernel isolation settings
+ * (isolcpus, nohz_full, rcu_nocbs, IRQ affinity, governor) for each core,
+ * then spins on it and reports every TSC gap above the threshold along
+ * with the interrupts/softirqs that fired there meanwhile.
+ *
+ * Run it on an idle box after boot-parameter or IRQ affinity changes.
+ * Exit code is non-zero if any core fails, so it can gate deployment.
+ *
+ * Usage:
+ *   ./jitter_check [cores=0,1] [duration_ms=1000] [threshold_ns=2000]
+ */
+int main(int argc, char* argv[]) {
+    std::vector<int> cores;
+    const char* p = argc > 1 ? argv[1] : "0,1";
+    while (*p) {
+        cores.push_back(std::atoi(p));
+        while (*p && *p != ',') p++;
+        if (*p == ',') p++;
+    }
+    const uint64_t duration_ms = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000;
+    const uint64_t threshold_ns = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 2000;
+
+    const double tsc_ghz = LatencyTracker::calibrate_tsc_ghz();
+    std::cout << "[Jitter] TSC " << tsc_ghz << " GHz, " << duration_ms << "ms per core, threshold "
+              << threshold_ns << "ns" << std::endl;
+
+    int failed = 0;
+    for (const int core : cores) {
+        const CoreEnvironment env = CoreEnvironment::check(core);
+        env.print();
+
+        JitterReport report;
+        JitterProbe::probe_core(core, duration_ms, threshold_ns, tsc_ghz, report);
+        report.print();
+
+        if (!env.ok() || !report.pinned || report.gaps_ns.count() > 0) {
+            failed++;
+        }
+    }
+
+    std::cout << "[Jitter] " << cores.size() - failed << "/" << cores.size() << " cores quiet" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,487 @@
+#pragma once
+
+#include "utils.hpp"
+#include "latency_histogram.hpp"
+#include <dirent.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace hft {
+
+// ============================================================================
+// /proc and /sys helpers
+// ============================================================================
+
+/**
+ * First line of a sysfs/procfs file, trailing whitespace stripped
+ * Empty string if the file does not exist (feature not configured)
+ */
+inline std::string read_first_line(const std::string& path) {
+    std::ifstream in(path);
+    std::string line;
+    if (!in.is_open() || !std::getline(in, line)) {
+        return {};
+    }
+    while (!line.empty() && (line.back() == '\n' || line.back() == ' ' || line.back() == '\t')) {
+        line.pop_back();
+    }
+    return line;
+}
+
+/**
+ * Kernel cpulist format: "0-3,8,10-11" (also accepts "2-15:2" stride form)
+ */
+inline bool cpu_in_list(const std::string& list, int cpu) {
+    const char* p = list.c_str();
+    while (*p) {
+        char* end = nullptr;
+        const long lo = std::strtol(p, &end, 10);
+        if (end == p) break;
+        long hi = lo;
+        long stride = 1;
+        p = end;
+        if (*p == '-') {
+            hi = std::strtol(p + 1, &end, 10);
+            p = end;
+            if (*p == ':') {
+                stride = std::max(1L, std::strtol(p + 1, &end, 10));
+                p = end;
+            }
+        }
+        if (cpu >= lo && cpu <= hi && (cpu - lo) % stride == 0) {
+            return true;
+        }
+        while (*p == ',' || *p == ' ') p++;
+    }
+    return false;
+}
+
+/**
+ * Kernel hex cpumask format: "ff,ffffffff" (most significant word first)
+ */
+inline bool cpu_in_mask(const std::string& mask, int cpu) {
+    int bit = 0;
+    for (auto it = mask.rbegin(); it != mask.rend(); ++it) {
+        if (*it == ',') continue;
+        const char c = *it;
+        const int nibble = (c >= '0' && c <= '9') ? c - '0'
+                         : (c >= 'a' && c <= 'f') ? c - 'a' + 10
+                         : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : 0;
+        if (cpu >= bit && cpu < bit + 4) {
+            return (nibble >> (cpu - bit)) & 1;
+        }
+        bit += 4;
+    }
+    return false;
+}
+
+// ============================================================================
+// Interrupt / softirq / context switch snapshot
+// ============================================================================
+
+/**
+ * Counters that explain a latency gap on one CPU
+ *
+ * - /proc/interrupts: hardware IRQs + IPIs (LOC timer, RES rescheduling,
+ *   CAL function call, TLB shootdowns) delivered to this CPU
+ * - /proc/softirqs: TIMER, NET_RX, SCHED, RCU ... run on this CPU
+ * - Calling thread's voluntary/involuntary context switches
+ */
+struct InterruptSnapshot {
+    std::vector<std::pair<std::string, uint64_t>> counts;
+    uint64_t voluntary_ctx_switches{0};
+    uint64_t involuntary_ctx_switches{0};
+
+    static InterruptSnapshot capture(int cpu) {
+        InterruptSnapshot snap;
+        parse_per_cpu_table("/proc/interrupts", "", cpu, snap.counts);
+        parse_per_cpu_table("/proc/softirqs", "softirq:", cpu, snap.counts);
+
+        std::ifstream status("/proc/thread-self/status");
+        std::string line;
+        while (std::getline(status, line)) {
+            if (line.rfind("voluntary_ctxt_switches:", 0) == 0) {
+                snap.voluntary_ctx_switches = std::strtoull(line.c_str() + 24, nullptr, 10);
+            } else if (line.rfind("nonvoluntary_ctxt_switches:", 0) == 0) {
+                snap.involuntary_ctx_switches = std::strtoull(line.c_str() + 27, nullptr, 10);
+            }
+        }
+        return snap;
+    }
+
+    /**
+     * Non-zero deltas (this - before), largest first
+     */
+    std::vector<std::pair<std::string, uint64_t>> delta_since(const InterruptSnapshot& before) const {
+        std::vector<std::pair<std::string, uint64_t>> out;
+        for (const auto& [name, count] : counts) {
+            for (const auto& [prev_name, prev_count] : before.counts) {
+                if (prev_name == name) {
+                    if (count > prev_count) out.emplace_back(name, count - prev_count);
+                    break;
+                }
+            }
+        }
+        std::sort(out.begin(), out.end(),
+                  [](const auto& a, const auto& b) { return a.second > b.second; });
+        return out;
+    }
+
+private:
+    /**
+     * Header row lists online CPUs ("CPU0 CPU2 ..." - offline ones are
+     * skipped), so the column is looked up by name, not by index
+     */
+    static void parse_per_cpu_table(const char* path, const char* prefix, int cpu,
+                                    std::vector<std::pair<std::string, uint64_t>>& out) {
+        std::ifstream in(path);
+        std::string line;
+        if (!in.is_open() || !std::getline(in, line)) {
+            return;
+        }
+
+        const std::string want = "CPU" + std::to_string(cpu);
+        std::istringstream header(line);
+        std::string token;
+        int column = -1;
+        int num_columns = 0;
+        while (header >> token) {
+            if (token == want) column = num_columns;
+            num_columns++;
+        }
+        if (column < 0) {
+            return;
+        }
+
+        while (std::getline(in, line)) {
+            std::istringstream row(line);
+            std::string label;
+            if (!(row >> label)) continue;
+            if (!label.empty() && label.back() == ':') label.pop_back();
+
+            uint64_t value = 0;
+            bool found = false;
+            for (int c = 0; c < num_columns && row >> token; ++c) {
+                if (token.empty() || token[0] < '0' || token[0] > '9') break;
+                if (c == column) {
+                    value = std::strtoull(token.c_str(), nullptr, 10);
+                    found = true;
+                }
+            }
+            if (!found) continue;
+
+            // Numbered IRQs: append the device name (last token) for readability
+            std::string desc;
+            std::string rest;
+            while (row >> rest) desc = rest;
+            std::string name = prefix + label;
+            if (!desc.empty() && label[0] >= '0' && label[0] <= '9') {
+                name += " (" + desc + ")";
+            }
+            out.emplace_back(std::move(name), value);
+        }
+    }
+};
+
+// ============================================================================
+// Environment validation
+// ============================================================================
+
+/**
+ * Does the kernel configuration let this core hit our latency targets?
+ *
+ * A busy-poll core needs to be left alone by the kernel:
+ * - isolcpus / cpuset isolation: scheduler won't place other tasks there
+ * - nohz_full: no 1-4ms scheduler tick while a single task runs
+ * - rcu_nocbs: RCU callbacks offloaded to other cores
+ * - IRQ affinity: no device interrupts routed to the core
+ * - performance governor: no frequency ramp after idle
+ */
+struct CoreEnvironment {
+    int cpu{-1};
+    bool online{false};
+    bool isolated{false};
+    bool nohz_full{false};
+    bool rcu_nocbs{false};
+    bool default_irq_affinity{false};
+    std::string governor;
+    std::vector<int> irqs_on_core;
+    std::vector<std::string> warnings;
+
+    [[nodiscard]] bool ok() const noexcept { return warnings.empty(); }
+
+    static CoreEnvironment check(int cpu) {
+        CoreEnvironment env;
+        env.cpu = cpu;
+        env.online = cpu_in_list(read_first_line("/sys/devices/system/cpu/online"), cpu);
+        env.isolated = cpu_in_list(read_first_line("/sys/devices/system/cpu/isolated"), cpu);
+        env.nohz_full = cpu_in_list(read_first_line("/sys/devices/system/cpu/nohz_full"), cpu);
+        env.rcu_nocbs = cpu_in_list(cmdline_value("rcu_nocbs="), cpu);
+        env.governor = read_first_line("/sys/devices/system/cpu/cpu" + std::to_string(cpu) +
+                                       "/cpufreq/scaling_governor");
+        env.default_irq_affinity = cpu_in_mask(read_first_line("/proc/irq/default_smp_affinity"), cpu);
+        collect_irqs(cpu, env.irqs_on_core);
+
+        if (!env.online) {
+            env.warnings.emplace_back("cpu is not online");
+            return env;
+        }
+        if (!env.isolated) env.warnings.emplace_back("not in isolcpus - scheduler may run other tasks here");
+        if (!env.nohz_full) env.warnings.emplace_back("not in nohz_full - scheduler tick interrupts the spin loop");
+        if (!env.rcu_nocbs) env.warnings.emplace_back("not in rcu_nocbs - RCU callbacks run here");
+        if (!env.governor.empty() && env.governor != "performance") {
+            env.warnings.emplace_back("cpufreq governor '" + env.governor + "' (want performance)");
+        }
+        if (!env.irqs_on_core.empty()) {
+            env.warnings.emplace_back(std::to_string(env.irqs_on_core.size()) +
+                                   " device IRQs have affinity to this cpu");
+        }
+        if (env.default_irq_affinity) {
+            env.warnings.emplace_back("in /proc/irq/default_smp_affinity - new IRQs land here");
+        }
+        return env;
+    }
+
+    void print() const {
+        std::cout << "[Jitter] cpu" << cpu << " environment: isolated=" << isolated
+                  << " nohz_full=" << nohz_full << " rcu_nocbs=" << rcu_nocbs
+                  << " governor=" << (governor.empty() ? "n/a" : governor)
+                  << " irqs=" << irqs_on_core.size() << std::endl;
+        for (const auto& w : warnings) {
+            std::cout << "[Jitter]   WARNING: " << w << std::endl;
+        }
+    }
+
+private:
+    static std::string cmdline_value(const char* key) {
+        const std::string cmdline = read_first_line("/proc/cmdline");
+        const size_t pos = cmdline.find(key);
+        if (pos == std::string::npos) return {};
+        const size_t start = pos + strlen(key);
+        const size_t end = cmdline.find(' ', start);
+        return cmdline.substr(start, end == std::string::npos ? std::string::npos : end - start);
+    }
+
+    /**
+     * IRQs whose (effective) affinity includes cpu
+     * effective_affinity_list is where the IRQ actually fires; older
+     * kernels only have smp_affinity_list (the allowed set)
+     */
+    static void collect_irqs(int cpu, std::vector<int>& irqs) {
+        DIR* dir = opendir("/proc/irq");
+        if (!dir) return;
+        while (dirent* entry = readdir(dir)) {
+            if (entry->d_name[0] < '0' || entry->d_name[0] > '9') continue;
+            const std::string base = std::string("/proc/irq/") + entry->d_name;
+            std::string list = read_first_line(base + "/effective_affinity_list");
+            if (list.empty()) list = read_first_line(base + "/smp_affinity_list");
+            if (cpu_in_list(list, cpu)) {
+                irqs.push_back(std::atoi(entry->d_name));
+            }
+        }
+        closedir(dir);
+        std::sort(irqs.begin(), irqs.end());
+    }
+};
+
+// ============================================================================
+// Active jitter probe (startup)
+// ============================================================================
+
+/**
+ * Result of spinning on one core
+ */
+struct JitterReport {
+    int cpu{-1};
+    bool pinned{false};
+    uint64_t duration_ns{0};
+    uint64_t iterations{0};
+    uint64_t threshold_ns{0};
+    uint64_t stolen_ns{0};              // Sum of gaps above threshold
+    LatencyHistogram gaps_ns;           // Only gaps above threshold
+    std::vector<std::pair<std::string, uint64_t>> interrupt_deltas;
+    uint64_t voluntary_ctx_switches{0};
+    uint64_t involuntary_ctx_switches{0};
+
+    /**
+     * Fraction of wall time the spinning thread did not get
+     */
+    [[nodiscard]] double stolen_fraction() const noexcept {
+        return duration_ns ? static_cast<double>(stolen_ns) / static_cast<double>(duration_ns) : 0.0;
+    }
+
+    void print() const {
+        std::cout << "[Jitter] cpu" << cpu << (pinned ? "" : " (NOT PINNED)") << ": "
+                  << gaps_ns.count() << " gaps > " << threshold_ns << "ns in "
+                  << duration_ns / 1000000 << "ms, stolen " << stolen_fraction() * 100.0 << "%"
+                  << ", ctx switches " << voluntary_ctx_switches << "/" << involuntary_ctx_switches
+                  << " (vol/invol)" << std::endl;
+        if (gaps_ns.count() > 0) {
+            std::cout << "[Jitter]   gap ns: p50=" << gaps_ns.percentile(50.0)
+                      << " p99=" << gaps_ns.percentile(99.0) << " max=" << gaps_ns.max() << std::endl;
+        }
+
+        // Top sources - what fired on this cpu while we were spinning
+        const size_t shown = std::min<size_t>(interrupt_deltas.size(), 6);
+        for (size_t i = 0; i < shown; ++i) {
+            std::cout << "[Jitter]   " << interrupt_deltas[i].first << ": +"
+                      << interrupt_deltas[i].second << std::endl;
+        }
+    }
+};
+
+/**
+ * OS Jitter Probe
+ *
+ * Spins reading the TSC on a pinned core; any gap between consecutive reads
+ * above threshold is time the core was taken away (IRQ, softirq, tick,
+ * SMI, preemption). Interrupt/softirq/context-switch counters are
+ * snapshotted around the run so each gap has a likely culprit.
+ *
+ * Same method as sysjitter / hiccups, in-process so it validates the exact
+ * cores we are about to use.
+ */
+class JitterProbe {
+public:
+    /**
+     * Spin on the calling thread (caller pins it)
+     */
+    static void spin(int cpu, uint64_t duration_ms, uint64_t threshold_ns, double tsc_ghz,
+                     JitterReport& report) {
+        report.cpu = cpu;
+        report.threshold_ns = threshold_ns;
+
+        const uint64_t threshold_ticks = static_cast<uint64_t>(threshold_ns * tsc_ghz);
+        const uint64_t duration_ticks = static_cast<uint64_t>(duration_ms * 1000000.0 * tsc_ghz);
+
+        const InterruptSnapshot before = InterruptSnapshot::capture(cpu);
+
+        const uint64_t start = LatencyTracker::rdtsc();
+        uint64_t prev = start;
+        uint64_t iterations = 0;
+        uint64_t stolen_ticks = 0;
+        while (prev - start < duration_ticks) {
+            const uint64_t now = LatencyTracker::rdtsc();
+            const uint64_t gap = now - prev;
+            if (gap > threshold_ticks) {
+                report.gaps_ns.record(static_cast<uint64_t>(gap / tsc_ghz));
+                stolen_ticks += gap;
+            }
+            prev = now;
+            iterations++;
+        }
+
+        const InterruptSnapshot after = InterruptSnapshot::capture(cpu);
+
+        report.iterations = iterations;
+        report.duration_ns = static_cast<uint64_t>((prev - start) / tsc_ghz);
+        report.stolen_ns = static_cast<uint64_t>(stolen_ticks / tsc_ghz);
+        report.interrupt_deltas = after.delta_since(before);
+        report.voluntary_ctx_switches = after.voluntary_ctx_switches - before.voluntary_ctx_switches;
+        report.involuntary_ctx_switches = after.involuntary_ctx_switches - before.involuntary_ctx_switches;
+    }
+
+    /**
+     * Probe a core from a temporary thread pinned to it
+     *
+     * @return false if the thread could not be pinned (report still filled,
+     *         but measures wherever the scheduler ran it)
+     */
+    static bool probe_core(int cpu, uint64_t duration_ms, uint64_t threshold_ns, double tsc_ghz,
+                           JitterReport& report) {
+        std::thread t([&] {
+            report.pinned = ThreadUtils::pin_to_core(cpu);
+            spin(cpu, duration_ms, threshold_ns, tsc_ghz, report);
+        });
+        t.join();
+        return report.pinned;
+    }
+};
+
+// ============================================================================
+// Passive jitter monitor (background, inside busy-poll loops)
+// ============================================================================
+
+/**
+ * Loop-gap monitor for busy-poll threads
+ *
+ * The hot loop already reads the TSC every iteration; on idle iterations
+ * it calls sample(now). A gap above threshold since the previous sample
+ * means the core was stolen while we were waiting for data - exactly when
+ * the next packet would have been delayed. Iterations that did real work
+ * call skip() so processing time is not mistaken for jitter.
+ *
+ * Cost on the hot path: a subtract, a compare and a store.
+ * Histogram is owned by the loop thread; counters are readable anywhere.
+ */
+class JitterMonitor {
+private:
+    uint64_t threshold_ticks_{30000};
+    double tsc_ghz_{3.0};
+    uint64_t last_tsc_{0};
+    bool armed_{false};
+    LatencyHistogram gaps_ns_;
+
+    alignas(64) std::atomic<uint64_t> gap_count_{0};
+    std::atomic<uint64_t> max_gap_ns_{0};
+    std::atomic<uint64_t> threshold_ns_{10000};
+
+public:
+    void configure(double tsc_ghz, uint64_t threshold_ns) noexcept {
+        tsc_ghz_ = tsc_ghz;
+        threshold_ticks_ = static_cast<uint64_t>(threshold_ns * tsc_ghz);
+        threshold_ns_.store(threshold_ns, std::memory_order_relaxed);
+        armed_ = false;
+    }
+
+    inline void sample(uint64_t now_tsc) noexcept {
+        if (armed_ && now_tsc - last_tsc_ > threshold_ticks_) [[unlikely]] {
+            record(now_tsc - last_tsc_);
+        }
+        last_tsc_ = now_tsc;
+        armed_ = true;
+    }
+
+    inline void skip() noexcept {
+        armed_ = false;
+    }
+
+    [[nodiscard]] uint64_t gap_count() const noexcept {
+        return gap_count_.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] uint64_t max_gap_ns() const noexcept {
+        return max_gap_ns_.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] uint64_t threshold_ns() const noexcept {
+        return threshold_ns_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Owner thread only (or after it has stopped)
+     */
+    [[nodiscard]] const LatencyHistogram& gaps_ns() const noexcept { return gaps_ns_; }
+
+private:
+    void record(uint64_t gap_ticks) noexcept {
+        const uint64_t gap_ns = static_cast<uint64_t>(gap_ticks / tsc_ghz_);
+        gaps_ns_.record(gap_ns);
+        gap_count_.store(gap_count_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (gap_ns > max_gap_ns_.load(std::memory_order_relaxed)) {
+            max_gap_ns_.store(gap_ns, std::memory_order_relaxed);
+        }
+    }
+};
+
+} // namespace hft
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <algorithm>
+
+namespace hft {
+
+/**
+ * Log-Linear Latency Histogram (HdrHistogram-style)
+ *
+ * Averages hide everything that matters in HFT - the tail is the product.
+ * This records every sample in O(1) with bounded relative error:
+ *
+ * - Values < 128 recorded exactly
+ * - Above that, each power of two split into 128 linear sub-buckets
+ *   (< 0.8% relative error at any magnitude)
+ * - Fixed 58KB of counters, no allocation, no floating point on record()
+ * - Full 64-bit range (ns, cycles, packets - unit is up to the caller)
+ *
+ * Not thread-safe: one histogram per recording thread, merge() afterwards.
+ */
+class LatencyHistogram {
+private:
+    static constexpr uint32_t SUB_BITS = 7;
+    static constexpr uint64_t SUB_COUNT = 1ULL << SUB_BITS;
+    static constexpr uint64_t SUB_MASK = SUB_COUNT - 1;
+    static constexpr uint32_t NUM_GROUPS = 64 - SUB_BITS + 1;
+    static constexpr size_t NUM_BUCKETS = static_cast<size_t>(NUM_GROUPS) << SUB_BITS;
+
+    uint64_t counts_[NUM_BUCKETS];
+    uint64_t total_count_{0};
+    uint64_t sum_{0};
+    uint64_t min_{UINT64_MAX};
+    uint64_t max_{0};
+
+public:
+    LatencyHistogram() noexcept {
+        reset();
+    }
+
+    /**
+     * Record one sample - hot path safe (~2ns: clz + shift + increment)
+     */
+    void record(uint64_t value) noexcept {
+        counts_[bucket_index(value)]++;
+        total_count_++;
+        sum_ += value;
+        if (value < min_) min_ = value;
+        if (value > max_) max_ = value;
+    }
+
+    void reset() noexcept {
+        std::memset(counts_, 0, sizeof(counts_));
+        total_count_ = 0;
+        sum_ = 0;
+        min_ = UINT64_MAX;
+        max_ = 0;
+    }
+
+    void merge(const LatencyHistogram& other) noexcept {
+        for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        total_count_ += other.total_count_;
+        sum_ += other.sum_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+
+    /**
+     * Value at percentile p (0-100)
+     * Returns the upper bound of the bucket holding the p-th sample,
+     * clamped to the observed max so p100 is exact.
+     */
+    [[nodiscard]] uint64_t percentile(double p) const noexcept {
+        if (total_count_ == 0) return 0;
+
+        uint64_t rank = static_cast<uint64_t>(p / 100.0 * static_cast<double>(total_count_) + 0.5);
+        rank = std::clamp<uint64_t>(rank, 1, total_count_);
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+            seen += counts_[i];
+            if (seen >= rank) {
+                return std::min(bucket_upper(i), max_);
+            }
+        }
+        return max_;
+    }
+
+    [[nodiscard]] uint64_t count() const noexcept { return total_count_; }
+    [[nodiscard]] uint64_t min() const noexcept { return total_count_ ? min_ : 0; }
+    [[nodiscard]] uint64_t max() const noexcept { return max_; }
+
+    [[nodiscard]] double mean() const noexcept {
+        return total_count_ ? static_cast<double>(sum_) / static_cast<double>(total_count_) : 0.0;
+    }
+
+    /**
+     * Samples strictly above threshold (for "how many spikes > X")
+     */
+    [[nodiscard]] uint64_t count_above(uint64_t threshold) const noexcept {
+        uint64_t n = 0;
+        for (size_t i = bucket_index(threshold); i < NUM_BUCKETS; ++i) {
+            n += counts_[i];
+        }
+        return n;
+    }
+
+    /**
+     * Standard summary as a JSON object body (no braces around the name)
+     * e.g. "tick_to_trade_ns": {"count": 1000, "p50": 4200, ...}
+     */
+    [[nodiscard]] std::string to_json(const char* name) const {
+        char buf[512];
+        snprintf(buf, sizeof(buf),
+                 "\"%s\": {\"count\": %lu, \"mean\": %.1f, \"min\": %lu, \"p50\": %lu, "
+                 "\"p90\": %lu, \"p99\": %lu, \"p99.9\": %lu, \"p99.99\": %lu, \"max\": %lu}",
+                 name, total_count_, mean(), min(), percentile(50.0), percentile(90.0),
+                 percentile(99.0), percentile(99.9), percentile(99.99), max());
+        return std::string(buf);
+    }
+
+    /**
+     * One-line human summary
+     */
+    void print(const char* name, const char* unit = "ns") const {
+        printf("%-24s n=%-10lu mean=%-8.0f p50=%-8lu p99=%-8lu p99.9=%-8lu p99.99=%-8lu max=%lu %s\n",
+               name, total_count_, mean(), percentile(50.0), percentile(99.0),
+               percentile(99.9), percentile(99.99), max(), unit);
+    }
+
+private:
+    static size_t bucket_index(uint64_t value) noexcept {
+        if (value < SUB_COUNT) {
+            return static_cast<size_t>(value);
+        }
+        const uint32_t msb = 63 - static_cast<uint32_t>(__builtin_clzll(value));
+        const uint32_t shift = msb - SUB_BITS;
+        const uint64_t group = shift + 1;
+        const uint64_t sub = (value >> shift) & SUB_MASK;
+        return static_cast<size_t>((group << SUB_BITS) + sub);
+    }
+
+    static uint64_t bucket_upper(size_t index) noexcept {
+        const uint64_t group = index >> SUB_BITS;
+        const uint64_t sub = index & SUB_MASK;
+        if (group == 0) {
+            return sub;
+        }
+        const uint32_t shift = static_cast<uint32_t>(group - 1);
+        const uint64_t lower = (SUB_COUNT + sub) << shift;
+        return lower + ((1ULL << shift) - 1);
+    }
+};
+
+} // namespace hft
@@ -7,6 +7,7 @@
 #include <thread>
 #include <atomic>
 #include <fstream>
+#include <iostream>
 #include <chrono>
 #include <sys/time.h>
 
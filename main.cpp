@@ -3,17 +3,32 @@
 #include "logger.hpp"
 #include "feed_handler_impl.hpp"
 #include "trading_engine.hpp"
+#include "jitter_probe.hpp"
+#include "warmup.hpp"
+#include "huge_pages.hpp"
+#include "feed_health.hpp"
+#include "watchdog.hpp"
+#include "housekeeping.hpp"
+#include "book_snapshot.hpp"
+#include "md_broadcast.hpp"
+#include "symbol_filter.hpp"
 #include <iostream>
 #include <thread>
+#include <chrono>
 #include <atomic>
+#include <vector>
 #include <signal.h>
+#include <ctime>
 
 using namespace hft;
 
 /**
  * Global state for graceful shutdown
+ * Defined inside hft so it matches the extern declaration in the headers
  */
+namespace hft {
 std::atomic<bool> g_running{true};
+}
 
 void signal_handler(int signum) {
     (void)signum;
@@ -49,6 +64,12 @@ void signal_handler(int signum) {
  * Total: ~1-2 microseconds tick-to-trade
  */
 
+/**
+ * This deployment's feed: batched socket receive, native wire format
+ * (ITCH / SBE venues: BasicFeedHandler<..., ItchProtocol / SbeProtocol>)
+ */
+using DeployedFeedHandler = BasicFeedHandler<RecvmmsgReceiver, NativeProtocol>;
+
 /**
  * Main function - sets up the tick-to-trade pipeline
  */
@@ -71,11 +92,48 @@ int main(int argc, char* argv[]) {
     const int FEED_HANDLER_CORE = 0;
     const int TRADING_ENGINE_CORE = 1;
     const bool USE_HUGE_PAGES = false;  // Set to true if huge pages configured
+    const bool USE_HUGE_TEXT = true;    // Remap .text onto 2MB pages (fails soft)
+    const uint64_t JITTER_PROBE_MS = 250;       // Per core, at startup
+    const uint64_t JITTER_THRESHOLD_NS = 5000;  // Gaps above this count as jitter
+    const uint64_t IDLE_WARM_INTERVAL_US = 50;  // Dummy strategy pass after this long idle (0 = off)
+    const uint64_t WATCHDOG_STALL_US = 5000;    // Hot thread silent this long = alert + stack
+    const int HOUSEKEEPING_CORE = -1;           // Watchdog / housekeeping core (-1 = any non-isolated core)
+    const size_t NBBO_SYMBOLS = 16384;          // Consolidated book capacity (symbol ids)
+    const char* BROADCAST_SHM = "/hft_md";      // Fan-out ring for md_subscriber processes (nullptr = off)
+    const std::vector<uint32_t> SUBSCRIBED_SYMBOLS = {};   // Symbol ids past decode (empty = every symbol)
+    const uint32_t SUBSCRIPTION_CAPACITY = 65536;          // Highest symbol id + 1 the filter can subscribe
+    
+    // iTLB: hot path code on 2MB pages - before any other thread starts
+    if (USE_HUGE_TEXT) {
+        HugePages::remap_text();
+    }
     
     // Initialize logger
     Logger::initialize("hft_system.log", LogLevel::INFO);
     LOG_INFO("=== HFT System Starting ===");
     
+    // Validate the cores before trusting them with the hot path:
+    // kernel isolation settings + a short spin to catch IRQ/tick noise
+    std::cout << "[Main] Probing core environment..." << std::endl;
+    const double tsc_ghz = LatencyTracker::calibrate_tsc_ghz();
+    bool environment_ok = true;
+    for (const int core : {FEED_HANDLER_CORE, TRADING_ENGINE_CORE}) {
+        const CoreEnvironment env = CoreEnvironment::check(core);
+        env.print();
+        
+        JitterReport report;
+        if (!JitterProbe::probe_core(core, JITTER_PROBE_MS, JITTER_THRESHOLD_NS, tsc_ghz, report)) {
+            std::cerr << "[Main] Cannot pin to core " << core << std::endl;
+        }
+        report.print();
+        
+        environment_ok = environment_ok && env.ok() && report.pinned && report.gaps_ns.count() == 0;
+    }
+    if (!environment_ok) {
+        std::cout << "[Main] WARNING: cores are not quiet - latency targets may not hold" << std::endl;
+        LOG_WARN("Core environment check failed - see startup jitter report");
+    }
+    
     // Setup signal handler for graceful shutdown
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
@@ -85,8 +143,101 @@ int main(int argc, char* argv[]) {
     FeedHandlerStats stats;
     
     // Create feed handler and trading engine
-    FeedHandler feed_handler(event_queue, stats, FEED_HANDLER_CORE, USE_HUGE_PAGES);
+    DeployedFeedHandler feed_handler(event_queue, stats, FEED_HANDLER_CORE, USE_HUGE_PAGES);
     TradingEngine trading_engine(event_queue, TRADING_ENGINE_CORE);
+    trading_engine.enable_idle_warming(IDLE_WARM_INTERVAL_US);
+    
+    // Exchange -> us latency per channel (test_feed_generator stamps its TSC,
+    // at the scheduled send time in --scenario mode)
+    ClockSkewConfig skew_config;
+    skew_config.exchange_is_local_tsc = true;
+    trading_engine.enable_clock_skew(skew_config);
+    
+    // Consolidated best bid/offer across venues (one venue per feed channel)
+    trading_engine.enable_nbbo(NBBO_SYMBOLS);
+    
+    // Circuit breaker: stop quoting a channel that is late, gapped or backed up
+    FeedHealthConfig health_config;
+    health_config.max_age_ns = 1000000000ULL;   // Generator sends continuously
+    FeedHealth feed_health(health_config);
+    feed_health.watch_clock_skew(trading_engine.clock_skew());
+    feed_health.watch_queue(feed_handler.channel_id(), event_queue);
+    feed_handler.set_feed_health(&feed_health);
+    trading_engine.set_feed_health(&feed_health);
+    
+    // Gap timeouts, stats printing and logging off the feed core
+    Housekeeper housekeeper(HOUSEKEEPING_CORE);
+    feed_handler.attach_housekeeping(housekeeper);
+    
+    // Warm restart: per-symbol books checkpointed to a mapped file; a valid
+    // image resumes the feed at its sequence instead of waiting for a
+    // snapshot cycle. Tagged with the trading date (YYYYMMDD, local) so an
+    // earlier session's file is never resumed from.
+    BookSnapshotConfig snapshot_config;
+    snapshot_config.path = "book_snapshot.bin";
+    {
+        const time_t now = time(nullptr);
+        tm local{};
+        localtime_r(&now, &local);
+        snapshot_config.session = static_cast<uint64_t>((local.tm_year + 1900) * 10000 +
+                                                        (local.tm_mon + 1) * 100 + local.tm_mday);
+    }
+    BookSnapshot* book_snapshot = nullptr;
+    if (trading_engine.enable_book_snapshot(snapshot_config)) {
+        book_snapshot = trading_engine.book_snapshot();
+        if (book_snapshot->restored()) {
+            feed_handler.resume_from(book_snapshot->resume_sequence());
+            std::cout << "[Main] Book snapshot restored in " << book_snapshot->restore_ns() / 1000
+                      << "us - resuming at sequence " << book_snapshot->resume_sequence() << std::endl;
+        } else {
+            std::cout << "[Main] Book snapshot cold start (" << book_snapshot->cold_reason() << ")" << std::endl;
+        }
+        housekeeper.add_task([book_snapshot]() { book_snapshot->maybe_checkpoint(); });
+    } else {
+        std::cerr << "[Main] Book snapshot file unavailable - cold restarts only" << std::endl;
+    }
+    
+    // Local strategy processes read the normalized feed from shared memory
+    // instead of each joining the multicast group and resequencing it
+    BroadcastPublisher broadcast;
+    if (BROADCAST_SHM) {
+        BroadcastConfig broadcast_config;
+        broadcast_config.name = BROADCAST_SHM;
+        if (broadcast.open(broadcast_config)) {
+            feed_handler.set_broadcast(&broadcast);
+            std::cout << "[Main] Broadcasting to shm " << BROADCAST_SHM << std::endl;
+        } else {
+            std::cerr << "[Main] Broadcast ring unavailable - no local fan-out" << std::endl;
+        }
+    }
+    
+    // Drop unsubscribed symbols during decode, before they are normalized
+    // and queued; the set can be swapped while the feed runs (edit/update),
+    // old sets are freed on the housekeeping thread
+    SymbolFilter symbol_filter;
+    if (!SUBSCRIBED_SYMBOLS.empty()) {
+        symbol_filter.edit(SUBSCRIPTION_CAPACITY, [&](SubscriptionSet& set) {
+            for (const uint32_t symbol : SUBSCRIBED_SYMBOLS) {
+                (void)set.subscribe(symbol);
+            }
+        });
+        if (feed_handler.set_symbol_filter(&symbol_filter)) {
+            housekeeper.add_task([&symbol_filter]() { (void)symbol_filter.reclaim(); });
+            symbol_filter.print();
+        }
+    }
+    
+    // Stall watchdog on the hot threads' loop heartbeats
+    WatchdogConfig watchdog_config;
+    watchdog_config.stall_us = WATCHDOG_STALL_US;
+    watchdog_config.core_id = HOUSEKEEPING_CORE;
+    if (!Watchdog::install_stack_capture()) {
+        std::cerr << "[Main] Stack capture handler unavailable - stalls reported without frames" << std::endl;
+        watchdog_config.capture_stack = false;
+    }
+    Watchdog watchdog(watchdog_config);
+    watchdog.watch(feed_handler.heartbeat());
+    watchdog.watch(trading_engine.heartbeat());
     
     // Initialize UDP receiver
     std::cout << "[Main] Initializing UDP receiver..." << std::endl;
@@ -104,10 +255,33 @@ int main(int argc, char* argv[]) {
     LOG_INFO(msg);
     std::cout << "[Main] " << msg << std::endl;
     
-    // Launch threads
-    // In production: consider using std::jthread or manual pthread for more control
-    std::thread feed_thread([&]() { feed_handler.run(); });
-    std::thread trading_thread([&]() { trading_engine.run(); });
+    // Warmup phase: lock + prefault all hot memory, then the feed thread
+    // pushes synthetic traffic through the pipeline (orders suppressed)
+    // until latency stabilizes and flips the system LIVE
+    begin_warmup(1);
+    Prefault::lock_all_memory();
+    feed_handler.prefault();
+    
+    // Launch threads - stacks on huge pages (default pthread stack if unavailable)
+    HugePageThread feed_thread;
+    HugePageThread trading_thread;
+    if (!feed_thread.start([&]() { feed_handler.run(); }) ||
+        !trading_thread.start([&]() { trading_engine.run(); })) {
+        std::cerr << "[Main] Failed to start pipeline threads" << std::endl;
+        g_running.store(false, std::memory_order_release);
+    }
+    // Health thread stays off the hot cores - sleeps between passes
+    std::thread health_thread([&]() { feed_health.run(); });
+    std::thread watchdog_thread([&]() { watchdog.run(); });
+    std::thread housekeeping_thread([&]() { housekeeper.run(); });
+    std::cout << "[Main] Hot thread stacks: "
+              << (!feed_thread.huge_stack() ? "default" : feed_thread.stack().hugetlb() ? "hugetlb" : "THP")
+              << std::endl;
+    
+    std::cout << "[Main] Warming up..." << std::endl;
+    while (!is_live() && g_running.load(std::memory_order_acquire)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
     
     std::cout << "[Main] System running. Press Ctrl+C to stop." << std::endl;
     std::cout << "\n[Main] Key optimizations implemented:" << std::endl;
@@ -116,6 +290,7 @@ int main(int argc, char* argv[]) {
     std::cout << "  ✓ CPU affinity pinning" << std::endl;
     std::cout << "  ✓ RDTSC for nanosecond timing" << std::endl;
     std::cout << "  ✓ Busy polling (no blocking)" << std::endl;
+    std::cout << "  ✓ recvmmsg batch receive, protocol compiled into the feed loop" << std::endl;
     std::cout << "  ✓ Memory ordering optimization" << std::endl;
     std::cout << "\n[Main] Industry-standard reliability features:" << std::endl;
     std::cout << "  ✓ Sequence gap detection and recovery" << std::endl;
@@ -126,6 +301,17 @@ int main(int argc, char* argv[]) {
     std::cout << "  ✓ Gap fill request generation (with retry logic)" << std::endl;
     std::cout << "  ✓ Recovery feed manager integration points" << std::endl;
     std::cout << "  ✓ Lock-free memory pool (8K slots)" << std::endl;
+    std::cout << "  ✓ mlockall + prefault, synthetic warmup before LIVE" << std::endl;
+    std::cout << "  ✓ Idle-time strategy warming (no-send dummy events)" << std::endl;
+    std::cout << "  ✓ Huge-page text and hot thread stacks (iTLB)" << std::endl;
+    std::cout << "  ✓ Exchange clock skew tracking, per-channel one-way latency" << std::endl;
+    std::cout << "  ✓ Feed health circuit breaker (latency / age / queue / gap)" << std::endl;
+    std::cout << "  ✓ Hot-thread stall watchdog with stack capture" << std::endl;
+    std::cout << "  ✓ Maintenance and stats on a housekeeping thread (flags + SPSC handoff)" << std::endl;
+    std::cout << "  ✓ Book snapshot checkpoints (mmap A/B images) for warm restart" << std::endl;
+    std::cout << "  ✓ Consolidated NBBO (sorted venue arrays + best-level bitmasks)" << std::endl;
+    std::cout << "  ✓ Shared-memory broadcast ring for local subscribers" << std::endl;
+    std::cout << "  ✓ Symbol subscription filter in the decoder (RCU swap)" << std::endl;
     std::cout << "  ✓ Async logger (64K message queue)" << std::endl;
     std::cout << "\n[Main] Production enhancements to consider:" << std::endl;
     std::cout << "  • Solarflare/DPDK for true kernel bypass" << std::endl;
@@ -141,6 +327,22 @@ int main(int argc, char* argv[]) {
     // Wait for shutdown signal
     feed_thread.join();
     trading_thread.join();
+    health_thread.join();
+    watchdog_thread.join();
+    housekeeping_thread.join();
+    feed_health.print();
+    watchdog.print();
+    if (book_snapshot) {
+        book_snapshot->checkpoint();    // Engine stopped - final image is exact
+        book_snapshot->print();
+    }
+    if (!SUBSCRIBED_SYMBOLS.empty()) {
+        feed_handler.protocol().print("FeedHandler");
+        symbol_filter.print();
+    }
+    if (broadcast.is_open()) {
+        std::cout << "[Main] Broadcast: " << broadcast.published() << " events published" << std::endl;
+    }
     
     std::cout << "[Main] Shutdown complete" << std::endl;
     LOG_INFO("=== HFT System Shutdown Complete ===");
@@ -0,0 +1,455 @@
+#pragma once
+
+#include "types.hpp"
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <vector>
+
+namespace hft {
+
+/**
+ * Fast PRNG for simulation - xorshift64*
+ * A few cycles per draw (std::mt19937 is ~10x slower and 5KB of state)
+ */
+class FastRng {
+private:
+    uint64_t state_;
+
+public:
+    explicit FastRng(uint64_t seed) noexcept : state_(seed | 1) {}
+
+    uint64_t next() noexcept {
+        state_ ^= state_ >> 12;
+        state_ ^= state_ << 25;
+        state_ ^= state_ >> 27;
+        return state_ * 0x2545F4914F6CDD1DULL;
+    }
+
+    // Uniform in (0, 1] - safe for log()
+    double uniform() noexcept {
+        return (static_cast<double>(next() >> 11) + 1.0) * (1.0 / 9007199254740992.0);
+    }
+
+    uint32_t below(uint32_t n) noexcept {
+        return static_cast<uint32_t>((static_cast<unsigned __int128>(next()) * n) >> 64);
+    }
+};
+
+/**
+ * Zipf sampler using Vose's alias method
+ * O(1) per draw: one random index + one compare (no CDF binary search)
+ *
+ * Real feeds: a few hundred names produce most of the traffic,
+ * thousands of names barely print. Exponent ~1.0-1.2 matches US equities.
+ */
+class ZipfSampler {
+private:
+    std::vector<double> prob_;
+    std::vector<uint32_t> alias_;
+
+public:
+    ZipfSampler(uint32_t n, double exponent) : prob_(n), alias_(n) {
+        std::vector<double> weights(n);
+        double total = 0.0;
+        for (uint32_t i = 0; i < n; ++i) {
+            weights[i] = 1.0 / std::pow(static_cast<double>(i + 1), exponent);
+            total += weights[i];
+        }
+
+        // Scale to mean 1.0 and split into small/large work lists
+        std::vector<uint32_t> small, large;
+        for (uint32_t i = 0; i < n; ++i) {
+            weights[i] = weights[i] * n / total;
+            (weights[i] < 1.0 ? small : large).push_back(i);
+        }
+
+        while (!small.empty() && !large.empty()) {
+            const uint32_t s = small.back(); small.pop_back();
+            const uint32_t l = large.back(); large.pop_back();
+            prob_[s] = weights[s];
+            alias_[s] = l;
+            weights[l] = (weights[l] + weights[s]) - 1.0;
+            (weights[l] < 1.0 ? small : large).push_back(l);
+        }
+        for (uint32_t i : large) { prob_[i] = 1.0; alias_[i] = i; }
+        for (uint32_t i : small) { prob_[i] = 1.0; alias_[i] = i; }
+    }
+
+    uint32_t sample(FastRng& rng) noexcept {
+        const uint32_t i = rng.below(static_cast<uint32_t>(prob_.size()));
+        return rng.uniform() <= prob_[i] ? i : alias_[i];
+    }
+};
+
+/**
+ * Scenario parameters
+ */
+struct ScenarioConfig {
+    uint32_t num_symbols{5000};
+    double   zipf_exponent{1.1};
+
+    // Arrival process: Hawkes with exponential kernel
+    // lambda(t) = mu(t) + sum_i alpha * exp(-beta * (t - t_i))
+    // Mean rate = mean(mu(t)) / (1 - alpha/beta), alpha/beta < 1 for stability
+    double   mean_rate{100000.0};       // Target session-average messages/sec (auction spikes included)
+    double   branching_ratio{0.7};      // alpha / beta - burstiness
+    double   decay_per_sec{2000.0};     // beta - bursts last ~1/beta seconds
+    double   same_symbol_prob{0.6};     // Excited events hit the same name
+
+    // Session shape: auction spikes decay away from open / build into close
+    double   session_seconds{60.0};     // Compressed trading day
+    double   auction_spike{8.0};        // Peak multiplier on baseline intensity
+    double   auction_width_fraction{0.03};
+
+    // Message mix in continuous trading (remainder = adds)
+    double   cancel_fraction{0.35};
+    double   modify_fraction{0.10};
+    double   trade_fraction{0.05};
+    double   quote_fraction{0.08};
+    double   auction_trade_fraction{0.30};  // Prints dominate at the uncross
+
+    uint64_t base_price{1500000};       // $150.0000 in 1/10000 units
+    uint32_t tick_size{100};            // $0.01
+
+    // Message timestamp = epoch_ns + simulated ns * ts_per_ns: wall clock
+    // at start with 1.0, or the TSC at start with the TSC GHz - what the
+    // engine expects from a local generator (exchange_is_local_tsc)
+    uint64_t epoch_ns{0};
+    double   ts_per_ns{1.0};
+
+    /**
+     * Usable by MarketScenario: at least one symbol, a positive rate and
+     * session, a stable (subcritical) Hawkes process
+     */
+    [[nodiscard]] bool valid() const noexcept {
+        return num_symbols > 0 && mean_rate > 0.0 && session_seconds > 0.0 &&
+               decay_per_sec > 0.0 && branching_ratio >= 0.0 && branching_ratio < 1.0;
+    }
+};
+
+/**
+ * Per-scenario counters
+ */
+struct ScenarioStats {
+    uint64_t adds{0};
+    uint64_t cancels{0};
+    uint64_t modifies{0};
+    uint64_t trades{0};
+    uint64_t quotes{0};
+    uint64_t excited_events{0};
+};
+
+/**
+ * Market Microstructure Scenario Engine
+ *
+ * Generates a multi-symbol order-by-order stream with the statistical
+ * shape of a real feed, so latency benchmarks see realistic cache
+ * footprints (thousands of books) and branch patterns (mixed types):
+ *
+ * - Symbol activity: Zipf distributed (alias sampler)
+ * - Arrivals: Hawkes self-exciting process (Ogata thinning) - bursts
+ *   cluster in time and on the same symbol
+ * - Session shape: opening/closing auction intensity spikes
+ * - Per-symbol book process: resting orders, cancels/modifies of live
+ *   orders, trades at the touch moving a random-walk mid price
+ *
+ * Timestamps are simulated exchange time (ns since the first session
+ * started); runs longer than one session wrap into the next "day".
+ */
+class MarketScenario {
+private:
+    static constexpr uint32_t MAX_LIVE_ORDERS = 16;  // Per-symbol resting orders tracked
+
+    struct LiveOrder {
+        uint64_t order_id;
+        uint64_t price;
+        uint32_t quantity;
+        uint8_t  side;
+    };
+
+    struct SymbolState {
+        uint64_t mid_price;
+        uint32_t live_count;
+        LiveOrder live[MAX_LIVE_ORDERS];
+    };
+
+    ScenarioConfig cfg_;
+    FastRng rng_;
+    ZipfSampler zipf_;
+    std::vector<SymbolState> symbols_;
+    ScenarioStats stats_;
+
+    // Hawkes state
+    double mu_;                 // Baseline intensity between auctions (events/sec)
+    double alpha_;              // Jump size per event
+    double beta_;               // Decay rate
+    double excitation_{0.0};    // Sum of decayed kernels at time t_
+    double t_{0.0};             // Simulated seconds since session start
+    uint64_t sessions_{0};      // Completed sessions (timestamps keep increasing)
+    double session_length_;
+    double auction_width_;
+
+    uint32_t last_symbol_{0};
+    uint64_t next_order_id_{1};
+
+public:
+    /**
+     * @param cfg Must be valid() - callers check before constructing
+     */
+    explicit MarketScenario(const ScenarioConfig& cfg = ScenarioConfig{}, uint64_t seed = 42)
+        : cfg_(cfg)
+        , rng_(seed)
+        , zipf_(cfg.num_symbols, cfg.zipf_exponent)
+        , symbols_(cfg.num_symbols)
+        , mu_(cfg.mean_rate * (1.0 - cfg.branching_ratio) / mean_spike_factor(cfg))
+        , alpha_(cfg.branching_ratio * cfg.decay_per_sec)
+        , beta_(cfg.decay_per_sec)
+        , session_length_(cfg.session_seconds)
+        , auction_width_(cfg.session_seconds * cfg.auction_width_fraction) {
+
+        // Spread symbols over a price range so books don't all look alike
+        for (uint32_t i = 0; i < cfg_.num_symbols; ++i) {
+            symbols_[i].mid_price = cfg_.base_price / 4 +
+                static_cast<uint64_t>(rng_.below(8 * static_cast<uint32_t>(cfg_.base_price / cfg_.tick_size))) * cfg_.tick_size / 4;
+            symbols_[i].live_count = 0;
+        }
+    }
+
+    /**
+     * Timestamp clock: simulated time 0 stamps epoch, one simulated ns adds
+     * ts_per_ns (the TSC GHz to stamp the TSC at each scheduled send)
+     */
+    void set_clock(uint64_t epoch, double ts_per_ns) noexcept {
+        cfg_.epoch_ns = epoch;
+        cfg_.ts_per_ns = ts_per_ns;
+    }
+
+    /**
+     * Simulate the next event and encode it into packet
+     *
+     * @param packet Output packet (fully overwritten)
+     * @param seq Packet sequence number to stamp
+     * @return Simulated exchange time in ns since scenario start
+     */
+    uint64_t next(MarketDataPacket& packet, uint64_t seq) noexcept {
+        const bool excited = advance_clock();
+        const double sim = (sessions_ * session_length_ + t_) * 1e9;
+        const uint64_t sim_ns = static_cast<uint64_t>(sim);
+        const uint64_t ts_ns = cfg_.epoch_ns + static_cast<uint64_t>(sim * cfg_.ts_per_ns);
+
+        // Excited arrivals cluster on the name that triggered them
+        uint32_t sym;
+        if (excited && rng_.uniform() < cfg_.same_symbol_prob) {
+            sym = last_symbol_;
+            stats_.excited_events++;
+        } else {
+            sym = zipf_.sample(rng_);
+        }
+        last_symbol_ = sym;
+
+        std::memset(&packet, 0, sizeof(packet));
+        packet.version = 1;
+        packet.packet_sequence = seq;
+
+        SymbolState& s = symbols_[sym];
+        const double trade_frac = in_auction() ? cfg_.auction_trade_fraction : cfg_.trade_fraction;
+        const double u = rng_.uniform();
+
+        if (u < trade_frac) {
+            encode_trade(packet, s, sym, seq, ts_ns);
+        } else if (u < trade_frac + cfg_.quote_fraction) {
+            encode_quote(packet, s, sym, seq, ts_ns);
+        } else if (u < trade_frac + cfg_.quote_fraction + cfg_.cancel_fraction && s.live_count > 0) {
+            encode_cancel(packet, s, sym, seq, ts_ns);
+        } else if (u < trade_frac + cfg_.quote_fraction + cfg_.cancel_fraction + cfg_.modify_fraction &&
+                   s.live_count > 0) {
+            encode_modify(packet, s, sym, seq, ts_ns);
+        } else {
+            encode_add(packet, s, sym, seq, ts_ns);
+        }
+
+        return sim_ns;
+    }
+
+    /**
+     * Current intensity (events/sec) - for reporting
+     */
+    [[nodiscard]] double intensity() const noexcept {
+        return baseline(t_) + excitation_;
+    }
+
+    [[nodiscard]] double session_time() const noexcept { return t_; }
+    [[nodiscard]] const ScenarioStats& stats() const noexcept { return stats_; }
+    [[nodiscard]] const ScenarioConfig& config() const noexcept { return cfg_; }
+
+private:
+    /**
+     * Session average of baseline(t) / mu: 1 + spike * (2w/L) * (1 - e^(-L/w))
+     * for auction width w and session length L - dividing mu by it keeps
+     * the realized rate at mean_rate with the spikes on top
+     */
+    static double mean_spike_factor(const ScenarioConfig& cfg) noexcept {
+        const double width = cfg.session_seconds * cfg.auction_width_fraction;
+        if (width <= 0.0 || cfg.session_seconds <= 0.0) {
+            return 1.0;
+        }
+        return 1.0 + cfg.auction_spike * (2.0 * width / cfg.session_seconds) *
+                     (1.0 - std::exp(-cfg.session_seconds / width));
+    }
+
+    /**
+     * Baseline intensity with auction spikes at open and close
+     * Session wraps around so long runs replay multiple "days"
+     */
+    double baseline(double t) const noexcept {
+        const double open_term = std::exp(-t / auction_width_);
+        const double close_term = std::exp(-(session_length_ - t) / auction_width_);
+        return mu_ * (1.0 + cfg_.auction_spike * (open_term + close_term));
+    }
+
+    bool in_auction() const noexcept {
+        return t_ < auction_width_ || t_ > session_length_ - auction_width_;
+    }
+
+    /**
+     * Ogata thinning for a Hawkes process with time-varying baseline
+     *
+     * The bound must dominate lambda over the candidate step. Excitation only
+     * decays and the baseline is monotone on each half-session, so we bound
+     * over a short horizon and re-draw if the candidate falls past it.
+     *
+     * @return true if accepted event was "excited" (kernel dominated)
+     */
+    bool advance_clock() noexcept {
+        const double horizon = auction_width_ * 0.1;
+
+        while (true) {
+            const double t_end = std::min(t_ + horizon, session_length_);
+            const double bound = std::max(baseline(t_), baseline(t_end)) + excitation_;
+            const double w = -std::log(rng_.uniform()) / bound;
+
+            if (t_ + w > t_end) {
+                // No event inside the horizon - move to its end and re-bound
+                excitation_ *= std::exp(-beta_ * (t_end - t_));
+                t_ = t_end;
+                if (t_ >= session_length_) {
+                    t_ = 0.0;  // Next session
+                    sessions_++;
+                }
+                continue;
+            }
+
+            excitation_ *= std::exp(-beta_ * w);
+            t_ += w;
+
+            const double base = baseline(t_);
+            const double lambda = base + excitation_;
+            if (rng_.uniform() * bound <= lambda) {
+                const bool excited = rng_.uniform() * lambda > base;
+                excitation_ += alpha_;
+                return excited;
+            }
+        }
+    }
+
+    static void fill_order(MarketDataPacket& packet, MessageType type, uint32_t sym,
+                           uint64_t seq, uint64_t ts_ns, const LiveOrder& o) noexcept {
+        packet.msg_type = type;
+        packet.payload_size = sizeof(OrderMessage);
+        auto& msg = packet.payload.order;
+        msg.timestamp_ns = ts_ns;
+        msg.sequence_num = seq;
+        msg.symbol_id = sym;
+        msg.order_id = o.order_id;
+        msg.price = o.price;
+        msg.quantity = o.quantity;
+        msg.side = o.side;
+    }
+
+    void encode_add(MarketDataPacket& packet, SymbolState& s, uint32_t sym,
+                    uint64_t seq, uint64_t ts_ns) noexcept {
+        // Passive order 1-5 ticks from mid, round-lot sizes
+        const uint8_t side = (rng_.next() & 1) ? 'B' : 'S';
+        const uint64_t offset = (1 + rng_.below(5)) * cfg_.tick_size;
+        const uint64_t price = side == 'B' ? s.mid_price - offset : s.mid_price + offset;
+
+        LiveOrder o{next_order_id_++, price, 100u * (1 + rng_.below(10)), side};
+        if (s.live_count < MAX_LIVE_ORDERS) {
+            s.live[s.live_count++] = o;
+        } else {
+            s.live[rng_.below(MAX_LIVE_ORDERS)] = o;  // Forget one - it rests forever
+        }
+
+        fill_order(packet, MessageType::ORDER_ADD, sym, seq, ts_ns, o);
+        stats_.adds++;
+    }
+
+    void encode_cancel(MarketDataPacket& packet, SymbolState& s, uint32_t sym,
+                       uint64_t seq, uint64_t ts_ns) noexcept {
+        const uint32_t idx = rng_.below(s.live_count);
+        LiveOrder o = s.live[idx];
+        s.live[idx] = s.live[--s.live_count];
+
+        o.quantity = 0;
+        fill_order(packet, MessageType::ORDER_DELETE, sym, seq, ts_ns, o);
+        stats_.cancels++;
+    }
+
+    void encode_modify(MarketDataPacket& packet, SymbolState& s, uint32_t sym,
+                       uint64_t seq, uint64_t ts_ns) noexcept {
+        LiveOrder& o = s.live[rng_.below(s.live_count)];
+        o.quantity = 100u * (1 + rng_.below(10));
+
+        fill_order(packet, MessageType::ORDER_MODIFY, sym, seq, ts_ns, o);
+        stats_.modifies++;
+    }
+
+    void encode_trade(MarketDataPacket& packet, SymbolState& s, uint32_t sym,
+                      uint64_t seq, uint64_t ts_ns) noexcept {
+        // Aggressor lifts/hits the touch, mid drifts one tick in that direction
+        const uint8_t side = (rng_.next() & 1) ? 'B' : 'S';
+        const uint64_t half_spread = cfg_.tick_size;
+        const uint64_t price = side == 'B' ? s.mid_price + half_spread : s.mid_price - half_spread;
+
+        if (rng_.below(4) == 0) {
+            if (side == 'B') {
+                s.mid_price += cfg_.tick_size;
+            } else if (s.mid_price > 10 * cfg_.tick_size) {
+                s.mid_price -= cfg_.tick_size;
+            }
+        }
+
+        packet.msg_type = MessageType::TRADE;
+        packet.payload_size = sizeof(TradeMessage);
+        auto& trade = packet.payload.trade;
+        trade.timestamp_ns = ts_ns;
+        trade.sequence_num = seq;
+        trade.symbol_id = sym;
+        trade.trade_id = static_cast<uint32_t>(seq);
+        trade.price = price;
+        trade.quantity = 100u * (1 + rng_.below(20));
+        trade.side = side;
+        stats_.trades++;
+    }
+
+    void encode_quote(MarketDataPacket& packet, SymbolState& s, uint32_t sym,
+                      uint64_t seq, uint64_t ts_ns) noexcept {
+        const uint64_t half_spread = cfg_.tick_size * (1 + rng_.below(3));
+
+        packet.msg_type = MessageType::QUOTE;
+        packet.payload_size = sizeof(QuoteMessage);
+        auto& quote = packet.payload.quote;
+        quote.timestamp_ns = ts_ns;
+        quote.sequence_num = seq;
+        quote.symbol_id = sym;
+        quote.bid_price = s.mid_price - half_spread;
+        quote.ask_price = s.mid_price + half_spread;
+        quote.bid_size = 100u * (1 + rng_.below(50));
+        quote.ask_size = 100u * (1 + rng_.below(50));
+        quote.num_levels = 1;
+        stats_.quotes++;
+    }
+};
+
+} // namespace hft
@@ -0,0 +1,363 @@
+#pragma once
+
+#include "types.hpp"
+#include "utils.hpp"
+#include "packet_manager.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace hft {
+
+/**
+ * Market Data Broadcast Ring (shared memory, one writer, any readers)
+ *
+ * Fan-out of normalized MarketEvents to strategy processes on the same
+ * host: the feed handler sequences and decodes once and publishes here;
+ * subscribers map the segment read-only and keep their own cursor, so they
+ * never write a shared line and never slow the publisher or each other.
+ *
+ * Each slot is a seqlock tagged with its ring position n - version
+ * 2n+1 while being written, 2n+2 once complete. A reader at cursor c
+ * expects 2c+2:
+ *   smaller  not published yet (or in progress)
+ *   equal    copy, re-check the version, advance
+ *   larger   the writer has lapped this reader - events were lost
+ * The publisher never waits: a subscriber that falls a full ring behind
+ * jumps to the head and counts the skipped events (treat like a feed gap).
+ *
+ * Slot = version line + event line (128B); the adjacent-line prefetcher
+ * usually brings both in with one miss. Per-channel feed state
+ * (PacketManager) is mirrored in the header on transitions, so subscribers
+ * see RECOVERING / STALE without running their own sequencing.
+ *
+ * A restarted publisher unlinks and recreates the segment - readers of the
+ * old one are not torn out from under (no SIGBUS) and notice the new one
+ * through publisher_changed().
+ */
+struct BroadcastConfig {
+    std::string name{"/hft_md"};    // POSIX shm name (/dev/shm/hft_md)
+    size_t capacity{65536};         // Slots, power of two
+};
+
+namespace detail {
+
+struct BroadcastHeader {
+    static constexpr uint64_t MAGIC = 0x3143425F4D544648ULL;  // "HFTM_BC1"
+    static constexpr uint32_t FORMAT_VERSION = 1;
+    static constexpr size_t MAX_CHANNELS = 16;
+
+    // Written once by the publisher before magic
+    std::atomic<uint64_t> magic;
+    uint32_t format;
+    uint32_t slot_size;
+    uint64_t capacity;
+    uint64_t created_ns;
+    int32_t publisher_pid;
+    std::atomic<uint32_t> closed;   // Clean publisher shutdown
+
+    // Next position to publish - for lag / resync only, never polled per event
+    alignas(64) std::atomic<uint64_t> head;
+
+    // Written on feed state transitions only
+    alignas(64) std::atomic<uint8_t> feed_state[MAX_CHANNELS];
+};
+
+struct alignas(64) BroadcastSlot {
+    std::atomic<uint64_t> version;
+    MarketEvent event;
+};
+
+static_assert(sizeof(BroadcastSlot) == 128, "version line + event line");
+
+inline constexpr size_t BROADCAST_DATA_OFFSET = 4096;
+
+inline size_t broadcast_segment_size(size_t capacity) noexcept {
+    return BROADCAST_DATA_OFFSET + capacity * sizeof(BroadcastSlot);
+}
+
+} // namespace detail
+
+/**
+ * Publisher - the feed thread (one per segment)
+ */
+class BroadcastPublisher {
+private:
+    using Header = detail::BroadcastHeader;
+    using Slot = detail::BroadcastSlot;
+
+    BroadcastConfig cfg_;
+    void* map_{nullptr};
+    size_t map_size_{0};
+    Header* header_{nullptr};
+    Slot* slots_{nullptr};
+    size_t mask_{0};
+    uint64_t head_{0};              // Publisher-local copy
+
+public:
+    BroadcastPublisher() = default;
+    ~BroadcastPublisher() { close(); }
+
+    BroadcastPublisher(const BroadcastPublisher&) = delete;
+    BroadcastPublisher& operator=(const BroadcastPublisher&) = delete;
+
+    /**
+     * Create (replacing any previous segment) and map the ring
+     */
+    bool open(const BroadcastConfig& cfg = BroadcastConfig{}) {
+        if (cfg.capacity == 0 || (cfg.capacity & (cfg.capacity - 1)) != 0) {
+            std::cerr << "[Broadcast] Capacity must be a power of two" << std::endl;
+            return false;
+        }
+        cfg_ = cfg;
+        map_size_ = detail::broadcast_segment_size(cfg.capacity);
+
+        // Fresh segment: old subscribers keep their mapping of the old one
+        (void)shm_unlink(cfg.name.c_str());
+        const int fd = shm_open(cfg.name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0) {
+            std::cerr << "[Broadcast] shm_open " << cfg.name << " failed: " << strerror(errno) << std::endl;
+            return false;
+        }
+        if (ftruncate(fd, static_cast<off_t>(map_size_)) != 0) {
+            std::cerr << "[Broadcast] ftruncate failed: " << strerror(errno) << std::endl;
+            ::close(fd);
+            (void)shm_unlink(cfg.name.c_str());
+            return false;
+        }
+        void* p = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            std::cerr << "[Broadcast] mmap failed: " << strerror(errno) << std::endl;
+            (void)shm_unlink(cfg.name.c_str());
+            return false;
+        }
+
+        map_ = p;
+        header_ = static_cast<Header*>(p);
+        slots_ = reinterpret_cast<Slot*>(static_cast<uint8_t*>(p) + detail::BROADCAST_DATA_OFFSET);
+        mask_ = cfg.capacity - 1;
+        head_ = 0;
+
+        // New segment is zero-filled: every slot version 0, head 0, INITIAL
+        header_->format = Header::FORMAT_VERSION;
+        header_->slot_size = sizeof(Slot);
+        header_->capacity = cfg.capacity;
+        header_->created_ns = static_cast<uint64_t>(
+            std::chrono::system_clock::now().time_since_epoch().count());
+        header_->publisher_pid = static_cast<int32_t>(getpid());
+        header_->magic.store(Header::MAGIC, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Mark the segment closed and unmap - attached subscribers drain what
+     * was published, new ones wait for the next publisher
+     */
+    void close() noexcept {
+        if (map_) {
+            header_->closed.store(1, std::memory_order_release);
+            munmap(map_, map_size_);
+            map_ = nullptr;
+            header_ = nullptr;
+            slots_ = nullptr;
+        }
+    }
+
+    /**
+     * Hot path: one slot write, never blocks
+     * On x86 the fences are compiler-only - three plain stores and a copy.
+     */
+    inline void publish(const MarketEvent& event) noexcept {
+        Slot& slot = slots_[head_ & mask_];
+        slot.version.store(2 * head_ + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.event = event;
+        slot.version.store(2 * head_ + 2, std::memory_order_release);
+        header_->head.store(++head_, std::memory_order_release);
+    }
+
+    /**
+     * Feed thread, on a PacketManager state change
+     */
+    void set_feed_state(uint8_t channel_id, FeedState state) noexcept {
+        header_->feed_state[channel_id & (Header::MAX_CHANNELS - 1)].store(
+            static_cast<uint8_t>(state), std::memory_order_release);
+    }
+
+    [[nodiscard]] bool is_open() const noexcept { return map_ != nullptr; }
+    [[nodiscard]] uint64_t published() const noexcept { return head_; }
+    [[nodiscard]] const std::string& name() const noexcept { return cfg_.name; }
+};
+
+/**
+ * Subscriber - any process, read-only mapping, private cursor
+ */
+class BroadcastSubscriber {
+private:
+    using Header = detail::BroadcastHeader;
+    using Slot = detail::BroadcastSlot;
+
+    std::string name_;
+    const void* map_{nullptr};
+    size_t map_size_{0};
+    const Header* header_{nullptr};
+    const Slot* slots_{nullptr};
+    size_t mask_{0};
+    ino_t inode_{0};
+
+    uint64_t cursor_{0};
+    uint64_t received_{0};
+    uint64_t lost_{0};
+    uint64_t overruns_{0};
+
+public:
+    BroadcastSubscriber() = default;
+    ~BroadcastSubscriber() { detach(); }
+
+    BroadcastSubscriber(const BroadcastSubscriber&) = delete;
+    BroadcastSubscriber& operator=(const BroadcastSubscriber&) = delete;
+
+    /**
+     * Map the publisher's segment read-only and start at its head
+     * @return false if absent, closed or not (yet) a valid ring
+     */
+    bool attach(const std::string& name) {
+        detach();
+        name_ = name;
+        const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < detail::BROADCAST_DATA_OFFSET) {
+            ::close(fd);
+            return false;
+        }
+        void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED | MAP_POPULATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            return false;
+        }
+        map_ = p;
+        map_size_ = static_cast<size_t>(st.st_size);
+        inode_ = st.st_ino;
+        header_ = static_cast<const Header*>(p);
+
+        if (header_->magic.load(std::memory_order_acquire) != Header::MAGIC ||
+            header_->closed.load(std::memory_order_acquire) != 0 ||
+            header_->format != Header::FORMAT_VERSION ||
+            header_->slot_size != sizeof(Slot) ||
+            header_->capacity == 0 || (header_->capacity & (header_->capacity - 1)) != 0 ||
+            detail::broadcast_segment_size(header_->capacity) > map_size_) {
+            detach();
+            return false;
+        }
+        slots_ = reinterpret_cast<const Slot*>(static_cast<const uint8_t*>(p) + detail::BROADCAST_DATA_OFFSET);
+        mask_ = header_->capacity - 1;
+        cursor_ = header_->head.load(std::memory_order_acquire);
+        received_ = 0;
+        lost_ = 0;
+        overruns_ = 0;
+        return true;
+    }
+
+    void detach() noexcept {
+        if (map_) {
+            munmap(const_cast<void*>(map_), map_size_);
+            map_ = nullptr;
+            header_ = nullptr;
+            slots_ = nullptr;
+        }
+    }
+
+    /**
+     * Hot path: next event, if published
+     * Reads only the slot's two lines - nothing the publisher writes
+     * elsewhere, nothing any other reader touches.
+     */
+    [[nodiscard]] inline bool try_read(MarketEvent& out) noexcept {
+        const Slot& slot = slots_[cursor_ & mask_];
+        const uint64_t want = 2 * cursor_ + 2;
+        if (slot.version.load(std::memory_order_acquire) != want) {
+            if (slot.version.load(std::memory_order_relaxed) > want) [[unlikely]] {
+                overrun();
+            }
+            return false;
+        }
+        out = slot.event;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.version.load(std::memory_order_relaxed) != want) [[unlikely]] {
+            overrun();      // Overwritten while copying
+            return false;
+        }
+        cursor_++;
+        received_++;
+        return true;
+    }
+
+    /**
+     * Slow path: has the publisher restarted (new segment) or shut down?
+     * A syscall - call from an idle or periodic path, then attach() again.
+     */
+    [[nodiscard]] bool publisher_changed() const noexcept {
+        if (!map_) {
+            return true;
+        }
+        if (header_->closed.load(std::memory_order_acquire) != 0) {
+            return true;
+        }
+        const int fd = shm_open(name_.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            return true;
+        }
+        struct stat st{};
+        const bool same = fstat(fd, &st) == 0 && st.st_ino == inode_;
+        ::close(fd);
+        return !same;
+    }
+
+    [[nodiscard]] FeedState feed_state(uint8_t channel_id) const noexcept {
+        return static_cast<FeedState>(
+            header_->feed_state[channel_id & (Header::MAX_CHANNELS - 1)].load(std::memory_order_acquire));
+    }
+
+    /**
+     * Events published but not yet read
+     */
+    [[nodiscard]] uint64_t lag() const noexcept {
+        return header_->head.load(std::memory_order_acquire) - cursor_;
+    }
+
+    [[nodiscard]] bool attached() const noexcept { return map_ != nullptr; }
+    [[nodiscard]] uint64_t cursor() const noexcept { return cursor_; }
+    [[nodiscard]] uint64_t received() const noexcept { return received_; }
+    [[nodiscard]] uint64_t lost() const noexcept { return lost_; }
+    [[nodiscard]] uint64_t overruns() const noexcept { return overruns_; }
+    [[nodiscard]] size_t capacity() const noexcept { return mask_ + 1; }
+    [[nodiscard]] int32_t publisher_pid() const noexcept { return header_ ? header_->publisher_pid : 0; }
+
+private:
+    /**
+     * Lapped: skip to the head; everything in between is gone
+     */
+    [[gnu::noinline]] void overrun() noexcept {
+        const uint64_t head = header_->head.load(std::memory_order_acquire);
+        if (head > cursor_) {
+            lost_ += head - cursor_;
+            cursor_ = head;
+        }
+        overruns_++;
+    }
+};
+
+} // namespace hft
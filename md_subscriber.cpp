@@ -0,0 +1,148 @@
+#include "types.hpp"
+#include "utils.hpp"
+#include "md_broadcast.hpp"
+#include "latency_histogram.hpp"
+#include <signal.h>
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace hft;
+
+namespace hft {
+std::atomic<bool> g_running{true};
+}
+
+static void signal_handler(int) {
+    g_running.store(false, std::memory_order_release);
+}
+
+static const char* feed_state_name(FeedState state) {
+    switch (state) {
+        case FeedState::INITIAL:    return "INITIAL";
+        case FeedState::RECOVERING: return "RECOVERING";
+        case FeedState::LIVE:       return "LIVE";
+        case FeedState::STALE:      return "STALE";
+    }
+    return "UNKNOWN";
+}
+
+/**
+ * Per-second subscriber report
+ */
+struct SubscriberStats {
+    uint64_t trades{0};
+    uint64_t quotes{0};
+    uint64_t other{0};
+    uint64_t last_received{0};
+    LatencyHistogram fanout_ns;     // Feed recv TSC -> read here (same host clock)
+};
+
+/**
+ * MARKET DATA SUBSCRIBER
+ *
+ * Strategy-side end of the feed handler's shared-memory broadcast ring
+ * (tick_to_trade with BROADCAST_SHM set): attaches read-only, busy-polls
+ * its own cursor and reports rate, fan-out latency (feed receive -> read
+ * here), lag behind the publisher, lapped events and the feed state the
+ * publisher mirrors. Any number can run side by side.
+ *
+ * Reattaches on its own when the publisher restarts.
+ *
+ * Usage:
+ *   ./md_subscriber [shm_name=/hft_md] [core=-1] [duration_s=0 (until Ctrl+C)]
+ */
+int main(int argc, char* argv[]) {
+    const std::string name = argc > 1 ? argv[1] : "/hft_md";
+    const int core = argc > 2 ? std::atoi(argv[2]) : -1;
+    const uint64_t duration_s = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 0;
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    if (core >= 0 && !ThreadUtils::pin_to_core(core)) {
+        std::cerr << "[Subscriber] Failed to pin to core " << core << std::endl;
+    }
+    const double tsc_ghz = LatencyTracker::calibrate_tsc_ghz();
+    const uint64_t report_ticks = static_cast<uint64_t>(1e9 * tsc_ghz);
+    const uint64_t start = LatencyTracker::rdtsc();
+    const uint64_t end = duration_s > 0 ? start + duration_s * report_ticks : UINT64_MAX;
+
+    BroadcastSubscriber subscriber;
+    SubscriberStats stats;
+    LatencyHistogram total_ns;
+    uint64_t total_received = 0;
+    uint64_t total_lost = 0;
+    uint64_t attaches = 0;
+    uint64_t next_report = start + report_ticks;
+
+    while (g_running.load(std::memory_order_acquire) && LatencyTracker::rdtsc() < end) {
+        if (!subscriber.attached()) {
+            if (!subscriber.attach(name)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                continue;
+            }
+            attaches++;
+            stats.last_received = 0;
+            std::cout << "[Subscriber] Attached to " << name << " (publisher pid " << subscriber.publisher_pid()
+                      << ", " << subscriber.capacity() << " slots) at position " << subscriber.cursor() << std::endl;
+        }
+
+        MarketEvent event;
+        uint32_t idle = 0;
+        while (idle < 1024) {
+            if (!subscriber.try_read(event)) {
+                idle++;
+                SpinWait::pause();
+                continue;
+            }
+            idle = 0;
+            const uint64_t now = LatencyTracker::rdtsc();
+            stats.fanout_ns.record(LatencyTracker::tsc_to_ns(now - event.recv_timestamp_ns, tsc_ghz));
+            switch (event.type) {
+                case MessageType::TRADE: stats.trades++; break;
+                case MessageType::QUOTE: stats.quotes++; break;
+                default:                 stats.other++; break;
+            }
+        }
+
+        const uint64_t now = LatencyTracker::rdtsc();
+        if (now < next_report) {
+            continue;
+        }
+        next_report = now + report_ticks;
+
+        const uint64_t received = subscriber.received() - stats.last_received;
+        printf("[Subscriber] %lu events/s (%lu trades, %lu quotes, %lu other), fan-out p50 %lu ns p99 %lu ns, "
+               "lag %lu, lost %lu, feed ch0 %s\n",
+               received, stats.trades, stats.quotes, stats.other,
+               stats.fanout_ns.percentile(50.0), stats.fanout_ns.percentile(99.0),
+               subscriber.lag(), subscriber.lost(), feed_state_name(subscriber.feed_state(0)));
+        fflush(stdout);
+        total_ns.merge(stats.fanout_ns);
+        stats = SubscriberStats{};
+        stats.last_received = subscriber.received();
+
+        if (subscriber.publisher_changed()) {
+            std::cout << "[Subscriber] Publisher restarted or closed - reattaching" << std::endl;
+            total_received += subscriber.received();
+            total_lost += subscriber.lost();
+            subscriber.detach();
+        }
+    }
+
+    if (subscriber.attached()) {
+        total_received += subscriber.received();
+        total_lost += subscriber.lost();
+    }
+    std::cout << "[Subscriber] " << total_received << " events, " << total_lost << " lost to overruns, "
+              << attaches << " attaches" << std::endl;
+    if (total_ns.count() > 0) {
+        total_ns.print("Fan-out latency");
+    }
+    return 0;
+}
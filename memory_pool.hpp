@@ -179,6 +179,19 @@ public:
         };
     }
     
+    /**
+     * Fault in and warm every page of the pool
+     * mlock() alone may fail silently (RLIMIT_MEMLOCK) - this guarantees
+     * no first-touch page fault on the hot path. Contents are unchanged;
+     * call before the pool is shared between threads.
+     */
+    void prefault() noexcept {
+        volatile uint8_t* p = memory_block_;
+        for (size_t off = 0; off < total_size_; off += 4096) {
+            p[off] = p[off];
+        }
+    }
+    
     /**
      * Check if pointer belongs to this pool
      */
@@ -0,0 +1,1050 @@
+#include "benchmark.hpp"
+#include "spsc_queue.hpp"
+#include "memory_pool.hpp"
+#include "packet_manager.hpp"
+#include "logger.hpp"
+#include "feed_generator.hpp"
+#include "feed_handler_impl.hpp"
+#include "huge_pages.hpp"
+#include "itch_decoder.hpp"
+#include "sbe_decoder.hpp"
+#include "protocol_schema.hpp"
+#include "clock_skew.hpp"
+#include "feed_health.hpp"
+#include "feed_group.hpp"
+#include "md_broadcast.hpp"
+#include "event_merger.hpp"
+#include "nbbo.hpp"
+#include "symbol_filter.hpp"
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <cstdlib>
+#include <cstring>
+
+using namespace hft;
+
+namespace hft {
+std::atomic<bool> g_running{true};
+}
+
+#ifndef HFT_GIT_COMMIT
+#define HFT_GIT_COMMIT "unknown"
+#endif
+
+/**
+ * Microbenchmark options
+ */
+struct MicrobenchOptions {
+    BenchmarkConfig bench;
+    std::string output{"bench_micro.json"};
+    std::string baseline;
+    std::string filter;
+    bool huge_text{false};
+};
+
+static bool selected(const MicrobenchOptions& opts, const char* name) {
+    return opts.filter.empty() || std::strstr(name, opts.filter.c_str()) != nullptr;
+}
+
+// ============================================================================
+// SPSC QUEUE
+// ============================================================================
+
+/**
+ * Pre-cache-line MarketEvent layout (56 bytes, 8-byte aligned) - kept to
+ * measure the queue against the 64-byte layout (*_legacy56 cases)
+ */
+struct LegacyMarketEvent {
+    uint64_t recv_timestamp_ns;
+    uint64_t exchange_timestamp_ns;
+    uint32_t symbol_id;
+    MessageType type;
+    uint8_t data[32];
+};
+static_assert(sizeof(LegacyMarketEvent) == 56);
+
+template<typename Event>
+static void bench_spsc_layout(BenchmarkRunner& runner, const MicrobenchOptions& opts, const std::string& suffix) {
+    auto queue = std::make_unique<SPSCQueue<Event, 65536>>();
+    Event event{};
+    Event out{};
+
+    const std::string push_pop = "spsc_push_pop" + suffix;
+    if (selected(opts, push_pop.c_str())) {
+        // Same thread: pure instruction cost, both indices stay in L1
+        runner.run(push_pop, [&] {
+            event.recv_timestamp_ns++;
+            const bool pushed = queue->try_push(event);
+            const bool popped = queue->try_pop(out);
+            do_not_optimize(pushed);
+            do_not_optimize(popped);
+            do_not_optimize(out);
+        });
+    }
+
+    const std::string burst = "spsc_burst_256" + suffix;
+    if (selected(opts, burst.c_str())) {
+        // 256 pushes then 256 pops per op: walks the ring, so slot layout
+        // (lines touched per event) shows up as memory traffic
+        runner.run(burst, [&] {
+            for (int i = 0; i < 256; ++i) {
+                event.recv_timestamp_ns++;
+                const bool pushed = queue->try_push(event);
+                do_not_optimize(pushed);
+            }
+            for (int i = 0; i < 256; ++i) {
+                const bool popped = queue->try_pop(out);
+                do_not_optimize(popped);
+            }
+            do_not_optimize(out);
+        });
+    }
+
+    const std::string cross_core = "spsc_cross_core_pop" + suffix;
+    if (selected(opts, cross_core.c_str())) {
+        // Producer on the neighbouring core keeps the queue fed - each pop
+        // pays for the cache line transfer like the trading engine does
+        const int producer_core = opts.bench.core + 1;
+        if (opts.bench.core < 0 ||
+            static_cast<unsigned>(producer_core) >= std::thread::hardware_concurrency()) {
+            std::cout << cross_core << " skipped (needs 2 cores)" << std::endl;
+            return;
+        }
+
+        std::atomic<bool> stop{false};
+        std::thread producer([&] {
+            ThreadUtils::pin_to_core(producer_core);
+            Event e{};
+            while (!stop.load(std::memory_order_relaxed)) {
+                e.recv_timestamp_ns++;
+                while (!queue->try_push(e) && !stop.load(std::memory_order_relaxed)) {
+                    SpinWait::pause();
+                }
+            }
+        });
+
+        runner.run(cross_core, [&] {
+            while (!queue->try_pop(out)) {
+                SpinWait::pause();
+            }
+            do_not_optimize(out);
+        });
+
+        stop.store(true, std::memory_order_relaxed);
+        producer.join();
+    }
+}
+
+static void bench_spsc(BenchmarkRunner& runner, const MicrobenchOptions& opts) {
+    bench_spsc_layout<MarketEvent>(runner, opts, "");
+    bench_spsc_layout<LegacyMarketEvent>(runner, opts, "_legacy56");
+}
+
+// ============================================================================
+// MEMORY POOL
+// ============================================================================
+
+static void bench_memory_pool(BenchmarkRunner& runner, const MicrobenchOptions& opts) {
+    if (!selected(opts, "mempool_alloc_free")) return;
+
+    auto pool = std::make_unique<MemoryPool<MarketEvent, 8192>>();
+    runner.run("mempool_alloc_free", [&] {
+        void* ptr = pool->allocate();
+        do_not_optimize(ptr);
+        pool->deallocate(ptr);
+    });
+}
+
+// ============================================================================
+// PACKET MANAGER
+// ============================================================================
+
+static void bench_packet_manager(BenchmarkRunner& runner, const MicrobenchOptions& opts) {
+    MarketDataPacket packet;
+    fill_trade_packet(packet, 1, 0x12345678);
+    const auto* data = reinterpret_cast<const uint8_t*>(&packet);
+
+    if (selected(opts, "packet_manager_in_sequence")) {
+        // Common case: next expected sequence, dedup window insert + evict
+        auto pm = std::make_unique<PacketManager>();
+        uint64_t seq = 1;
+        runner.run("packet_manager_in_sequence", [&] {
+            const bool accept = pm->process_packet(seq++, data, sizeof(packet), 0);
+            do_not_optimize(accept);
+        });
+    }
+
+    if (selected(opts, "packet_manager_duplicate")) {
+        // A/B arbitration: the losing line's copy hits the dedup set
+        auto pm = std::make_unique<PacketManager>();
+        for (uint64_t seq = 1; seq <= 1024; ++seq) {
+            (void)pm->process_packet(seq, data, sizeof(packet), 0);
+        }
+        uint64_t i = 0;
+        runner.run("packet_manager_duplicate", [&] {
+            const bool accept = pm->process_packet(1 + (i++ & 1023), data, sizeof(packet), 0);
+            do_not_optimize(accept);
+        });
+    }
+}
+
+// ============================================================================
+// ASYNC LOGGER
+// ============================================================================
+
+static void bench_logger(BenchmarkRunner& runner, const MicrobenchOptions& opts) {
+    if (!selected(opts, "async_logger_log")) return;
+
+    // Producer side only - the I/O thread drains to /dev/null. Reps are
+    // capped below the queue capacity and flushed in between so we time the
+    // enqueue path, not the drop path. Heap: the queue is 32MB inline.
+    auto logger = std::make_unique<AsyncLogger>("/dev/null");
+    const BenchmarkConfig saved = runner.config();
+    runner.config().ops_per_rep = 32768;
+    runner.config().warmup_ops = 32768;
+
+    runner.run("async_logger_log",
+               [&] { logger->log(LogLevel::INFO, "Order filled: symbol=12345 px=1500000 qty=100"); },
+               [&] { logger->flush(); });
+
+    runner.config() = saved;
+    const auto stats = logger->get_stats();
+    if (stats.messages_dropped > 0) {
+        std::cerr << "[Bench] async_logger_log dropped " << stats.messages_dropped << " messages" << std::endl;
+    }
+}
+
+// ============================================================================
+// FEED HANDLER PARSE PATH
+// ============================================================================
+
+static void bench_feed_handler(BenchmarkRunner& runner, const MicrobenchOptions& opts) {
+    if (!selected(opts, "feed_handler_trade")) return;
+
+    // Sequencing + parse + normalize + queue push, then pop as the engine
+    auto queue = std::make_unique<SPSCQueue<MarketEvent, 65536>>();
+    auto stats = std::make_unique<FeedHandlerStats>();
+    auto handler = std::make_unique<FeedHandler>(*queue, *stats, opts.bench.core);
+
+    MarketDataPacket packet;
+    fill_trade_packet(packet, 1, 0x12345678);
+    const auto* data = reinterpret_cast<const uint8_t*>(&packet);
+    MarketEvent event{};
+    uint64_t seq = 1;
+
+    runner.run("feed_handler_trade", [&] {
+        packet.packet_sequence = seq++;
+        handler->inject_packet(data, sizeof(packet), LatencyTracker::rdtsc());
+        const bool popped = queue->try_pop(event);
+        do_not_optimize(popped);
+        do_not_optimize(event);
+    });
+
+    if (stats->packets_dropped.load(std::memory_order_relaxed) > 0) {
+        std::cerr << "[Bench] feed_handler_trade dropped packets - queue not drained" << std::endl;
+    }
+}
+
+// ============================================================================
+// ITCH 5.0 DECODE
+// ============================================================================
+
+/**
+ * Typical book-building mix: adds dominate, then deletes/cancels/executes
+ */
+static void build_itch_mix(ItchPacketBuilder& builder, uint64_t sequence) {
+    builder.begin(sequence);
+    for (uint64_t i = 0; i < 4; ++i) {
+        const uint16_t locate = static_cast<uint16_t>(1 + i);
+        const uint64_t ref = 1000 + i * 10;
+        (void)builder.add_order(locate, 34200000000000 + i, ref, 'B', 100, 1500000);
+        (void)builder.add_order(locate, 34200000000001 + i, ref + 1, 'S', 200, 1500100);
+        (void)builder.order_replace(locate, 34200000000002 + i, ref, ref + 2, 300, 1499900);
+        (void)builder.order_cancel(locate, 34200000000003 + i, ref + 2, 100);
+        (void)builder.add_order(locate, 34200000000004 + i, ref + 3, 'B', 100, 1499800);
+        (void)builder.order_executed(locate, 34200000000005 + i, ref + 1, 100, i);
+        (void)builder.order_delete(locate, 34200000000006 + i, ref + 3);
+        (void)builder.trade(locate, 34200000000007 + i, 0, 'B', 500, 1500050, i);
+    }
+}
+
+static void bench_itch(BenchmarkRunner& runner, const MicrobenchOptions& opts) {
+    ItchPacketBuilder builder;
+    build_itch_mix(builder, 1);
+    ItchDecoder decoder;
+
+    if (selected(opts, "itch_decode_message")) {
+        // Table dispatch alone: one message per op, cycling through the mix
+        constexpr size_t MAX_MSGS = 32;
+        const uint8_t* msgs[MAX_MSGS];
+        uint16_t lengths[MAX_MSGS];
+        const uint8_t* p = builder.data() + itch::MOLD_HEADER_SIZE;
+        for (size_t i = 0; i < MAX_MSGS; ++i) {
+            lengths[i] = itch::load_be16(p);
+            msgs[i] = p + 2;
+            p += 2 + lengths[i];
+        }
+
+        MarketEvent event{};
+        uint64_t i = 0;
+        runner.run("itch_decode_message", [&] {
+            const size_t idx = i++ & (MAX_MSGS - 1);
+            const bool ok = decoder.decode_message(msgs[idx], lengths[idx], event);
+            do_not_optimize(ok);
+            do_not_optimize(event);
+        });
+    }
+
+    if (selected(opts, "itch_decode_packet")) {
+        // MoldUDP64 framing walk + 32 messages per op
+        uint64_t events = 0;
+        runner.run("itch_decode_packet", [&] {
+            events += decoder.decode_packet(builder.data(), builder.size(), 0,
+                                            [](const MarketEvent& e) { do_not_optimize(e); });
+        });
+        do_not_optimize(events);
+    }
+
+    if (selected(opts, "feed_handler_itch_trade")) {
+        // Full feed path for a single-trade MoldUDP64 packet, popped as the engine
+        auto queue = std::make_unique<SPSCQueue<MarketEvent, 65536>>();
+        auto stats = std::make_unique<FeedHandlerStats>();
+        auto handler = std::make_unique<ItchFeedHandler>(*queue, *stats, opts.bench.core);
+
+        MarketEvent event{};
+        uint64_t seq = 1;
+        runner.run("feed_handler_itch_trade", [&] {
+            builder.begin(seq++);
+            (void)builder.trade(1, 34200000000000, 0, 'B', 100, 1500000, seq);
+            handler->inject_packet(builder.data(), builder.size(), LatencyTracker::rdtsc());
+            const bool popped = queue->try_pop(event);
+            do_not_optimize(popped);
+            do_not_optimize(event);
+        });
+
+        if (stats->packets_dropped.load(std::memory_order_relaxed) > 0) {
+            std::cerr << "[Bench] feed_handler_itch_trade dropped events - queue not drained" << std::endl;
+        }
+    }
+}
+
+// ============================================================================
+// SBE DECODE vs NATIVE CAST
+// ============================================================================
+
+static void bench_sbe(BenchmarkRunner& runner, const MicrobenchOptions& opts) {
+    SbeDecoder decoder;
+    uint64_t events = 0;
+    const auto sink = [&events](const MarketEvent& e) {
+        do_not_optimize(e);
+        events++;
+    };
+
+    if (selected(opts, "native_cast_trade")) {
+        // Baseline: reinterpret_cast<const MarketDataPacket*> + field copy,
+        // as the pre-schema native parser did for a trade
+        MarketDataPacket packet;
+        fill_trade_packet(packet, 1, 0x12345678);
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(&packet);
+        do_not_optimize(data);
+        MarketEvent event{};
+        runner.run("native_cast_trade", [&] {
+            const auto* p = reinterpret_cast<const MarketDataPacket*>(data);
+            event.type = p->msg_type;
+            event.exchange_timestamp_ns = p->payload.trade.timestamp_ns;
+            event.symbol_id = p->payload.trade.symbol_id;
+            event.data.trade.price = p->payload.trade.price;
+            event.data.trade.quantity = p->payload.trade.quantity;
+            event.data.trade.side = p->payload.trade.side;
+            do_not_optimize(event);
+        });
+    }
+
+    if (selected(opts, "sbe_decode_trade")) {
+        // One trade summary message, one entry: same work per event as above
+        SbePacketBuilder builder;
+        builder.begin(1, 0);
+        (void)builder.begin_trades(34200000000000);
+        (void)builder.add_trade_entry(0x12345678, 1500000, 100, 'B', 1);
+        const size_t size = builder.size();
+        const uint8_t* data = builder.data();
+        runner.run("sbe_decode_trade", [&] {
+            decoder.decode_packet(data, size, 0, sink);
+        });
+    }
+
+    if (selected(opts, "sbe_decode_book_10")) {
+        // MDP3 packs many entries per message - 10 levels per op
+        SbePacketBuilder builder;
+        builder.begin(1, 0);
+        (void)builder.begin_book(34200000000000);
+        for (uint8_t level = 1; level <= 10; ++level) {
+            (void)builder.add_book_entry(0x12345678, 1500000 - level * 25, 100 * level, level,
+                                         level % 2 ? 'B' : 'S', 1);
+        }
+        const size_t size = builder.size();
+        const uint8_t* data = builder.data();
+        runner.run("sbe_decode_book_10", [&] {
+            decoder.decode_packet(data, size, 0, sink);
+        });
+    }
+
+    if (selected(opts, "feed_handler_sbe_trade")) {
+        // Full feed path, compare with feed_handler_trade (native)
+        auto queue = std::make_unique<SPSCQueue<MarketEvent, 65536>>();
+        auto stats = std::make_unique<FeedHandlerStats>();
+        auto handler = std::make_unique<SbeFeedHandler>(*queue, *stats, opts.bench.core);
+
+        SbePacketBuilder builder;
+        MarketEvent event{};
+        uint32_t seq = 1;
+        runner.run("feed_handler_sbe_trade", [&] {
+            builder.begin(seq++, 0);
+            (void)builder.begin_trades(34200000000000);
+            (void)builder.add_trade_entry(0x12345678, 1500000, 100, 'B', seq);
+            handler->inject_packet(builder.data(), builder.size(), LatencyTracker::rdtsc());
+            const bool popped = queue->try_pop(event);
+            do_not_optimize(popped);
+            do_not_optimize(event);
+        });
+
+        if (stats->packets_dropped.load(std::memory_order_relaxed) > 0) {
+            std::cerr << "[Bench] feed_handler_sbe_trade dropped events - queue not drained" << std::endl;
+        }
+    }
+    do_not_optimize(events);
+}
+
+// ============================================================================
+// SCHEMA-GENERATED vs HAND-WRITTEN DECODERS
+// ============================================================================
+
+/**
+ * Hand-written native normalization - the switch the native feed
+ * path used before NativeProtocol moved to the generated schema
+ */
+static bool decode_native_by_hand(const uint8_t* data, MarketEvent& event) {
+    const auto* packet = reinterpret_cast<const MarketDataPacket*>(data);
+    event.type = packet->msg_type;
+    switch (packet->msg_type) {
+        case MessageType::TRADE:
+            event.exchange_timestamp_ns = packet->payload.trade.timestamp_ns;
+            event.symbol_id = packet->payload.trade.symbol_id;
+            event.data.trade.price = packet->payload.trade.price;
+            event.data.trade.quantity = packet->payload.trade.quantity;
+            event.data.trade.side = packet->payload.trade.side;
+            return true;
+        case MessageType::QUOTE:
+            event.exchange_timestamp_ns = packet->payload.quote.timestamp_ns;
+            event.symbol_id = packet->payload.quote.symbol_id;
+            event.data.quote.bid_price = packet->payload.quote.bid_price;
+            event.data.quote.ask_price = packet->payload.quote.ask_price;
+            event.data.quote.bid_size = packet->payload.quote.bid_size;
+            event.data.quote.ask_size = packet->payload.quote.ask_size;
+            return true;
+        case MessageType::ORDER_ADD:
+        case MessageType::ORDER_DELETE:
+        case MessageType::ORDER_MODIFY:
+            event.exchange_timestamp_ns = packet->payload.order.timestamp_ns;
+            event.symbol_id = packet->payload.order.symbol_id;
+            event.data.order.order_id = packet->payload.order.order_id;
+            event.data.order.price = packet->payload.order.price;
+            event.data.order.quantity = packet->payload.order.quantity;
+            event.data.order.side = packet->payload.order.side;
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void bench_schema(BenchmarkRunner& runner, const MicrobenchOptions& opts) {
+    using NativeSchema = schema::native::Schema;
+
+    // 8 native packets cycling trade / quote / add / modify / delete,
+    // encoded through the schema
+    constexpr size_t MIX = 8;
+    static MarketDataPacket packets[MIX];
+    for (size_t i = 0; i < MIX; ++i) {
+        MarketEvent e{};
+        e.exchange_timestamp_ns = 34200000000000 + i;
+        e.symbol_id = static_cast<uint32_t>(1 + i);
+        uint8_t* buffer = reinterpret_cast<uint8_t*>(&packets[i]);
+        switch (i % 5) {
+            case 0:
+                e.data.trade = {1500000 + i, 100, 'B'};
+                (void)NativeSchema::encode<schema::native::Trade>(e, buffer);
+                break;
+            case 1:
+                e.data.quote = {1499900, 1500100, 300, 400};
+                (void)NativeSchema::encode<schema::native::Quote>(e, buffer);
+                break;
+            case 2:
+                e.data.order = {1000 + i, 1499800, 200, 'S'};
+                (void)NativeSchema::encode<schema::native::OrderAdd>(e, buffer);
+                break;
+            case 3:
+                e.data.order = {1000 + i, 1499900, 150, 'S'};
+                (void)NativeSchema::encode<schema::native::OrderModify>(e, buffer);
+                break;
+            default:
+                e.data.order = {1000 + i, 0, 0, 'S'};
+                (void)NativeSchema::encode<schema::native::OrderDelete>(e, buffer);
+                break;
+        }
+    }
+
+    if (selected(opts, "native_switch_mix")) {
+        MarketEvent event{};
+        uint64_t i = 0;
+        runner.run("native_switch_mix", [&] {
+            const auto* data = reinterpret_cast<const uint8_t*>(&packets[i++ & (MIX - 1)]);
+            const bool ok = decode_native_by_hand(data, event);
+            do_not_optimize(ok);
+            do_not_optimize(event);
+        });
+    }
+
+    if (selected(opts, "native_schema_mix")) {
+        MarketEvent event{};
+        uint64_t i = 0;
+        runner.run("native_schema_mix", [&] {
+            const auto* data = reinterpret_cast<const uint8_t*>(&packets[i++ & (MIX - 1)]);
+            const auto result = NativeSchema::decode(data, sizeof(MarketDataPacket), event);
+            do_not_optimize(result);
+            do_not_optimize(event);
+        });
+    }
+
+    if (selected(opts, "native_schema_trade")) {
+        // Compare with native_cast_trade
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(&packets[0]);
+        do_not_optimize(data);
+        MarketEvent event{};
+        runner.run("native_schema_trade", [&] {
+            const auto result = NativeSchema::decode(data, sizeof(MarketDataPacket), event);
+            do_not_optimize(result);
+            do_not_optimize(event);
+        });
+    }
+
+    if (selected(opts, "itch_schema_decode_message")) {
+        // Compare with itch_decode_message (table dispatch, same message mix)
+        ItchPacketBuilder builder;
+        build_itch_mix(builder, 1);
+        constexpr size_t MAX_MSGS = 32;
+        const uint8_t* msgs[MAX_MSGS];
+        uint16_t lengths[MAX_MSGS];
+        const uint8_t* p = builder.data() + itch::MOLD_HEADER_SIZE;
+        for (size_t i = 0; i < MAX_MSGS; ++i) {
+            lengths[i] = itch::load_be16(p);
+            msgs[i] = p + 2;
+            p += 2 + lengths[i];
+        }
+
+        MarketEvent event{};
+        uint64_t i = 0;
+        runner.run("itch_schema_decode_message", [&] {
+            const size_t idx = i++ & (MAX_MSGS - 1);
+            const auto result = itch::Schema::decode(msgs[idx], lengths[idx], event);
+            do_not_optimize(result);
+            do_not_optimize(event);
+        });
+    }
+}
+
+// ============================================================================
+// CLOCK SKEW
+// ============================================================================
+
+static void bench_clock_skew(BenchmarkRunner& runner, const MicrobenchOptions& opts) {
+    if (!selected(opts, "clock_skew_on_event")) {
+        return;
+    }
+
+    // Engine-side cost per event: clock conversion, estimator, two histograms
+    auto monitor = std::make_unique<ClockSkewMonitor>();
+    monitor->start(LatencyTracker::calibrate_tsc_ghz(20));
+    MarketEvent event{};
+    event.type = MessageType::TRADE;
+    uint64_t i = 0;
+    runner.run("clock_skew_on_event", [&] {
+        const uint64_t now = LatencyTracker::rdtsc();
+        event.recv_timestamp_ns = now - 300;
+        event.exchange_timestamp_ns = monitor->local_ns(now) - 20000 - (i & 1023);
+        event.channel_id = static_cast<uint8_t>(i++ & 3);
+        monitor->on_event(event, now);
+    });
+    do_not_optimize(monitor->channel(0).samples.load(std::memory_order_relaxed));
+}
+
+static void bench_feed_health(BenchmarkRunner& runner, const MicrobenchOptions& opts) {
+    if (selected(opts, "feed_health_check")) {
+        // Engine-side gate per order: one byte load, healthy
+        FeedHealth health;
+        uint64_t i = 0;
+        uint64_t sends = 0;
+        runner.run("feed_health_check", [&] {
+            sends += health.healthy(static_cast<uint8_t>(i++ & 3));
+            do_not_optimize(sends);
+        });
+    }
+
+    if (selected(opts, "feed_health_evaluate")) {
+        // Health thread pass over 4 live channels
+        auto monitor = std::make_unique<ClockSkewMonitor>();
+        const double tsc_ghz = LatencyTracker::calibrate_tsc_ghz(20);
+        monitor->start(tsc_ghz);
+        auto queue = std::make_unique<SPSCQueue<MarketEvent, 65536>>();
+        FeedHealth health;
+        health.watch_clock_skew(monitor.get());
+        MarketEvent event{};
+        for (uint8_t ch = 0; ch < 4; ++ch) {
+            const uint64_t now = LatencyTracker::rdtsc();
+            event.channel_id = ch;
+            event.recv_timestamp_ns = now;
+            event.exchange_timestamp_ns = monitor->local_ns(now) - 20000;
+            monitor->on_event(event, now);
+            health.watch_queue(ch, *queue);
+        }
+        runner.run("feed_health_evaluate", [&] {
+            health.evaluate(LatencyTracker::rdtsc(), tsc_ghz);
+        });
+        do_not_optimize(health.evaluations());
+    }
+}
+
+static void bench_feed_group(BenchmarkRunner& runner, const MicrobenchOptions& opts) {
+    if (!selected(opts, "idle_sockets_16")) {
+        return;
+    }
+
+    // What one core pays per iteration to watch 16 quiet channels:
+    // busy-polling each socket vs one zero-timeout epoll check (FeedGroup)
+    constexpr size_t CHANNELS = 16;
+    auto sockets = std::make_unique<UDPReceiver[]>(CHANNELS);
+    const int epoll_fd = epoll_create1(0);
+    for (size_t i = 0; i < CHANNELS; ++i) {
+        const std::string group = "233.54.13." + std::to_string(1 + i);
+        if (!sockets[i].initialize(group, static_cast<uint16_t>(17000 + i))) {
+            std::cerr << "[Bench] idle_sockets_16: socket setup failed - skipped" << std::endl;
+            close(epoll_fd);
+            return;
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u32 = static_cast<uint32_t>(i);
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sockets[i].fd(), &ev);
+    }
+
+    uint8_t buffer[2048];
+    runner.run("busy_poll_idle_sockets_16", [&] {
+        ssize_t total = 0;
+        for (size_t i = 0; i < CHANNELS; ++i) {
+            total += sockets[i].receive(buffer, sizeof(buffer));
+        }
+        do_not_optimize(total);
+    });
+
+    epoll_event events[CHANNELS];
+    runner.run("epoll_check_idle_sockets_16", [&] {
+        do_not_optimize(epoll_wait(epoll_fd, events, static_cast<int>(CHANNELS), 0));
+    });
+    close(epoll_fd);
+}
+
+static void bench_broadcast(BenchmarkRunner& runner, const MicrobenchOptions& opts) {
+    if (!selected(opts, "broadcast_")) {
+        return;
+    }
+
+    BroadcastConfig cfg;
+    cfg.name = "/hft_md_bench";
+    BroadcastPublisher publisher;
+    BroadcastSubscriber subscriber;
+    if (!publisher.open(cfg) || !subscriber.attach(cfg.name)) {
+        std::cerr << "[Bench] broadcast: shm segment unavailable - skipped" << std::endl;
+        return;
+    }
+
+    // Feed-side cost per event (subscriber not reading - the ring just wraps)
+    MarketEvent event{};
+    event.type = MessageType::TRADE;
+    uint64_t seq = 0;
+    runner.run("broadcast_publish", [&] {
+        event.sequence = ++seq;
+        publisher.publish(event);
+    });
+
+    // One published event read back through a second (read-only) mapping
+    (void)subscriber.attach(cfg.name);
+    MarketEvent out{};
+    runner.run("broadcast_publish_read", [&] {
+        event.sequence = ++seq;
+        publisher.publish(event);
+        do_not_optimize(subscriber.try_read(out));
+    });
+    do_not_optimize(out.sequence);
+
+    publisher.close();
+    shm_unlink(cfg.name.c_str());
+}
+
+template<size_t Inputs>
+static void bench_merge_inputs(BenchmarkRunner& runner, const char* name) {
+    using Queue = SPSCQueue<MarketEvent, 1024>;
+    auto queues = std::make_unique<Queue[]>(Inputs);
+    auto merger = std::make_unique<EventMerger<Queue>>();
+
+    // Each input's stream is ordered on its own, interleaved unevenly with
+    // the others; every input stays non-empty (steady state, no waiting)
+    uint64_t clock[Inputs];
+    uint32_t rng = 12345;
+    MarketEvent event{};
+    for (size_t i = 0; i < Inputs; ++i) {
+        merger->add_input(queues[i]);
+        clock[i] = i;
+        for (int n = 0; n < 64; ++n) {
+            rng = rng * 1664525u + 1013904223u;
+            clock[i] += 1 + (rng >> 24);
+            event.exchange_timestamp_ns = clock[i];
+            event.channel_id = static_cast<uint8_t>(i);
+            (void)queues[i].try_push(event);
+        }
+    }
+
+    // Per op: merge one event out, push the next one for its input
+    MarketEvent out{};
+    runner.run(name, [&] {
+        if (merger->poll(out)) {
+            const size_t i = out.channel_id;
+            rng = rng * 1664525u + 1013904223u;
+            clock[i] += 1 + (rng >> 24);
+            event.exchange_timestamp_ns = clock[i];
+            event.channel_id = out.channel_id;
+            (void)queues[i].try_push(event);
+        }
+    });
+    if (merger->late() != 0) {
+        std::cerr << "[Bench] " << name << ": " << merger->late() << " events out of order" << std::endl;
+    }
+}
+
+static void bench_merge(BenchmarkRunner& runner, const MicrobenchOptions& opts) {
+    if (selected(opts, "merge_2_inputs")) bench_merge_inputs<2>(runner, "merge_2_inputs");
+    if (selected(opts, "merge_4_inputs")) bench_merge_inputs<4>(runner, "merge_4_inputs");
+    if (selected(opts, "merge_8_inputs")) bench_merge_inputs<8>(runner, "merge_8_inputs");
+    if (selected(opts, "merge_16_inputs")) bench_merge_inputs<16>(runner, "merge_16_inputs");
+}
+
+/**
+ * Venue quote stream for the NBBO cases: uniform symbols (10K books do not
+ * fit in L2), prices within a few ticks of each symbol's mid so venues
+ * keep joining and leaving the best level, a third size-only updates
+ */
+struct NbboUpdateStream {
+    static constexpr size_t COUNT = 1 << 16;
+    struct Update {
+        uint32_t symbol;
+        uint32_t venue;
+        uint64_t bid_price;
+        uint64_t ask_price;
+        uint32_t bid_size;
+        uint32_t ask_size;
+    };
+    std::unique_ptr<Update[]> updates{std::make_unique<Update[]>(COUNT)};
+
+    NbboUpdateStream(uint32_t symbols, uint32_t venues) {
+        uint32_t rng = 777;
+        auto next = [&rng] { rng = rng * 1664525u + 1013904223u; return rng >> 8; };
+        auto last = std::make_unique<Update[]>(static_cast<size_t>(symbols) * venues);
+        for (size_t i = 0; i < COUNT; ++i) {
+            const uint32_t symbol = next() % symbols;
+            const uint32_t venue = next() % venues;
+            Update& prev = last[static_cast<size_t>(symbol) * venues + venue];
+            const uint64_t mid = 100000 + symbol * 100;
+            Update u{symbol, venue, mid - 1 - next() % 4, mid + 1 + next() % 4, 1 + next() % 500, 1 + next() % 500};
+            if (next() % 3 == 0 && prev.bid_price != 0) {
+                u.bid_price = prev.bid_price;
+                u.ask_price = prev.ask_price;
+            }
+            updates[i] = prev = u;
+        }
+    }
+};
+
+template<size_t Venues>
+static void bench_nbbo_venues(BenchmarkRunner& runner, const MicrobenchOptions& opts,
+                              const char* name, const char* rescan_name) {
+    constexpr uint32_t SYMBOLS = 10000;
+    const NbboUpdateStream stream(SYMBOLS, Venues);
+
+    if (selected(opts, name)) {
+        auto book = std::make_unique<NbboBook<Venues>>(SYMBOLS);
+        size_t i = 0;
+        uint64_t changes = 0;
+        runner.run(name, [&] {
+            const auto& u = stream.updates[i++ & (NbboUpdateStream::COUNT - 1)];
+            changes += book->update(u.symbol, u.venue, u.bid_price, u.bid_size, u.ask_price, u.ask_size);
+        });
+        do_not_optimize(changes);
+    }
+
+    if (selected(opts, rescan_name)) {
+        // Baseline: store the venue quote, recompute the NBBO from every venue
+        struct Quote { uint64_t bid_price, ask_price; uint32_t bid_size, ask_size; };
+        auto quotes = std::make_unique<Quote[]>(static_cast<size_t>(SYMBOLS) * Venues);
+        auto nbbo = std::make_unique<Nbbo[]>(SYMBOLS);
+        size_t i = 0;
+        runner.run(rescan_name, [&] {
+            const auto& u = stream.updates[i++ & (NbboUpdateStream::COUNT - 1)];
+            Quote* q = &quotes[static_cast<size_t>(u.symbol) * Venues];
+            q[u.venue] = Quote{u.bid_price, u.ask_price, u.bid_size, u.ask_size};
+            Nbbo n{};
+            for (size_t v = 0; v < Venues; ++v) {
+                if (q[v].bid_price > n.bid_price) {
+                    n.bid_price = q[v].bid_price; n.bid_size = 0; n.bid_venues = 0;
+                }
+                if (q[v].bid_price == n.bid_price && q[v].bid_price != 0) {
+                    n.bid_size += q[v].bid_size; n.bid_venues |= 1ULL << v;
+                }
+                if (q[v].ask_price != 0 && (n.ask_price == 0 || q[v].ask_price < n.ask_price)) {
+                    n.ask_price = q[v].ask_price; n.ask_size = 0; n.ask_venues = 0;
+                }
+                if (q[v].ask_price == n.ask_price && q[v].ask_price != 0) {
+                    n.ask_size += q[v].ask_size; n.ask_venues |= 1ULL << v;
+                }
+            }
+            nbbo[u.symbol] = n;
+        });
+        do_not_optimize(nbbo[0].bid_price);
+    }
+}
+
+static void bench_nbbo(BenchmarkRunner& runner, const MicrobenchOptions& opts) {
+    if (!selected(opts, "nbbo_")) {
+        return;
+    }
+    bench_nbbo_venues<10>(runner, opts, "nbbo_update_10v_10k", "nbbo_rescan_10v_10k");
+    bench_nbbo_venues<16>(runner, opts, "nbbo_update_16v_10k", "nbbo_rescan_16v_10k");
+    bench_nbbo_venues<32>(runner, opts, "nbbo_update_32v_10k", "nbbo_rescan_32v_10k");
+}
+
+// ============================================================================
+// SYMBOL SUBSCRIPTION FILTER
+// ============================================================================
+
+/**
+ * Full ITCH feed path for 24-trade packets over 100 symbols, 10 of them
+ * subscribed - a channel that is ~90% unwanted symbols. Compare with the
+ * unfiltered case (every event normalized and queued); the engine side
+ * drains the queue in both.
+ */
+static void bench_symbol_filter_case(BenchmarkRunner& runner, const MicrobenchOptions& opts,
+                                     const char* name, bool filtered) {
+    constexpr uint16_t SYMBOLS = 100;
+    constexpr uint64_t TRADES = 24;     // Fills a 1400-byte MoldUDP64 packet
+    auto queue = std::make_unique<SPSCQueue<MarketEvent, 65536>>();
+    auto stats = std::make_unique<FeedHandlerStats>();
+    auto handler = std::make_unique<ItchFeedHandler>(*queue, *stats, opts.bench.core);
+    SymbolFilter filter;
+    if (filtered) {
+        filter.edit(SYMBOLS, [](SubscriptionSet& set) {
+            for (uint16_t symbol = 0; symbol < SYMBOLS; symbol += 10) {
+                (void)set.subscribe(symbol);
+            }
+        });
+        (void)handler->set_symbol_filter(&filter);
+    }
+
+    // One packet, symbols i * 7 % 100 (3 of 24 subscribed); only the
+    // MoldUDP64 sequence changes per op
+    ItchPacketBuilder builder;
+    builder.begin(1);
+    for (uint64_t i = 0; i < TRADES; ++i) {
+        (void)builder.trade(static_cast<uint16_t>(i * 7 % SYMBOLS), 34200000000000, 0, 'B', 100, 1500000, i);
+    }
+    alignas(64) uint8_t packet[ItchPacketBuilder::MAX_PACKET_SIZE];
+    const size_t size = builder.size();
+    std::memcpy(packet, builder.data(), size);
+
+    MarketEvent event{};
+    uint64_t seq = 1;
+    uint64_t popped = 0;
+    runner.run(name, [&] {
+        itch::store_be64(packet + itch::MOLD_SESSION_SIZE, seq);
+        seq += TRADES;
+        handler->inject_packet(packet, size, LatencyTracker::rdtsc());
+        while (queue->try_pop(event)) {
+            popped++;
+        }
+    });
+    do_not_optimize(popped);
+
+    if (stats->packets_dropped.load(std::memory_order_relaxed) > 0) {
+        std::cerr << "[Bench] " << name << " dropped events - queue not drained" << std::endl;
+    }
+}
+
+static void bench_symbol_filter(BenchmarkRunner& runner, const MicrobenchOptions& opts) {
+    if (selected(opts, "feed_handler_itch_all_symbols")) {
+        bench_symbol_filter_case(runner, opts, "feed_handler_itch_all_symbols", false);
+    }
+    if (selected(opts, "feed_handler_itch_subscribed_10pct")) {
+        bench_symbol_filter_case(runner, opts, "feed_handler_itch_subscribed_10pct", true);
+    }
+}
+
+// ============================================================================
+// SUITE
+// ============================================================================
+
+static void run_suite(BenchmarkRunner& runner, const MicrobenchOptions& opts) {
+    bench_spsc(runner, opts);
+    bench_memory_pool(runner, opts);
+    bench_packet_manager(runner, opts);
+    bench_logger(runner, opts);
+    bench_feed_handler(runner, opts);
+    bench_itch(runner, opts);
+    bench_sbe(runner, opts);
+    bench_schema(runner, opts);
+    bench_clock_skew(runner, opts);
+    bench_feed_health(runner, opts);
+    bench_feed_group(runner, opts);
+    bench_broadcast(runner, opts);
+    bench_merge(runner, opts);
+    bench_nbbo(runner, opts);
+    bench_symbol_filter(runner, opts);
+}
+
+/**
+ * --huge-text: itlb_miss/op per benchmark on 4KB text vs after remap_text()
+ */
+static void print_itlb_comparison(const std::vector<BenchmarkResult>& before,
+                                  const std::vector<BenchmarkResult>& after) {
+    printf("\n%-36s %14s %14s\n", "iTLB misses/op", "4KB text", "2MB text");
+    bool any = false;
+    for (const BenchmarkResult& b : before) {
+        for (const BenchmarkResult& a : after) {
+            if (a.name != b.name || !a.has_perf || !b.has_perf) continue;
+            constexpr size_t ITLB = static_cast<size_t>(PerfEvent::ITLB_MISSES);
+            printf("%-36s %14.4f %14.4f\n", b.name.c_str(), b.perf_per_op[ITLB], a.perf_per_op[ITLB]);
+            any = true;
+        }
+    }
+    if (!any) {
+        printf("  (no hardware counters - iTLB misses not measured)\n");
+    }
+}
+
+/**
+ * HOT-PATH MICROBENCHMARKS
+ *
+ * Benchmarks the production headers in isolation - the lessons have timing
+ * loops, but nothing guards the code that actually ships.
+ *
+ * Each case: warmup, N timed repetitions (median/stddev ns/op), then an
+ * individually timed pass for the per-op percentile distribution.
+ * Results go to JSON; --baseline compares median ns/op against an earlier
+ * run and exits non-zero on regressions.
+ *
+ * --huge-text runs the suite twice in one process - on 4KB text pages,
+ * then again after remapping .text onto 2MB pages - and prints itlb_miss/op
+ * before/after per benchmark (needs the PMU; build with HUGE_TEXT=1).
+ * JSON and --baseline use the second (huge page) pass.
+ *
+ * Usage:
+ *   ./microbench [--core N] [--reps N] [--ops N] [--samples N] [--filter substr]
+ *                [--output bench_micro.json] [--baseline old.json] [--threshold pct]
+ *                [--huge-text]
+ */
+int main(int argc, char* argv[]) {
+    MicrobenchOptions opts;
+    double threshold_pct = 5.0;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--core" && has_value) {
+            opts.bench.core = std::atoi(argv[++i]);
+        } else if (arg == "--reps" && has_value) {
+            opts.bench.repetitions = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (arg == "--ops" && has_value) {
+            opts.bench.ops_per_rep = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--samples" && has_value) {
+            opts.bench.latency_samples = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--filter" && has_value) {
+            opts.filter = argv[++i];
+        } else if (arg == "--output" && has_value) {
+            opts.output = argv[++i];
+        } else if (arg == "--baseline" && has_value) {
+            opts.baseline = argv[++i];
+        } else if (arg == "--threshold" && has_value) {
+            threshold_pct = std::atof(argv[++i]);
+        } else if (arg == "--huge-text") {
+            opts.huge_text = true;
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--core N] [--reps N] [--ops N] [--samples N] [--filter substr]"
+                      << " [--output file.json] [--baseline old.json] [--threshold pct] [--huge-text]"
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    if (opts.bench.repetitions == 0 || opts.bench.ops_per_rep == 0) {
+        std::cerr << "[Bench] --reps and --ops must be > 0" << std::endl;
+        return 1;
+    }
+
+    // Baseline pass on 4KB text pages; the logger thread is shut down again
+    // because remap_text() must run with no other threads alive
+    std::vector<BenchmarkResult> small_page_results;
+    size_t remapped = 0;
+    if (opts.huge_text) {
+        {
+            Logger::initialize("microbench.log", LogLevel::WARN);
+            BenchmarkRunner small_pages(opts.bench);
+            std::cout << "=== 4KB text pages ===" << std::endl;
+            BenchmarkRunner::print_header();
+            run_suite(small_pages, opts);
+            small_page_results = small_pages.results();
+            Logger::shutdown();
+        }
+        remapped = HugePages::remap_text();
+        std::cout << std::endl;
+    }
+
+    Logger::initialize("microbench.log", LogLevel::WARN);
+
+    BenchmarkRunner runner(opts.bench);
+    std::cout << "=== HFT Microbenchmarks (commit " << HFT_GIT_COMMIT << ", TSC "
+              << runner.tsc_ghz() << " GHz, core " << opts.bench.core << ") ===" << std::endl;
+    BenchmarkRunner::print_header();
+
+    run_suite(runner, opts);
+
+    if (opts.huge_text) {
+        if (remapped > 0) {
+            print_itlb_comparison(small_page_results, runner.results());
+        } else {
+            std::cout << "\n[Bench] Text not remapped - both passes ran on 4KB pages" << std::endl;
+        }
+    }
+
+    int exit_code = 0;
+    if (!runner.write_json(opts.output, HFT_GIT_COMMIT)) {
+        std::cerr << "[Bench] Failed to write " << opts.output << std::endl;
+        exit_code = 1;
+    } else {
+        std::cout << "\nResults written to " << opts.output << std::endl;
+    }
+
+    if (!opts.baseline.empty() && runner.compare_with(opts.baseline, threshold_pct) > 0) {
+        exit_code = 2;
+    }
+
+    Logger::shutdown();
+    return exit_code;
+}
@@ -0,0 +1,248 @@
+#pragma once
+
+#include "types.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+namespace hft {
+
+/**
+ * Consolidated best bid/offer for one symbol
+ */
+struct Nbbo {
+    uint64_t bid_price{0};      // 0 = no venue bidding
+    uint64_t ask_price{0};      // 0 = no venue offering
+    uint64_t bid_size{0};       // Summed over every venue at the best bid
+    uint64_t ask_size{0};
+    uint64_t bid_venues{0};     // Bit per venue at the best bid
+    uint64_t ask_venues{0};
+
+    [[nodiscard]] bool two_sided() const noexcept { return bid_price != 0 && ask_price != 0; }
+    [[nodiscard]] bool locked() const noexcept { return two_sided() && bid_price == ask_price; }
+    [[nodiscard]] bool crossed() const noexcept { return two_sided() && bid_price > ask_price; }
+};
+
+/**
+ * Consolidated NBBO Book
+ *
+ * Per-symbol top of book across venues, fed one venue quote at a time
+ * (TradingEngine::handle_quote; venue = the event's channel id). Nothing
+ * rescans every venue's quote on an update:
+ *
+ * - each side keeps a small array of (price, venue) sorted best-first,
+ *   one entry per quoting venue - a reprice is a remove + insert inside
+ *   MaxVenues entries (one or two lines, memmove)
+ * - the best level is cached as price, aggregate size and a venue bitmask;
+ *   a size-only change at an unchanged price (the common update) is a mask
+ *   test and an add - the sorted array is not touched
+ *
+ * Symbol state is one contiguous block (quotes, both sides), so an update
+ * touches only that symbol's lines. Single writer (the engine thread).
+ *
+ * @tparam MaxVenues Venues per symbol, at most 64 (bitmask width)
+ */
+template<size_t MaxVenues = 16>
+class NbboBook {
+    static_assert(MaxVenues >= 1 && MaxVenues <= 64, "venue bitmask is 64 bits");
+
+public:
+    static constexpr size_t MAX_VENUES = MaxVenues;
+
+private:
+    struct VenueQuote {
+        uint64_t bid_price;
+        uint64_t ask_price;
+        uint32_t bid_size;
+        uint32_t ask_size;
+    };
+
+    struct Side {
+        uint64_t best_price;
+        uint64_t best_size;
+        uint64_t best_venues;
+        uint32_t count;                     // Quoting venues
+        uint8_t venue[MaxVenues];           // Sorted best-first (ties: earliest first)
+        uint64_t price[MaxVenues];
+    };
+
+    struct alignas(64) SymbolState {
+        Side bid;
+        Side ask;
+        VenueQuote quotes[MaxVenues];
+    };
+
+    std::unique_ptr<SymbolState[]> symbols_;
+    size_t capacity_;
+
+    // Stats (owner thread)
+    uint64_t updates_{0};
+    uint64_t changes_{0};           // Updates that moved the NBBO (price, size or venues)
+    uint64_t size_only_{0};         // Fast path: sizes at an unchanged price
+    uint64_t rejected_{0};          // Symbol or venue out of range
+
+public:
+    explicit NbboBook(size_t num_symbols)
+        : symbols_(std::make_unique<SymbolState[]>(num_symbols)), capacity_(num_symbols) {
+        std::memset(static_cast<void*>(symbols_.get()), 0, sizeof(SymbolState) * num_symbols);
+    }
+
+    NbboBook(const NbboBook&) = delete;
+    NbboBook& operator=(const NbboBook&) = delete;
+
+    /**
+     * Venue top-of-book update (QUOTE event)
+     * @return true if the symbol's NBBO changed
+     */
+    bool on_quote(const MarketEvent& event) noexcept {
+        const auto& q = event.data.quote;
+        return update(event.symbol_id, event.channel_id, q.bid_price, q.bid_size, q.ask_price, q.ask_size);
+    }
+
+    /**
+     * Replace one venue's top of book - a side with price or size 0 is
+     * not quoted by that venue
+     * @return true if the symbol's NBBO changed
+     */
+    bool update(uint32_t symbol, uint32_t venue,
+                uint64_t bid_price, uint32_t bid_size,
+                uint64_t ask_price, uint32_t ask_size) noexcept {
+        if (symbol >= capacity_ || venue >= MaxVenues) [[unlikely]] {
+            rejected_++;
+            return false;
+        }
+        updates_++;
+        SymbolState& s = symbols_[symbol];
+        VenueQuote& quote = s.quotes[venue];
+        if (bid_size == 0) bid_price = 0;
+        if (ask_size == 0) ask_price = 0;
+
+        const bool changed =
+            update_side<true>(s.bid, s.quotes, venue, quote.bid_price, quote.bid_size, bid_price, bid_size) |
+            update_side<false>(s.ask, s.quotes, venue, quote.ask_price, quote.ask_size, ask_price, ask_size);
+        changes_ += changed;
+        return changed;
+    }
+
+    /**
+     * Current consolidated quote
+     */
+    [[nodiscard]] Nbbo nbbo(uint32_t symbol) const noexcept {
+        if (symbol >= capacity_) {
+            return Nbbo{};
+        }
+        const SymbolState& s = symbols_[symbol];
+        return Nbbo{s.bid.best_price, s.ask.best_price, s.bid.best_size, s.ask.best_size,
+                    s.bid.best_venues, s.ask.best_venues};
+    }
+
+    [[nodiscard]] size_t capacity() const noexcept { return capacity_; }
+    [[nodiscard]] uint64_t updates() const noexcept { return updates_; }
+    [[nodiscard]] uint64_t changes() const noexcept { return changes_; }
+    [[nodiscard]] uint64_t size_only() const noexcept { return size_only_; }
+    [[nodiscard]] uint64_t rejected() const noexcept { return rejected_; }
+
+    void print() const {
+        printf("[NBBO] %zu symbols x %zu venues: %lu updates, %lu NBBO changes, %lu size-only, %lu rejected\n",
+               capacity_, MaxVenues, updates_, changes_, size_only_, rejected_);
+    }
+
+private:
+    template<bool Bid>
+    [[nodiscard]] static inline bool better(uint64_t a, uint64_t b) noexcept {
+        return Bid ? a > b : a < b;
+    }
+
+    template<bool Bid>
+    [[nodiscard]] static inline uint32_t side_size(const VenueQuote& q) noexcept {
+        return Bid ? q.bid_size : q.ask_size;
+    }
+
+    /**
+     * One side of a venue update; stores the new price/size into the
+     * venue's quote
+     * @return true if the side's best price, size or venues changed
+     */
+    template<bool Bid>
+    bool update_side(Side& side, VenueQuote* quotes, uint32_t venue,
+                     uint64_t& price_slot, uint32_t& size_slot,
+                     uint64_t new_price, uint32_t new_size) noexcept {
+        const uint64_t old_price = price_slot;
+        const uint32_t old_size = size_slot;
+        price_slot = new_price;
+        size_slot = new_price != 0 ? new_size : 0;
+
+        if (old_price == new_price) {
+            // Size only (or still absent): adjust the aggregate if at best
+            if (new_price == 0 || old_size == new_size) {
+                return false;
+            }
+            size_only_++;
+            if (!(side.best_venues & (1ULL << venue))) {
+                return false;
+            }
+            side.best_size = side.best_size - old_size + new_size;
+            return true;
+        }
+
+        if (old_price != 0) {
+            remove(side, venue);
+        }
+        if (new_price != 0) {
+            insert<Bid>(side, venue, new_price);
+        }
+        return refresh_best<Bid>(side, quotes);
+    }
+
+    static inline void remove(Side& side, uint32_t venue) noexcept {
+        uint32_t i = 0;
+        while (side.venue[i] != venue) {
+            ++i;
+        }
+        const uint32_t tail = side.count - i - 1;
+        std::memmove(&side.venue[i], &side.venue[i + 1], tail);
+        std::memmove(&side.price[i], &side.price[i + 1], tail * sizeof(uint64_t));
+        side.count--;
+    }
+
+    template<bool Bid>
+    static inline void insert(Side& side, uint32_t venue, uint64_t price) noexcept {
+        // After every entry at least as good - equal prices keep arrival order
+        uint32_t i = 0;
+        while (i < side.count && !better<Bid>(price, side.price[i])) {
+            ++i;
+        }
+        const uint32_t tail = side.count - i;
+        std::memmove(&side.venue[i + 1], &side.venue[i], tail);
+        std::memmove(&side.price[i + 1], &side.price[i], tail * sizeof(uint64_t));
+        side.venue[i] = static_cast<uint8_t>(venue);
+        side.price[i] = price;
+        side.count++;
+    }
+
+    /**
+     * Best level from the front of the sorted array - walks only the
+     * venues tied at the best price
+     */
+    template<bool Bid>
+    static inline bool refresh_best(Side& side, const VenueQuote* quotes) noexcept {
+        uint64_t price = 0;
+        uint64_t size = 0;
+        uint64_t venues = 0;
+        if (side.count != 0) {
+            price = side.price[0];
+            for (uint32_t i = 0; i < side.count && side.price[i] == price; ++i) {
+                venues |= 1ULL << side.venue[i];
+                size += side_size<Bid>(quotes[side.venue[i]]);
+            }
+        }
+        const bool changed = price != side.best_price || size != side.best_size || venues != side.best_venues;
+        side.best_price = price;
+        side.best_size = size;
+        side.best_venues = venues;
+        return changed;
+    }
+};
+
+} // namespace hft
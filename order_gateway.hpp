@@ -0,0 +1,202 @@
+#pragma once
+
+#include "spsc_queue.hpp"
+#include "types.hpp"
+#include "utils.hpp"
+#include "logger.hpp"
+#include "warmup.hpp"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <iostream>
+#include <atomic>
+#include <string>
+
+namespace hft {
+
+// External global for shutdown signaling
+extern std::atomic<bool> g_running;
+
+/**
+ * Engine -> gateway queue
+ * Orders are rare relative to market data - 4K slots is plenty
+ */
+using OrderQueue = SPSCQueue<OrderRequest, 4096>;
+
+/**
+ * Order Gateway
+ *
+ * Last stage of tick-to-trade:
+ * - Consumes OrderRequests from the trading engine (SPSC queue)
+ * - Encodes binary wire message
+ * - Sends to exchange
+ *
+ * In production: TCP session per venue (OUCH over SoupBinTCP, iLink3 over
+ * FIXP) with sequence numbers, throttles and risk checks. Here UDP keeps
+ * the loopback benchmark free of TCP buffering effects.
+ *
+ * Runs on dedicated CPU core with RT priority
+ */
+class OrderGateway {
+private:
+    OrderQueue& order_queue_;
+    int core_id_;
+    int socket_fd_{-1};
+    sockaddr_in exchange_addr_{};
+    uint64_t next_client_order_id_{1};
+
+    // Idle-time encoder warming (off unless enable_idle_warming() is called)
+    uint64_t idle_warm_interval_us_{0};
+    uint64_t idle_warm_passes_{0};
+
+    alignas(64) std::atomic<uint64_t> orders_sent_{0};
+    alignas(64) std::atomic<uint64_t> send_failures_{0};
+    std::atomic<bool> running_{false};      // In the polling loop
+
+public:
+    OrderGateway(OrderQueue& queue, int core_id = 2)
+        : order_queue_(queue), core_id_(core_id) {}
+
+    ~OrderGateway() {
+        if (socket_fd_ >= 0) {
+            close(socket_fd_);
+        }
+    }
+
+    OrderGateway(const OrderGateway&) = delete;
+    OrderGateway& operator=(const OrderGateway&) = delete;
+
+    /**
+     * Open order-entry socket to exchange
+     */
+    bool init(const std::string& exchange_ip, uint16_t port) noexcept {
+        socket_fd_ = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (socket_fd_ < 0) {
+            return false;
+        }
+
+        exchange_addr_.sin_family = AF_INET;
+        exchange_addr_.sin_port = htons(port);
+        if (inet_pton(AF_INET, exchange_ip.c_str(), &exchange_addr_.sin_addr) != 1) {
+            close(socket_fd_);
+            socket_fd_ = -1;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Keep the encoding path hot through quiet periods
+     * After interval_us without orders a dummy request is encoded into a
+     * scratch message - never sent. Call before run().
+     */
+    void enable_idle_warming(uint64_t interval_us = 50) noexcept {
+        idle_warm_interval_us_ = interval_us;
+    }
+
+    /**
+     * Main gateway loop - busy polls order queue
+     */
+    void run() {
+        if (!ThreadUtils::pin_to_core(core_id_)) {
+            std::cerr << "[OrderGateway] Failed to pin to core " << core_id_ << std::endl;
+        }
+        if (!ThreadUtils::set_realtime_priority()) {
+            std::cerr << "[OrderGateway] SCHED_FIFO unavailable (needs CAP_SYS_NICE)" << std::endl;
+        }
+        Prefault::stack();
+
+        std::cout << "[OrderGateway] Started on core " << core_id_ << std::endl;
+        LOG_INFO("OrderGateway thread started");
+
+        const uint64_t idle_warm_interval_ticks = idle_warm_interval_us_ == 0 ? 0 :
+            static_cast<uint64_t>(idle_warm_interval_us_ * 1000 * LatencyTracker::calibrate_tsc_ghz(20));
+        uint64_t last_activity_tsc = LatencyTracker::rdtsc();
+
+        OrderRequest request{};
+        running_.store(true, std::memory_order_release);
+        while (g_running.load(std::memory_order_acquire)) {
+            if (order_queue_.try_pop(request)) {
+                send(request);
+                last_activity_tsc = LatencyTracker::rdtsc();
+            } else {
+                if (idle_warm_interval_ticks != 0) {
+                    const uint64_t now = LatencyTracker::rdtsc();
+                    if (now - last_activity_tsc > idle_warm_interval_ticks) [[unlikely]] {
+                        warm_encoder(request);
+                        last_activity_tsc = now;
+                    }
+                }
+                SpinWait::pause();
+            }
+        }
+
+        // Drain - don't lose orders queued before shutdown
+        while (order_queue_.try_pop(request)) {
+            send(request);
+        }
+
+        std::cout << "[OrderGateway] Stopped. Orders sent: " << orders_sent()
+                  << ", Idle warming passes: " << idle_warm_passes_ << std::endl;
+    }
+
+    [[nodiscard]] uint64_t orders_sent() const noexcept {
+        return orders_sent_.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] uint64_t send_failures() const noexcept {
+        return send_failures_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * run() has reached its polling loop (benchmark start handshake)
+     */
+    [[nodiscard]] bool running() const noexcept {
+        return running_.load(std::memory_order_acquire);
+    }
+
+private:
+    static void encode(const OrderRequest& request, uint64_t client_order_id,
+                       NewOrderMessage& msg) noexcept {
+        msg = NewOrderMessage{};
+        msg.client_order_id = client_order_id;
+        msg.origin_timestamp_ns = request.origin_timestamp_ns;
+        msg.event_recv_tsc = request.event_recv_tsc;
+        msg.price = request.price;
+        msg.symbol_id = request.symbol_id;
+        msg.quantity = request.quantity;
+        msg.side = request.side;
+    }
+
+    void send(const OrderRequest& request) noexcept {
+        NewOrderMessage msg;
+        encode(request, next_client_order_id_++, msg);
+
+        // Stamp as late as possible - right before the syscall
+        msg.gateway_send_tsc = LatencyTracker::rdtsc();
+
+        const ssize_t bytes = sendto(socket_fd_, &msg, sizeof(msg), MSG_DONTWAIT,
+                                     reinterpret_cast<const sockaddr*>(&exchange_addr_),
+                                     sizeof(exchange_addr_));
+        if (bytes == static_cast<ssize_t>(sizeof(msg))) {
+            orders_sent_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            send_failures_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Encode the last request again into a scratch message
+     * Client order id 0 and no syscall - the sequence of real ids is untouched.
+     */
+    [[gnu::noinline]] void warm_encoder(const OrderRequest& request) noexcept {
+        NewOrderMessage msg;
+        encode(request, 0, msg);
+        msg.gateway_send_tsc = LatencyTracker::rdtsc();
+        asm volatile("" : : "r"(&msg) : "memory");
+        idle_warm_passes_++;
+    }
+};
+
+} // namespace hft
@@ -42,6 +42,11 @@ struct GapFillRequest {
  * 5. Recovery feed integration
  * 6. Statistics tracking
  * 
+ * Sequence numbers may count packets (count = 1, the default) or messages
+ * (MoldUDP64: a packet carrying N messages advances the sequence by N).
+ * A retransmitted packet that only partially overlaps what was already
+ * processed is treated as old and dropped.
+ * 
  * Based on patterns from:
  * - NYSE Pillar Protocol
  * - NASDAQ TotalView-ITCH
@@ -64,8 +69,12 @@ private:
     std::unordered_set<uint64_t> recent_seq_set_;
     
     // Out-of-order buffer - holds packets that arrive early
-    // Key: sequence number, Value: packet data
-    std::map<uint64_t, std::vector<uint8_t>> resequence_buffer_;
+    // Key: first sequence number, Value: packet data + sequence numbers it covers
+    struct BufferedPacket {
+        std::vector<uint8_t> data;
+        uint64_t count;
+    };
+    std::map<uint64_t, BufferedPacket> resequence_buffer_;
     static constexpr size_t MAX_RESEQUENCE_BUFFER_SIZE = 1000;
     
     // Gap tracking and recovery
@@ -74,6 +83,13 @@ private:
     static constexpr uint64_t GAP_TIMEOUT_NS = 1000000000ULL; // 1 second
     static constexpr uint8_t MAX_RETRIES = 3;
     
+    // Warm restart: the first live packet must reach the resume point
+    // (less this much slack for late duplicates) or the feed restarted
+    static constexpr uint64_t RESUME_SLACK = 16;
+    bool resume_pending_{false};
+    bool resume_gap_{false};            // Gap at the resume point being recovered
+    bool gap_recovery_{true};           // Retransmission can fill gaps
+    
     // Statistics
     struct Stats {
         alignas(64) uint64_t total_packets{0};
@@ -83,6 +99,7 @@ private:
         alignas(64) uint64_t out_of_order{0};
         alignas(64) uint64_t resequenced{0};
         alignas(64) uint64_t dropped_overflow{0};
+        alignas(64) uint64_t resumes_abandoned{0};
     } stats_;
     
     // Callback for gap fill requests
@@ -102,20 +119,23 @@ public:
     /**
      * Process incoming packet - main entry point
      * 
-     * @param sequence Packet sequence number
+     * @param sequence Packet sequence number (first message's for message-sequenced feeds)
      * @param data Packet data (optional, for buffering)
      * @param timestamp Current timestamp for gap timeout checking
+     * @param count Sequence numbers consumed by this packet (MoldUDP64 message count)
      * @return true if packet should be processed now, false if duplicate/buffered
      */
     [[nodiscard]] bool process_packet(uint64_t sequence, 
                                        const uint8_t* data = nullptr, 
                                        size_t data_size = 0,
-                                       uint64_t timestamp = 0) {
+                                       uint64_t timestamp = 0,
+                                       uint64_t count = 1) {
         stats_.total_packets++;
         
         // Update highest seen
-        if (sequence > highest_seq_seen_) {
-            highest_seq_seen_ = sequence;
+        const uint64_t last = sequence + count - 1;
+        if (last > highest_seq_seen_) {
+            highest_seq_seen_ = last;
         }
         
         // Check for duplicate - O(1) lookup in hash set
@@ -127,16 +147,20 @@ public:
         // Mark as seen in duplicate detection window
         mark_seen(sequence);
         
+        if (resume_pending_) [[unlikely]] {
+            check_resume(sequence, count);
+        }
+        
         // Handle based on current state
         switch (state_) {
             case FeedState::INITIAL:
-                return handle_initial_state(sequence);
+                return handle_initial_state(sequence, count);
                 
             case FeedState::LIVE:
-                return handle_live_state(sequence, data, data_size, timestamp);
+                return handle_live_state(sequence, data, data_size, timestamp, count);
                 
             case FeedState::RECOVERING:
-                return handle_recovering_state(sequence, data, data_size);
+                return handle_recovering_state(sequence, data, data_size, count);
                 
             case FeedState::STALE:
                 // In stale state, drop all incremental updates until resync
@@ -161,9 +185,9 @@ public:
             }
             
             // Found next packet in sequence
-            ready.push_back(std::move(it->second));
+            next_expected_seq_ += it->second.count;
+            ready.push_back(std::move(it->second.data));
             resequence_buffer_.erase(it);
-            next_expected_seq_++;
             stats_.resequenced++;
         }
         
@@ -189,6 +213,7 @@ public:
         // If all gaps filled, return to LIVE state
         if (pending_gaps_.empty() && state_ == FeedState::RECOVERING) {
             state_ = FeedState::LIVE;
+            resume_gap_ = false;
         }
     }
     
@@ -207,6 +232,12 @@ public:
                     if (gap_fill_callback_) {
                         gap_fill_callback_(gap);
                     }
+                } else if (resume_gap_) {
+                    // What was missed while down is not coming - a cold
+                    // start beats a STALE feed
+                    trigger_resync();
+                    stats_.resumes_abandoned++;
+                    return;
                 } else {
                     // Too many retries - transition to STALE
                     state_ = FeedState::STALE;
@@ -222,12 +253,50 @@ public:
      */
     void trigger_resync() {
         state_ = FeedState::INITIAL;
+        resume_pending_ = false;
+        resume_gap_ = false;
         resequence_buffer_.clear();
         pending_gaps_.clear();
         recent_sequences_.clear();
         recent_seq_set_.clear();
     }
     
+    /**
+     * Warm restart: continue at a persisted sequence instead of accepting
+     * whatever arrives first. Older packets are dropped as already applied;
+     * a newer one opens a gap - recovery of what was missed while down.
+     * 
+     * Except the first live packet: one ending well before the resume point
+     * means the feed (or session) restarted its sequence since the snapshot
+     * was taken, so the resume point is abandoned and that packet starts
+     * the feed as from INITIAL. The same goes for a gap at the resume point
+     * that cannot be recovered - no retransmission (set_gap_recovery), too
+     * large, or still open after the last retry - where a cold start is
+     * better than a feed that goes STALE for good.
+     */
+    void resume_from(uint64_t sequence) {
+        trigger_resync();
+        next_expected_seq_ = sequence;
+        state_ = FeedState::LIVE;
+        resume_pending_ = true;
+    }
+    
+    /**
+     * Whether gap fill requests can be answered (a retransmission service
+     * is connected) - without one a gap at the resume point abandons it
+     */
+    void set_gap_recovery(bool available) noexcept {
+        gap_recovery_ = available;
+    }
+    
+    /**
+     * Zero statistics (e.g. after warmup traffic)
+     */
+    void reset_stats() noexcept {
+        stats_ = Stats{};
+        highest_seq_seen_ = 0;
+    }
+    
     /**
      * Get current state
      */
@@ -250,12 +319,34 @@ public:
     }
 
 private:
+    /**
+     * First packet after resume_from(): far below the resume point, or past
+     * it by a gap that cannot be recovered -> INITIAL
+     */
+    void check_resume(uint64_t sequence, uint64_t count) noexcept {
+        resume_pending_ = false;
+        if (state_ != FeedState::LIVE) {
+            return;
+        }
+        if (sequence + count + RESUME_SLACK <= next_expected_seq_) {
+            state_ = FeedState::INITIAL;
+            stats_.resumes_abandoned++;
+        } else if (sequence > next_expected_seq_) {
+            if (!gap_recovery_ || sequence - next_expected_seq_ > MAX_GAP_SIZE) {
+                state_ = FeedState::INITIAL;
+                stats_.resumes_abandoned++;
+            } else {
+                resume_gap_ = true;
+            }
+        }
+    }
+    
     /**
      * Initial state - waiting for first packet or snapshot
      * Accept any sequence number and start from there
      */
-    bool handle_initial_state(uint64_t sequence) {
-        next_expected_seq_ = sequence + 1;
+    bool handle_initial_state(uint64_t sequence, uint64_t count) {
+        next_expected_seq_ = sequence + count;
         state_ = FeedState::LIVE;
         return true; // Process this packet
     }
@@ -263,10 +354,11 @@ private:
     /**
      * Live state - normal operation with gap detection
      */
-    bool handle_live_state(uint64_t sequence, const uint8_t* data, size_t data_size, uint64_t timestamp) {
+    bool handle_live_state(uint64_t sequence, const uint8_t* data, size_t data_size,
+                           uint64_t timestamp, uint64_t count) {
         if (sequence == next_expected_seq_) {
             // Perfect - in sequence
-            next_expected_seq_++;
+            next_expected_seq_ += count;
             return true;
             
         } else if (sequence < next_expected_seq_) {
@@ -306,7 +398,7 @@ private:
             
             // Buffer this packet if data provided
             if (data && data_size > 0) {
-                buffer_packet(sequence, data, data_size);
+                buffer_packet(sequence, data, data_size, count);
                 stats_.out_of_order++;
             }
             
@@ -317,14 +409,16 @@ private:
     /**
      * Recovering state - buffering out-of-order packets while waiting for gap fill
      */
-    bool handle_recovering_state(uint64_t sequence, const uint8_t* data, size_t data_size) {
+    bool handle_recovering_state(uint64_t sequence, const uint8_t* data, size_t data_size,
+                                 uint64_t count) {
         if (sequence == next_expected_seq_) {
             // Gap was filled! Process this packet
-            next_expected_seq_++;
+            next_expected_seq_ += count;
             
             // Check if all gaps filled
             if (pending_gaps_.empty()) {
                 state_ = FeedState::LIVE;
+                resume_gap_ = false;
             }
             
             return true;
@@ -332,7 +426,7 @@ private:
         } else if (sequence > next_expected_seq_) {
             // Still ahead - buffer it
             if (data && data_size > 0) {
-                buffer_packet(sequence, data, data_size);
+                buffer_packet(sequence, data, data_size, count);
                 stats_.out_of_order++;
             }
             return false;
@@ -343,7 +437,7 @@ private:
             for (auto it = pending_gaps_.begin(); it != pending_gaps_.end(); ) {
                 if (sequence >= it->start_seq && sequence <= it->end_seq) {
                     // This is part of a gap being filled
-                    if (sequence == it->end_seq) {
+                    if (sequence + count - 1 >= it->end_seq) {
                         // Gap completely filled
                         process_gap_fill(it->start_seq, it->end_seq);
                     }
@@ -384,7 +478,7 @@ private:
     /**
      * Buffer out-of-order packet for later processing
      */
-    void buffer_packet(uint64_t sequence, const uint8_t* data, size_t data_size) {
+    void buffer_packet(uint64_t sequence, const uint8_t* data, size_t data_size, uint64_t count) {
         // Check buffer size limit
         if (resequence_buffer_.size() >= MAX_RESEQUENCE_BUFFER_SIZE) {
             // Buffer full - drop oldest or this packet
@@ -395,7 +489,7 @@ private:
         
         // Copy packet data into buffer
         std::vector<uint8_t> packet_copy(data, data + data_size);
-        resequence_buffer_[sequence] = std::move(packet_copy);
+        resequence_buffer_[sequence] = BufferedPacket{std::move(packet_copy), count};
     }
 };
 
@@ -414,6 +508,14 @@ private:
     // For example: CME MDP 3.0 has separate TCP Replay channel
     
 public:
+    /**
+     * Whether request_retransmission() reaches a recovery service - false
+     * until the protocol is implemented
+     */
+    [[nodiscard]] bool can_retransmit() const noexcept {
+        return false;
+    }
+    
     /**
      * Request retransmission of specific sequence range
      * 
@@ -0,0 +1,564 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+
+namespace hft {
+
+/**
+ * One UDP datagram extracted from a capture file
+ * payload points straight into the mapped file - valid while the reader is open
+ */
+struct CapturedPacket {
+    const uint8_t* payload;
+    uint32_t payload_len;
+    uint64_t capture_timestamp_ns;  // Capture (tap/NIC) timestamp, ns since epoch
+    uint32_t dst_ip;                // Host byte order
+    uint16_t dst_port;              // Host byte order
+};
+
+/**
+ * Zero-Copy PCAP / PCAPNG Reader
+ *
+ * Exchange captures from network taps (Arista/Metamako, Corvil, ExaNIC)
+ * are the only way to benchmark the feed handler on real market days.
+ *
+ * Design:
+ * - Whole file mmap'd read-only with MADV_SEQUENTIAL (no read() copies)
+ * - Payload pointers reference the mapping directly (zero-copy)
+ * - Classic pcap: usec and nsec variants, either byte order
+ * - PCAPNG: multiple sections, per-interface link type and if_tsresol/if_tsoffset
+ * - Link layers: Ethernet (+802.1Q/QinQ), Linux SLL/SLL2, raw IPv4
+ * - IPv4/UDP filter on destination group + port, fragments are skipped
+ *
+ * Throughput is bounded by page cache bandwidth - tens of millions of
+ * packets per second, far above any single feed's rate.
+ */
+class PcapReader {
+private:
+    // Classic pcap magics (as read in native little-endian order)
+    static constexpr uint32_t PCAP_MAGIC_USEC = 0xA1B2C3D4;
+    static constexpr uint32_t PCAP_MAGIC_NSEC = 0xA1B23C4D;
+    static constexpr uint32_t PCAP_MAGIC_USEC_SWAPPED = 0xD4C3B2A1;
+    static constexpr uint32_t PCAP_MAGIC_NSEC_SWAPPED = 0x4D3CB2A1;
+
+    // PCAPNG block types
+    static constexpr uint32_t PCAPNG_SHB = 0x0A0D0D0A;  // Section Header Block
+    static constexpr uint32_t PCAPNG_IDB = 0x00000001;  // Interface Description Block
+    static constexpr uint32_t PCAPNG_PB  = 0x00000002;  // Packet Block (obsolete)
+    static constexpr uint32_t PCAPNG_SPB = 0x00000003;  // Simple Packet Block
+    static constexpr uint32_t PCAPNG_EPB = 0x00000006;  // Enhanced Packet Block
+    static constexpr uint32_t PCAPNG_BYTE_ORDER_MAGIC = 0x1A2B3C4D;
+
+    // Link types (LINKTYPE_*)
+    static constexpr uint32_t LINKTYPE_ETHERNET = 1;
+    static constexpr uint32_t LINKTYPE_RAW = 101;
+    static constexpr uint32_t LINKTYPE_LINUX_SLL = 113;
+    static constexpr uint32_t LINKTYPE_IPV4 = 228;
+    static constexpr uint32_t LINKTYPE_LINUX_SLL2 = 276;
+
+    static constexpr size_t MAX_INTERFACES = 16;
+
+    enum class Format : uint8_t { NONE, PCAP, PCAPNG };
+
+    // Per-interface parameters (pcapng can mix link types and resolutions)
+    struct Interface {
+        uint32_t link_type;
+        uint64_t ts_units_per_sec;  // From if_tsresol (default 10^6)
+        int64_t  ts_offset_sec;     // From if_tsoffset
+    };
+
+    const uint8_t* data_{nullptr};
+    size_t size_{0};
+    size_t offset_{0};
+    size_t first_record_{0};
+    int fd_{-1};
+
+    Format format_{Format::NONE};
+    bool swapped_{false};
+    bool nanosecond_{false};
+
+    Interface interfaces_[MAX_INTERFACES]{};
+    uint32_t num_interfaces_{0};
+
+    // Filter (host byte order, 0 = wildcard)
+    uint32_t filter_ip_{0};
+    uint16_t filter_port_{0};
+
+    // Statistics
+    uint64_t records_read_{0};
+    uint64_t packets_matched_{0};
+    uint64_t packets_skipped_{0};
+    uint64_t last_capture_ns_{0};   // Of the packet last returned by receive_internal
+
+public:
+    PcapReader() = default;
+
+    ~PcapReader() {
+        close_file();
+    }
+
+    // Non-copyable (owns mapping)
+    PcapReader(const PcapReader&) = delete;
+    PcapReader& operator=(const PcapReader&) = delete;
+
+    /**
+     * Map capture file and parse its global header
+     *
+     * @return false if file can't be mapped or isn't pcap/pcapng
+     */
+    bool open(const std::string& path) noexcept {
+        close_file();
+
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) {
+            return false;
+        }
+
+        struct stat st;
+        if (fstat(fd_, &st) < 0 || st.st_size < 12) {
+            close_file();
+            return false;
+        }
+        size_ = static_cast<size_t>(st.st_size);
+
+        void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd_, 0);
+        if (mapping == MAP_FAILED) {
+            data_ = nullptr;
+            close_file();
+            return false;
+        }
+        data_ = static_cast<const uint8_t*>(mapping);
+
+        // Kernel read-ahead for a linear scan
+        madvise(mapping, size_, MADV_SEQUENTIAL);
+
+        const uint32_t magic = load_native32(data_);
+        bool ok = false;
+        if (magic == PCAPNG_SHB) {
+            format_ = Format::PCAPNG;
+            ok = true;  // SHB is parsed as the first block by next()
+            first_record_ = 0;
+        } else {
+            ok = parse_pcap_header(magic);
+        }
+
+        if (!ok) {
+            close_file();
+            return false;
+        }
+
+        offset_ = first_record_;
+        return true;
+    }
+
+    /**
+     * Restrict output to UDP datagrams for one multicast group/port
+     *
+     * @param group_ip Destination IP, "0.0.0.0" or empty for any
+     * @param port Destination port, 0 for any
+     */
+    void set_filter(const std::string& group_ip, uint16_t port) noexcept {
+        filter_ip_ = 0;
+        if (!group_ip.empty()) {
+            in_addr addr{};
+            if (inet_pton(AF_INET, group_ip.c_str(), &addr) == 1) {
+                filter_ip_ = ntohl(addr.s_addr);
+            }
+        }
+        filter_port_ = port;
+    }
+
+    /**
+     * Advance to the next UDP datagram matching the filter
+     *
+     * @return false at end of file (or on a truncated record)
+     */
+    [[nodiscard]] bool next(CapturedPacket& out) noexcept {
+        if (format_ == Format::PCAP) {
+            return next_pcap(out);
+        }
+        if (format_ == Format::PCAPNG) {
+            return next_pcapng(out);
+        }
+        return false;
+    }
+
+    /**
+     * Same shape as UDPReceiver::receive_internal so the reader can stand in
+     * for the socket. Returns -1 at end of capture. The packet's capture
+     * timestamp is kept for last_capture_ns().
+     */
+    [[nodiscard]] ssize_t receive_internal(const uint8_t*& buffer_ptr) noexcept {
+        CapturedPacket pkt;
+        if (!next(pkt)) {
+            return -1;
+        }
+        buffer_ptr = pkt.payload;
+        last_capture_ns_ = pkt.capture_timestamp_ns;
+        return static_cast<ssize_t>(pkt.payload_len);
+    }
+
+    /**
+     * Restart from first record (for multi-pass benchmarks)
+     */
+    void rewind() noexcept {
+        offset_ = first_record_;
+        if (format_ == Format::PCAPNG) {
+            num_interfaces_ = 0;
+        }
+    }
+
+    [[nodiscard]] bool is_open() const noexcept { return data_ != nullptr; }
+    [[nodiscard]] size_t file_size() const noexcept { return size_; }
+    [[nodiscard]] uint64_t records_read() const noexcept { return records_read_; }
+    [[nodiscard]] uint64_t packets_matched() const noexcept { return packets_matched_; }
+    [[nodiscard]] uint64_t packets_skipped() const noexcept { return packets_skipped_; }
+
+    /**
+     * Hardware (tap/NIC) capture timestamp of the last packet from
+     * receive_internal, ns since epoch (0 for pcapng simple packet blocks)
+     */
+    [[nodiscard]] uint64_t last_capture_ns() const noexcept { return last_capture_ns_; }
+
+private:
+    void close_file() noexcept {
+        if (data_) {
+            munmap(const_cast<uint8_t*>(data_), size_);
+            data_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        size_ = 0;
+        offset_ = 0;
+        format_ = Format::NONE;
+        num_interfaces_ = 0;
+    }
+
+    // ---- Byte order helpers (unaligned-safe) ----
+
+    static uint32_t load_native32(const uint8_t* p) noexcept {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    uint16_t load16(const uint8_t* p) const noexcept {
+        uint16_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return swapped_ ? __builtin_bswap16(v) : v;
+    }
+
+    uint32_t load32(const uint8_t* p) const noexcept {
+        uint32_t v = load_native32(p);
+        return swapped_ ? __builtin_bswap32(v) : v;
+    }
+
+    static uint16_t load_be16(const uint8_t* p) noexcept {
+        return static_cast<uint16_t>((p[0] << 8) | p[1]);
+    }
+
+    static uint32_t load_be32(const uint8_t* p) noexcept {
+        return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+               (static_cast<uint32_t>(p[2]) << 8) | p[3];
+    }
+
+    // ---- Classic pcap ----
+
+    bool parse_pcap_header(uint32_t magic) noexcept {
+        switch (magic) {
+            case PCAP_MAGIC_USEC: swapped_ = false; nanosecond_ = false; break;
+            case PCAP_MAGIC_NSEC: swapped_ = false; nanosecond_ = true; break;
+            case PCAP_MAGIC_USEC_SWAPPED: swapped_ = true; nanosecond_ = false; break;
+            case PCAP_MAGIC_NSEC_SWAPPED: swapped_ = true; nanosecond_ = true; break;
+            default: return false;
+        }
+
+        constexpr size_t GLOBAL_HEADER_SIZE = 24;
+        if (size_ < GLOBAL_HEADER_SIZE) {
+            return false;
+        }
+
+        format_ = Format::PCAP;
+        interfaces_[0] = Interface{
+            .link_type = load32(data_ + 20) & 0x0FFFFFFF,  // Upper bits are FCS info
+            .ts_units_per_sec = nanosecond_ ? 1000000000ULL : 1000000ULL,
+            .ts_offset_sec = 0
+        };
+        num_interfaces_ = 1;
+        first_record_ = GLOBAL_HEADER_SIZE;
+        return true;
+    }
+
+    bool next_pcap(CapturedPacket& out) noexcept {
+        constexpr size_t RECORD_HEADER_SIZE = 16;
+
+        while (offset_ + RECORD_HEADER_SIZE <= size_) {
+            const uint8_t* rec = data_ + offset_;
+            const uint32_t ts_sec = load32(rec);
+            const uint32_t ts_frac = load32(rec + 4);
+            const uint32_t caplen = load32(rec + 8);
+
+            if (offset_ + RECORD_HEADER_SIZE + caplen > size_) {
+                offset_ = size_;  // Truncated capture - stop cleanly
+                return false;
+            }
+            offset_ += RECORD_HEADER_SIZE + caplen;
+            records_read_++;
+
+            const uint64_t ts_ns = static_cast<uint64_t>(ts_sec) * 1000000000ULL +
+                                   (nanosecond_ ? ts_frac : static_cast<uint64_t>(ts_frac) * 1000ULL);
+
+            if (extract_udp(interfaces_[0].link_type, rec + RECORD_HEADER_SIZE, caplen, ts_ns, out)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // ---- PCAPNG ----
+
+    bool next_pcapng(CapturedPacket& out) noexcept {
+        while (offset_ + 12 <= size_) {
+            const uint8_t* blk = data_ + offset_;
+
+            // Section header defines byte order for everything after it
+            if (load_native32(blk) == PCAPNG_SHB) {
+                const uint32_t bom = load_native32(blk + 8);
+                if (bom == PCAPNG_BYTE_ORDER_MAGIC) {
+                    swapped_ = false;
+                } else if (bom == __builtin_bswap32(PCAPNG_BYTE_ORDER_MAGIC)) {
+                    swapped_ = true;
+                } else {
+                    offset_ = size_;
+                    return false;
+                }
+                num_interfaces_ = 0;  // Interface ids are per-section
+            }
+
+            const uint32_t block_type = load32(blk);
+            const uint32_t block_len = load32(blk + 4);
+            if (block_len < 12 || (block_len & 3) != 0 || offset_ + block_len > size_) {
+                offset_ = size_;
+                return false;
+            }
+            offset_ += block_len;
+
+            switch (block_type) {
+                case PCAPNG_IDB:
+                    parse_idb(blk, block_len);
+                    break;
+
+                case PCAPNG_EPB: {
+                    if (block_len < 32) break;
+                    records_read_++;
+                    const uint32_t if_id = load32(blk + 8);
+                    const uint64_t ts = (static_cast<uint64_t>(load32(blk + 12)) << 32) | load32(blk + 16);
+                    const uint32_t caplen = load32(blk + 20);
+                    // 28-byte header + 4-byte trailing length; block_len >= 32: no wrap
+                    if (if_id >= num_interfaces_ || caplen > block_len - 32) break;
+
+                    const Interface& itf = interfaces_[if_id];
+                    if (extract_udp(itf.link_type, blk + 28, caplen, to_ns(itf, ts), out)) {
+                        return true;
+                    }
+                    break;
+                }
+
+                case PCAPNG_PB: {
+                    if (block_len < 32) break;
+                    records_read_++;
+                    const uint32_t if_id = load16(blk + 8);
+                    const uint64_t ts = (static_cast<uint64_t>(load32(blk + 12)) << 32) | load32(blk + 16);
+                    const uint32_t caplen = load32(blk + 20);
+                    // 28-byte header + 4-byte trailing length; block_len >= 32: no wrap
+                    if (if_id >= num_interfaces_ || caplen > block_len - 32) break;
+
+                    const Interface& itf = interfaces_[if_id];
+                    if (extract_udp(itf.link_type, blk + 28, caplen, to_ns(itf, ts), out)) {
+                        return true;
+                    }
+                    break;
+                }
+
+                case PCAPNG_SPB: {
+                    // No timestamp, no captured length - implied interface 0
+                    if (block_len < 16) break;
+                    records_read_++;
+                    if (num_interfaces_ == 0) break;
+                    const uint32_t orig_len = load32(blk + 8);
+                    const uint32_t avail = block_len - 16;     // 12-byte header + trailer
+                    const uint32_t caplen = orig_len < avail ? orig_len : avail;
+                    if (extract_udp(interfaces_[0].link_type, blk + 12, caplen, 0, out)) {
+                        return true;
+                    }
+                    break;
+                }
+
+                default:
+                    break;  // SHB, NRB, ISB, custom blocks - nothing to extract
+            }
+        }
+        return false;
+    }
+
+    void parse_idb(const uint8_t* blk, uint32_t block_len) noexcept {
+        if (num_interfaces_ >= MAX_INTERFACES || block_len < 20) {
+            return;
+        }
+
+        Interface itf{
+            .link_type = load16(blk + 8),
+            .ts_units_per_sec = 1000000ULL,  // Default resolution: microseconds
+            .ts_offset_sec = 0
+        };
+
+        // Options: code(2) len(2) value(padded to 4)
+        size_t opt = 16;
+        const size_t opt_end = block_len - 4;
+        while (opt + 4 <= opt_end) {
+            const uint16_t code = load16(blk + opt);
+            const uint16_t len = load16(blk + opt + 2);
+            const uint8_t* val = blk + opt + 4;
+            if (code == 0 || opt + 4 + len > opt_end) break;  // opt_endofopt
+
+            if (code == 9 && len >= 1) {
+                // if_tsresol: MSB clear = 10^-n, MSB set = 2^-n
+                const uint8_t res = val[0];
+                const uint8_t exp = res & 0x7F;
+                uint64_t units = 1;
+                if (res & 0x80) {
+                    units = exp < 64 ? (1ULL << exp) : 1;
+                } else {
+                    for (uint8_t i = 0; i < exp && i < 19; ++i) units *= 10;
+                }
+                itf.ts_units_per_sec = units;
+            } else if (code == 14 && len >= 8) {
+                // if_tsoffset: seconds added to every timestamp
+                uint64_t v;
+                std::memcpy(&v, val, sizeof(v));
+                itf.ts_offset_sec = static_cast<int64_t>(swapped_ ? __builtin_bswap64(v) : v);
+            }
+
+            opt += 4 + ((len + 3u) & ~3u);
+        }
+
+        interfaces_[num_interfaces_++] = itf;
+    }
+
+    static uint64_t to_ns(const Interface& itf, uint64_t ts) noexcept {
+        const uint64_t units = itf.ts_units_per_sec;
+        const uint64_t sec = ts / units;
+        const uint64_t frac = ts % units;
+        uint64_t frac_ns;
+        if (units == 1000000000ULL) {
+            frac_ns = frac;
+        } else if (units < 1000000000ULL) {
+            frac_ns = frac * (1000000000ULL / units);
+        } else {
+            // Sub-nanosecond resolution (e.g. picosecond taps)
+            frac_ns = static_cast<uint64_t>(static_cast<unsigned __int128>(frac) * 1000000000ULL / units);
+        }
+        return (sec + itf.ts_offset_sec) * 1000000000ULL + frac_ns;
+    }
+
+    // ---- Protocol decode: L2 -> IPv4 -> UDP ----
+
+    bool extract_udp(uint32_t link_type, const uint8_t* frame, uint32_t caplen,
+                     uint64_t ts_ns, CapturedPacket& out) noexcept {
+        const uint8_t* ip = nullptr;
+        uint32_t remaining = 0;
+
+        switch (link_type) {
+            case LINKTYPE_ETHERNET: {
+                if (caplen < 14) break;
+                uint16_t ether_type = load_be16(frame + 12);
+                uint32_t l2_len = 14;
+                // Strip 802.1Q / 802.1ad tags
+                while ((ether_type == 0x8100 || ether_type == 0x88A8) && caplen >= l2_len + 4) {
+                    ether_type = load_be16(frame + l2_len + 2);
+                    l2_len += 4;
+                }
+                if (ether_type != 0x0800) break;
+                ip = frame + l2_len;
+                remaining = caplen - l2_len;
+                break;
+            }
+
+            case LINKTYPE_LINUX_SLL:
+                if (caplen < 16 || load_be16(frame + 14) != 0x0800) break;
+                ip = frame + 16;
+                remaining = caplen - 16;
+                break;
+
+            case LINKTYPE_LINUX_SLL2:
+                if (caplen < 20 || load_be16(frame) != 0x0800) break;
+                ip = frame + 20;
+                remaining = caplen - 20;
+                break;
+
+            case LINKTYPE_RAW:
+            case LINKTYPE_IPV4:
+                ip = frame;
+                remaining = caplen;
+                break;
+
+            default:
+                break;
+        }
+
+        if (!ip || remaining < 20 || (ip[0] >> 4) != 4 || ip[9] != IPPROTO_UDP) {
+            packets_skipped_++;
+            return false;
+        }
+
+        // Fragments (MF set or non-zero offset) can't be decoded standalone
+        if ((load_be16(ip + 6) & 0x3FFF) != 0) {
+            packets_skipped_++;
+            return false;
+        }
+
+        const uint32_t ihl = (ip[0] & 0x0F) * 4u;
+        if (ihl < 20 || remaining < ihl + 8) {
+            packets_skipped_++;
+            return false;
+        }
+
+        const uint32_t dst_ip = load_be32(ip + 16);
+        const uint8_t* udp = ip + ihl;
+        const uint16_t dst_port = load_be16(udp + 2);
+
+        if ((filter_ip_ != 0 && dst_ip != filter_ip_) ||
+            (filter_port_ != 0 && dst_port != filter_port_)) {
+            packets_skipped_++;
+            return false;
+        }
+
+        // UDP length may exceed snaplen - clamp to what was captured
+        const uint32_t udp_len = load_be16(udp + 4);
+        uint32_t payload_len = udp_len >= 8 ? udp_len - 8 : 0;
+        const uint32_t captured = remaining - ihl - 8;
+        if (payload_len > captured) {
+            payload_len = captured;
+        }
+
+        out.payload = udp + 8;
+        out.payload_len = payload_len;
+        out.capture_timestamp_ns = ts_ns;
+        out.dst_ip = dst_ip;
+        out.dst_port = dst_port;
+        packets_matched_++;
+        return true;
+    }
+};
+
+} // namespace hft
@@ -0,0 +1,216 @@
+#include "spsc_queue.hpp"
+#include "types.hpp"
+#include "utils.hpp"
+#include "logger.hpp"
+#include "pcap_reader.hpp"
+#include "itch_decoder.hpp"
+#include "feed_handler_impl.hpp"
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace hft;
+
+namespace hft {
+std::atomic<bool> g_running{true};
+}
+
+/**
+ * PCAP Replay Benchmark
+ *
+ * Feeds a tap capture through the production FeedHandler parse and
+ * sequencing path at full speed (no pacing), with a consumer thread
+ * draining the SPSC queue like the trading engine would.
+ *
+ * Reports replay throughput against the capture's own rate, so you can
+ * see how much headroom the stack has on a real market day.
+ *
+ * --itch decodes the payloads as ITCH 5.0 over MoldUDP64. A file that is
+ * not pcap/pcapng is then read as a raw NASDAQ ITCH 5.0 file (length-
+ * prefixed messages) and re-framed into MoldUDP64 packets.
+ * --sbe decodes the payloads as MDP 3.0 style SBE packets.
+ *
+ * Usage:
+ *   ./pcap_replay [--itch|--sbe] <capture.pcap|pcapng|itch50> [multicast_ip] [port] [feed_core] [consumer_core]
+ */
+struct ReplayConfig {
+    std::string path;
+    std::string multicast_ip;
+    uint16_t port;
+    int feed_core;
+    int consumer_core;
+};
+
+/**
+ * Capture summary from the pre-scan
+ */
+struct CaptureInfo {
+    uint64_t matched{0};
+    size_t file_size{0};
+};
+
+/**
+ * Open + pre-scan: count matching packets (also warms page cache), then
+ * rewind for the timed pass
+ */
+static bool open_capture(PcapReader& reader, const ReplayConfig& cfg, CaptureInfo& info) {
+    if (!reader.open(cfg.path)) {
+        return false;
+    }
+    reader.set_filter(cfg.multicast_ip, cfg.port);
+    CapturedPacket pkt;
+    while (reader.next(pkt)) {
+        info.matched++;
+    }
+    reader.rewind();
+    info.file_size = reader.file_size();
+    std::cout << "[Replay] " << cfg.path << ": " << info.file_size << " bytes, "
+              << info.matched << " matching UDP packets" << std::endl;
+    return true;
+}
+
+static bool open_capture(ItchFileReader& reader, const ReplayConfig& cfg, CaptureInfo& info) {
+    if (!reader.open(cfg.path)) {
+        return false;
+    }
+    const uint8_t* ptr = nullptr;
+    while (reader.receive_internal(ptr) >= 0) {
+        info.matched++;
+    }
+    std::cout << "[Replay] Raw ITCH file, " << reader.messages_read() << " messages" << std::endl;
+    reader.rewind();
+    info.file_size = reader.file_size();
+    std::cout << "[Replay] " << cfg.path << ": " << info.file_size << " bytes, "
+              << info.matched << " MoldUDP64 packets" << std::endl;
+    return true;
+}
+
+/**
+ * One replay, compiled for one capture format and one wire protocol
+ */
+template<typename Source, typename Protocol>
+static int run_replay(const ReplayConfig& cfg) {
+    // Static storage - queue is too large for the stack
+    static SPSCQueue<MarketEvent, 65536> event_queue;
+    static FeedHandlerStats stats;
+    auto feed_handler = std::make_unique<BasicFeedHandler<Source, Protocol>>(event_queue, stats, cfg.feed_core);
+
+    CaptureInfo info;
+    if (!open_capture(feed_handler->source(), cfg, info)) {
+        std::cerr << "[Replay] Failed to open capture: " << cfg.path << std::endl;
+        return 1;
+    }
+    if (info.matched == 0) {
+        return 1;
+    }
+
+    // Consumer: drains like the trading engine, without strategy cost
+    std::atomic<bool> producer_done{false};
+    std::atomic<uint64_t> events_consumed{0};
+    std::thread consumer([&]() {
+        ThreadUtils::pin_to_core(cfg.consumer_core);
+        MarketEvent event{};
+        uint64_t count = 0;
+        while (true) {
+            if (event_queue.try_pop(event)) {
+                count++;
+            } else if (producer_done.load(std::memory_order_acquire) && event_queue.empty()) {
+                break;
+            } else {
+                SpinWait::pause();
+            }
+        }
+        events_consumed.store(count, std::memory_order_relaxed);
+    });
+
+    ThreadUtils::pin_to_core(cfg.feed_core);
+
+    const auto start = std::chrono::steady_clock::now();
+    const uint64_t replayed = feed_handler->replay();
+    const auto end = std::chrono::steady_clock::now();
+
+    producer_done.store(true, std::memory_order_release);
+    consumer.join();
+
+    const double elapsed_s = std::chrono::duration<double>(end - start).count();
+    // Span on the capture's hardware clock, as seen by the replay itself
+    const uint64_t first_ns = feed_handler->capture_first_ns();
+    const uint64_t last_ns = feed_handler->capture_last_ns();
+    const double capture_s = last_ns > first_ns ? (last_ns - first_ns) / 1e9 : 0.0;
+    const auto& pm_stats = feed_handler->packet_manager().get_stats();
+
+    std::cout << "[Replay] Replayed " << replayed << " packets (" << Protocol::NAME << ") in "
+              << elapsed_s * 1000.0 << " ms ("
+              << (elapsed_s > 0 ? replayed / elapsed_s / 1e6 : 0.0) << " Mpps)" << std::endl;
+    if (capture_s > 0) {
+        std::cout << "[Replay] Capture span " << capture_s << " s, speedup "
+                  << capture_s / elapsed_s << "x over real time" << std::endl;
+    }
+    std::cout << "[Replay] Events: queued " << stats.packets_processed.load()
+              << ", consumed " << events_consumed.load()
+              << ", dropped " << stats.packets_dropped.load() << std::endl;
+    std::cout << "[Replay] Parse latency avg " << static_cast<int>(stats.avg_latency_ns())
+              << "ns, min " << stats.min_latency_ns << "ns, max " << stats.max_latency_ns << "ns" << std::endl;
+    std::cout << "[Replay] Sequencing - Duplicates: " << pm_stats.duplicates
+              << ", Gaps: " << pm_stats.gaps_detected
+              << ", Out-of-Order: " << pm_stats.out_of_order
+              << ", Resequenced: " << pm_stats.resequenced << std::endl;
+    feed_handler->protocol().print("Replay");
+    feed_handler->perf_counters().print("Replay");
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<const char*> args;
+    bool itch = false;
+    bool sbe = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--itch") == 0) {
+            itch = true;
+        } else if (std::strcmp(argv[i], "--sbe") == 0) {
+            sbe = true;
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+
+    if (args.empty() || (itch && sbe)) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--itch|--sbe] <capture.pcap|pcapng|itch50> [multicast_ip] [port] [feed_core] [consumer_core]"
+                  << std::endl;
+        std::cerr << "Example: " << argv[0] << " day.pcap 233.54.12.1 15000 0 1" << std::endl;
+        std::cerr << "         " << argv[0] << " --itch 01302019.NASDAQ_ITCH50" << std::endl;
+        return 1;
+    }
+
+    ReplayConfig cfg;
+    cfg.path = args[0];
+    cfg.multicast_ip = args.size() > 1 ? args[1] : "0.0.0.0";
+    cfg.port = args.size() > 2 ? static_cast<uint16_t>(std::atoi(args[2])) : 0;
+    cfg.feed_core = args.size() > 3 ? std::atoi(args[3]) : 0;
+    cfg.consumer_core = args.size() > 4 ? std::atoi(args[4]) : 1;
+
+    Logger::initialize("pcap_replay.log", LogLevel::INFO);
+
+    int result;
+    if (itch) {
+        // Not pcap/pcapng: a raw NASDAQ ITCH 5.0 file
+        PcapReader probe;
+        const bool raw_itch = !probe.open(cfg.path);
+        result = raw_itch ? run_replay<ItchFileReader, ItchProtocol>(cfg)
+                          : run_replay<PcapReader, ItchProtocol>(cfg);
+    } else if (sbe) {
+        result = run_replay<PcapReader, SbeProtocol>(cfg);
+    } else {
+        result = run_replay<PcapReader, NativeProtocol>(cfg);
+    }
+
+    Logger::shutdown();
+    return result;
+}
@@ -0,0 +1,446 @@
+#pragma once
+
+#include "types.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace hft {
+
+/**
+ * Compile-Time Protocol Schemas
+ *
+ * A wire message is declared once as a list of fields - type, offset,
+ * endianness, width - each bound to the MarketEvent member it normalizes
+ * into. From that one declaration the compiler generates:
+ *
+ * - decode(): field loads straight from the packet buffer (memcpy + bswap,
+ *   unaligned-safe), fully inlined - no packed struct, no copy
+ * - encode(): the inverse, for builders, warmup and tests
+ * - size checks: the message size is a constant, checked once per message
+ * - dispatch: a compare chain on the key field the optimizer turns into a
+ *   switch, with every decoder inlined into its case
+ *
+ * and rejects at compile time: fields past the end of the message,
+ * overlapping fields, duplicate message keys, and bindings where the
+ * MarketEvent member is narrower than the wire field.
+ *
+ * Example (a 16-byte big-endian message keyed on its first byte):
+ *
+ *   using Px = schema::Field<uint32_t, 8, schema::Endian::BIG>;
+ *   using Tick = schema::Message<'T', MessageType::TRADE, 16,
+ *       schema::Bind<Px, HFT_EVENT_FIELD(data.trade.price)>>;
+ *   using Proto = schema::Protocol<schema::Field<uint8_t, 0>, Tick>;
+ *
+ *   MarketEvent e{};
+ *   if (Proto::decode(buf, len, e) == schema::DecodeResult::DECODED) ...
+ */
+namespace schema {
+
+enum class Endian : uint8_t {
+    LITTLE,     // x86 native - SBE, the internal binary format
+    BIG         // network order - ITCH, OUCH, most exchange feeds
+};
+
+namespace detail {
+
+template<typename T>
+struct wire_uint {
+    using type = std::make_unsigned_t<T>;
+};
+
+template<typename T>
+    requires std::is_enum_v<T>
+struct wire_uint<T> {
+    using type = std::make_unsigned_t<std::underlying_type_t<T>>;
+};
+
+template<typename U>
+constexpr U byteswap(U v) noexcept {
+    if constexpr (sizeof(U) == 1) {
+        return v;
+    } else if constexpr (sizeof(U) == 2) {
+        return __builtin_bswap16(v);
+    } else if constexpr (sizeof(U) == 4) {
+        return __builtin_bswap32(v);
+    } else {
+        return __builtin_bswap64(v);
+    }
+}
+
+} // namespace detail
+
+/**
+ * One wire field
+ *
+ * @tparam T      Decoded C++ type (integral or enum)
+ * @tparam Offset Byte offset from the start of the message
+ * @tparam E      Byte order on the wire
+ * @tparam Width  Bytes on the wire, <= sizeof(T) (e.g. 6 for ITCH timestamps)
+ */
+template<typename T, size_t Offset, Endian E = Endian::LITTLE, size_t Width = sizeof(T)>
+struct Field {
+    static_assert(std::is_integral_v<T> || std::is_enum_v<T>, "schema fields are integers or enums");
+    static_assert(Width >= 1 && Width <= sizeof(T), "field width must fit its type");
+
+    using type = T;
+    using uint_type = typename detail::wire_uint<T>::type;
+    static constexpr size_t offset = Offset;
+    static constexpr size_t width = Width;
+    static constexpr size_t end = Offset + Width;
+    static constexpr Endian endian = E;
+
+    [[nodiscard]] static T load(const uint8_t* msg) noexcept {
+        const uint8_t* p = msg + Offset;
+        uint_type v = 0;
+        if constexpr (Width == sizeof(T)) {
+            std::memcpy(&v, p, sizeof(v));
+            if constexpr (E == Endian::BIG) {
+                v = detail::byteswap(v);
+            }
+        } else if constexpr (E == Endian::BIG) {
+            for (size_t i = 0; i < Width; ++i) {
+                v = static_cast<uint_type>((v << 8) | p[i]);
+            }
+        } else {
+            for (size_t i = 0; i < Width; ++i) {
+                v = static_cast<uint_type>(v | (static_cast<uint_type>(p[i]) << (8 * i)));
+            }
+        }
+        return static_cast<T>(v);
+    }
+
+    static void store(uint8_t* msg, T value) noexcept {
+        uint8_t* p = msg + Offset;
+        uint_type v = static_cast<uint_type>(value);
+        if constexpr (Width == sizeof(T)) {
+            if constexpr (E == Endian::BIG) {
+                v = detail::byteswap(v);
+            }
+            std::memcpy(p, &v, sizeof(v));
+        } else if constexpr (E == Endian::BIG) {
+            for (size_t i = 0; i < Width; ++i) {
+                p[Width - 1 - i] = static_cast<uint8_t>(v >> (8 * i));
+            }
+        } else {
+            for (size_t i = 0; i < Width; ++i) {
+                p[i] = static_cast<uint8_t>(v >> (8 * i));
+            }
+        }
+    }
+};
+
+/**
+ * Accessor for a MarketEvent member, usable as a template argument
+ *   HFT_EVENT_FIELD(data.trade.price)
+ */
+#define HFT_EVENT_FIELD(member) [](auto& event) -> auto& { return event.member; }
+
+/**
+ * Wire field F <-> MarketEvent member selected by Target
+ */
+template<typename F, auto Target>
+struct Bind {
+    using field = F;
+    using target_type = std::remove_reference_t<decltype(Target(std::declval<MarketEvent&>()))>;
+    static_assert(sizeof(target_type) >= F::width,
+                  "MarketEvent member is narrower than the wire field it is bound to");
+
+    static void decode(const uint8_t* msg, MarketEvent& out) noexcept {
+        Target(out) = static_cast<target_type>(F::load(msg));
+    }
+
+    static void encode(const MarketEvent& event, uint8_t* msg) noexcept {
+        F::store(msg, static_cast<typename F::type>(Target(event)));
+    }
+};
+
+/**
+ * MarketEvent member set to a constant - not on the wire
+ * (e.g. ITCH 'E' executions carry no price: it comes from the book)
+ */
+template<auto Target, auto Value>
+struct Fill {
+    using field = void;
+
+    static void decode(const uint8_t*, MarketEvent& out) noexcept {
+        using target_type = std::remove_reference_t<decltype(Target(out))>;
+        Target(out) = static_cast<target_type>(Value);
+    }
+
+    static void encode(const MarketEvent&, uint8_t*) noexcept {}
+};
+
+namespace detail {
+
+struct Span {
+    size_t offset;
+    size_t end;
+};
+
+template<typename B>
+constexpr bool has_field() noexcept {
+    return !std::is_void_v<typename B::field>;
+}
+
+template<typename... Binds>
+constexpr auto field_spans() noexcept {
+    std::array<Span, (0 + ... + (has_field<Binds>() ? 1 : 0))> spans{};
+    size_t i = 0;
+    auto add = [&]<typename B>() {
+        if constexpr (has_field<B>()) {
+            spans[i++] = {B::field::offset, B::field::end};
+        }
+    };
+    (add.template operator()<Binds>(), ...);
+    return spans;
+}
+
+template<size_t N>
+constexpr bool disjoint(const std::array<Span, N>& spans) noexcept {
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = i + 1; j < N; ++j) {
+            if (spans[i].offset < spans[j].end && spans[j].offset < spans[i].end) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template<size_t N>
+constexpr size_t max_end(const std::array<Span, N>& spans) noexcept {
+    size_t end = 0;
+    for (const Span& s : spans) {
+        end = std::max(end, s.end);
+    }
+    return end;
+}
+
+} // namespace detail
+
+/**
+ * One message of a protocol
+ *
+ * @tparam Key   Value of the protocol's key field identifying this message
+ * @tparam Type  Normalized MarketEvent type it decodes to
+ * @tparam Size  Minimum wire size (bytes from the key field's message start)
+ * @tparam Binds Bind<> / Fill<> entries, in any order
+ */
+template<auto Key, MessageType Type, size_t Size, typename... Binds>
+struct Message {
+    static constexpr auto key = Key;
+    static constexpr MessageType type = Type;
+    static constexpr size_t size = Size;
+    static constexpr auto spans = detail::field_spans<Binds...>();
+
+    static_assert(detail::max_end(spans) <= Size, "field extends past the end of the message");
+    static_assert(detail::disjoint(spans), "message fields overlap");
+
+    static void decode(const uint8_t* msg, MarketEvent& out) noexcept {
+        out.type = Type;
+        (Binds::decode(msg, out), ...);
+    }
+
+    static void encode(const MarketEvent& event, uint8_t* msg) noexcept {
+        (Binds::encode(event, msg), ...);
+    }
+};
+
+enum class DecodeResult : uint8_t {
+    DECODED,    // out holds a normalized event
+    UNKNOWN,    // Key not in the schema (valid but not normalized) - skip
+    TRUNCATED   // Shorter than the message's declared size - malformed
+};
+
+/**
+ * A protocol: key field + the messages it selects between
+ *
+ * @tparam KeyField Field read first to pick the message (type byte, template id)
+ */
+template<typename KeyField, typename... Messages>
+struct Protocol {
+    using key_type = typename KeyField::type;
+
+    static constexpr size_t max_size = std::max({Messages::size...});
+    static constexpr size_t min_size = std::min({Messages::size...});
+
+    static_assert(sizeof...(Messages) > 0, "protocol without messages");
+    static_assert(KeyField::end <= min_size, "key field extends past the shortest message");
+
+    static constexpr bool unique_keys() noexcept {
+        const std::array<key_type, sizeof...(Messages)> keys{static_cast<key_type>(Messages::key)...};
+        for (size_t i = 0; i < keys.size(); ++i) {
+            for (size_t j = i + 1; j < keys.size(); ++j) {
+                if (keys[i] == keys[j]) return false;
+            }
+        }
+        return true;
+    }
+    static_assert(unique_keys(), "two messages share a key");
+
+    static constexpr bool key_disjoint() noexcept {
+        auto clear_of_key = [](const auto& spans) {
+            for (const detail::Span& s : spans) {
+                if (s.offset < KeyField::end && KeyField::offset < s.end) return false;
+            }
+            return true;
+        };
+        return (clear_of_key(Messages::spans) && ...);
+    }
+    static_assert(key_disjoint(), "a message field overlaps the key field");
+
+    /**
+     * Decode one message
+     *
+     * @param msg Start of the message (key field offsets are relative to it)
+     * @param size Bytes available from msg
+     */
+    [[nodiscard]] static DecodeResult decode(const uint8_t* msg, size_t size, MarketEvent& out) noexcept {
+        if (size < KeyField::end) [[unlikely]] {
+            return DecodeResult::TRUNCATED;
+        }
+        const key_type key = KeyField::load(msg);
+        DecodeResult result = DecodeResult::UNKNOWN;
+        (void)((key == static_cast<key_type>(Messages::key) &&
+                (result = decode_as<Messages>(msg, size, out), true)) || ...);
+        return result;
+    }
+
+    /**
+     * Encode event as message M (key included, unbound bytes zeroed)
+     *
+     * @param buffer At least M::size bytes
+     * @return Bytes written
+     */
+    template<typename M>
+    static size_t encode(const MarketEvent& event, uint8_t* buffer) noexcept {
+        static_assert((std::is_same_v<M, Messages> || ...), "message is not part of this protocol");
+        std::memset(buffer, 0, M::size);
+        KeyField::store(buffer, static_cast<key_type>(M::key));
+        M::encode(event, buffer);
+        return M::size;
+    }
+
+private:
+    template<typename M>
+    static DecodeResult decode_as(const uint8_t* msg, size_t size, MarketEvent& out) noexcept {
+        if (size < M::size) [[unlikely]] {
+            return DecodeResult::TRUNCATED;
+        }
+        M::decode(msg, out);
+        return DecodeResult::DECODED;
+    }
+};
+
+/**
+ * Check a schema field against a hand-written packed struct member
+ *   HFT_SCHEMA_MATCHES(Price, MarketDataPacket, payload.trade.price);
+ */
+#define HFT_SCHEMA_MATCHES(F, Struct, member)                                          \
+    static_assert(F::offset == offsetof(Struct, member) &&                              \
+                  F::width == sizeof(std::declval<Struct&>().member),                   \
+                  #F " does not match " #Struct "::" #member)
+
+// ============================================================================
+// NATIVE FORMAT (types.hpp MarketDataPacket)
+// ============================================================================
+
+/**
+ * The internal binary format as a schema
+ * Offsets are from the packet start (12-byte header, payload at 12) and are
+ * checked against the packed structs in types.hpp below.
+ */
+namespace native {
+
+constexpr size_t PAYLOAD = 12;
+
+using MsgType = Field<uint8_t, 0>;
+using Sequence = Field<uint64_t, 4>;
+
+// Fields common to every payload
+using Timestamp = Field<uint64_t, PAYLOAD + 0>;
+using SymbolId = Field<uint32_t, PAYLOAD + 16>;
+
+namespace trade {
+using Price = Field<uint64_t, PAYLOAD + 24>;
+using Quantity = Field<uint32_t, PAYLOAD + 32>;
+using Side = Field<uint8_t, PAYLOAD + 36>;
+}
+
+namespace quote {
+using BidPrice = Field<uint64_t, PAYLOAD + 20>;
+using AskPrice = Field<uint64_t, PAYLOAD + 28>;
+using BidSize = Field<uint32_t, PAYLOAD + 36>;
+using AskSize = Field<uint32_t, PAYLOAD + 40>;
+}
+
+namespace order {
+using OrderId = Field<uint64_t, PAYLOAD + 20>;
+using Price = Field<uint64_t, PAYLOAD + 28>;
+using Quantity = Field<uint32_t, PAYLOAD + 36>;
+using Side = Field<uint8_t, PAYLOAD + 40>;
+}
+
+template<MessageType Type>
+using OrderLayout = Message<static_cast<uint8_t>(Type), Type, PAYLOAD + sizeof(OrderMessage),
+    Bind<Timestamp, HFT_EVENT_FIELD(exchange_timestamp_ns)>,
+    Bind<SymbolId, HFT_EVENT_FIELD(symbol_id)>,
+    Bind<order::OrderId, HFT_EVENT_FIELD(data.order.order_id)>,
+    Bind<order::Price, HFT_EVENT_FIELD(data.order.price)>,
+    Bind<order::Quantity, HFT_EVENT_FIELD(data.order.quantity)>,
+    Bind<order::Side, HFT_EVENT_FIELD(data.order.side)>>;
+
+using Trade = Message<static_cast<uint8_t>(MessageType::TRADE), MessageType::TRADE,
+    PAYLOAD + sizeof(TradeMessage),
+    Bind<Timestamp, HFT_EVENT_FIELD(exchange_timestamp_ns)>,
+    Bind<SymbolId, HFT_EVENT_FIELD(symbol_id)>,
+    Bind<trade::Price, HFT_EVENT_FIELD(data.trade.price)>,
+    Bind<trade::Quantity, HFT_EVENT_FIELD(data.trade.quantity)>,
+    Bind<trade::Side, HFT_EVENT_FIELD(data.trade.side)>>;
+
+using Quote = Message<static_cast<uint8_t>(MessageType::QUOTE), MessageType::QUOTE,
+    PAYLOAD + sizeof(QuoteMessage),
+    Bind<Timestamp, HFT_EVENT_FIELD(exchange_timestamp_ns)>,
+    Bind<SymbolId, HFT_EVENT_FIELD(symbol_id)>,
+    Bind<quote::BidPrice, HFT_EVENT_FIELD(data.quote.bid_price)>,
+    Bind<quote::AskPrice, HFT_EVENT_FIELD(data.quote.ask_price)>,
+    Bind<quote::BidSize, HFT_EVENT_FIELD(data.quote.bid_size)>,
+    Bind<quote::AskSize, HFT_EVENT_FIELD(data.quote.ask_size)>>;
+
+using OrderAdd = OrderLayout<MessageType::ORDER_ADD>;
+using OrderDelete = OrderLayout<MessageType::ORDER_DELETE>;
+using OrderModify = OrderLayout<MessageType::ORDER_MODIFY>;
+
+using Schema = Protocol<MsgType, Trade, Quote, OrderAdd, OrderDelete, OrderModify>;
+
+// The schema and the packed structs describe the same bytes
+HFT_SCHEMA_MATCHES(MsgType, MarketDataPacket, msg_type);
+HFT_SCHEMA_MATCHES(Sequence, MarketDataPacket, packet_sequence);
+HFT_SCHEMA_MATCHES(Timestamp, MarketDataPacket, payload.trade.timestamp_ns);
+HFT_SCHEMA_MATCHES(Timestamp, MarketDataPacket, payload.quote.timestamp_ns);
+HFT_SCHEMA_MATCHES(Timestamp, MarketDataPacket, payload.order.timestamp_ns);
+HFT_SCHEMA_MATCHES(SymbolId, MarketDataPacket, payload.trade.symbol_id);
+HFT_SCHEMA_MATCHES(SymbolId, MarketDataPacket, payload.quote.symbol_id);
+HFT_SCHEMA_MATCHES(SymbolId, MarketDataPacket, payload.order.symbol_id);
+HFT_SCHEMA_MATCHES(trade::Price, MarketDataPacket, payload.trade.price);
+HFT_SCHEMA_MATCHES(trade::Quantity, MarketDataPacket, payload.trade.quantity);
+HFT_SCHEMA_MATCHES(trade::Side, MarketDataPacket, payload.trade.side);
+HFT_SCHEMA_MATCHES(quote::BidPrice, MarketDataPacket, payload.quote.bid_price);
+HFT_SCHEMA_MATCHES(quote::AskPrice, MarketDataPacket, payload.quote.ask_price);
+HFT_SCHEMA_MATCHES(quote::BidSize, MarketDataPacket, payload.quote.bid_size);
+HFT_SCHEMA_MATCHES(quote::AskSize, MarketDataPacket, payload.quote.ask_size);
+HFT_SCHEMA_MATCHES(order::OrderId, MarketDataPacket, payload.order.order_id);
+HFT_SCHEMA_MATCHES(order::Price, MarketDataPacket, payload.order.price);
+HFT_SCHEMA_MATCHES(order::Quantity, MarketDataPacket, payload.order.quantity);
+HFT_SCHEMA_MATCHES(order::Side, MarketDataPacket, payload.order.side);
+
+} // namespace native
+
+} // namespace schema
+
+} // namespace hft
@@ -0,0 +1,529 @@
+#include "types.hpp"
+#include "utils.hpp"
+#include "pcap_reader.hpp"
+#include "sbe_decoder.hpp"
+#include "watchdog.hpp"
+#include "packet_manager.hpp"
+#include "book_snapshot.hpp"
+#include "warmup.hpp"
+#include "symbol_filter.hpp"
+#include "feed_handler_impl.hpp"
+#include "feed_generator.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <vector>
+
+using namespace hft;
+
+namespace hft {
+std::atomic<bool> g_running{true};
+}
+
+static int g_failures = 0;
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            std::fprintf(stderr, "  FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            g_failures++;                                                        \
+        }                                                                        \
+    } while (0)
+
+// ============================================================================
+// PCAP READER
+// ============================================================================
+
+static void put32(std::vector<uint8_t>& out, uint32_t v) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&v);
+    out.insert(out.end(), p, p + 4);
+}
+
+static bool write_temp(const std::vector<uint8_t>& bytes, char* path) {
+    const int fd = mkstemp(path);
+    if (fd < 0) {
+        return false;
+    }
+    const bool ok = write(fd, bytes.data(), bytes.size()) == static_cast<ssize_t>(bytes.size());
+    close(fd);
+    return ok;
+}
+
+/**
+ * EPB whose captured length wraps 28 + caplen in 32 bits: the record must
+ * be skipped, not decoded from the bytes after the block
+ *
+ * Raw IPv4 link type; the 4 data bytes start an IPv4/UDP header that the
+ * following (unknown type) block completes, so a reader that trusts
+ * caplen would return a packet.
+ *
+ * Then the boundary: an EPB whose caplen runs exactly into its own
+ * trailing block length - the 24 data bytes are an IPv4 header and UDP
+ * ports, and only the trailer would complete the UDP header.
+ */
+static void check_pcapng_oversized_caplen() {
+    std::printf("pcapng_oversized_caplen\n");
+    std::vector<uint8_t> file;
+
+    // SHB: type, length, byte-order magic, version 1.0, section length -1, length
+    put32(file, 0x0A0D0D0A);
+    put32(file, 28);
+    put32(file, 0x1A2B3C4D);
+    put32(file, 0x00000001);
+    put32(file, 0xFFFFFFFF);
+    put32(file, 0xFFFFFFFF);
+    put32(file, 28);
+
+    // IDB: link type RAW (101), snaplen
+    put32(file, 0x00000001);
+    put32(file, 20);
+    put32(file, 101);
+    put32(file, 65535);
+    put32(file, 20);
+
+    // EPB: interface 0, timestamp, caplen 0xFFFFFFF0, orig len, 4 data bytes
+    put32(file, 0x00000006);
+    put32(file, 36);
+    put32(file, 0);
+    put32(file, 0);
+    put32(file, 1);
+    put32(file, 0xFFFFFFF0);
+    put32(file, 64);
+    file.insert(file.end(), {0x45, 0x00, 0x00, 0x40});    // IPv4, IHL 5, total length 64
+    put32(file, 36);
+
+    // Unknown block type 0x00001100: its bytes finish the IPv4 header
+    // (protocol UDP at ip[9]) and supply a UDP header
+    put32(file, 0x00001100);
+    put32(file, 32);
+    put32(file, 0x0100000A);                               // ip[16..19] dst 10.0.0.1
+    put32(file, 0);
+    put32(file, 0x983A983A);                               // UDP ports 15000 -> 15000
+    put32(file, 0x00002000);                               // UDP length 32
+    put32(file, 0);
+    put32(file, 32);
+
+    // EPB, 56 bytes: caplen 28 = 24 data bytes + the trailer
+    put32(file, 0x00000006);
+    put32(file, 56);
+    put32(file, 0);
+    put32(file, 0);
+    put32(file, 1);
+    put32(file, 28);
+    put32(file, 28);
+    file.insert(file.end(), {0x45, 0x00, 0x00, 0x1C, 0x00, 0x00, 0x00, 0x00,
+                             0x40, 0x11, 0x00, 0x00, 0x0A, 0x00, 0x00, 0x02,
+                             0x0A, 0x00, 0x00, 0x01, 0x3A, 0x98, 0x3A, 0x98});
+    put32(file, 56);
+
+    char path[] = "/tmp/hft_check_XXXXXX";
+    CHECK(write_temp(file, path));
+
+    PcapReader reader;
+    CHECK(reader.open(path));
+    CapturedPacket pkt{};
+    CHECK(!reader.next(pkt));
+    CHECK(reader.records_read() == 2);
+    CHECK(reader.packets_matched() == 0);
+    unlink(path);
+}
+
+/**
+ * Simple packet block shorter than its own header - no packet, no wrap
+ * in the available-length computation
+ */
+static void check_pcapng_short_spb() {
+    std::printf("pcapng_short_spb\n");
+    std::vector<uint8_t> file;
+    put32(file, 0x0A0D0D0A);
+    put32(file, 28);
+    put32(file, 0x1A2B3C4D);
+    put32(file, 0x00000001);
+    put32(file, 0xFFFFFFFF);
+    put32(file, 0xFFFFFFFF);
+    put32(file, 28);
+
+    put32(file, 0x00000001);
+    put32(file, 20);
+    put32(file, 101);
+    put32(file, 65535);
+    put32(file, 20);
+
+    put32(file, 0x00000003);                               // SPB, 12 bytes: no original length field
+    put32(file, 12);
+    put32(file, 12);
+
+    char path[] = "/tmp/hft_check_XXXXXX";
+    CHECK(write_temp(file, path));
+
+    PcapReader reader;
+    CHECK(reader.open(path));
+    CapturedPacket pkt{};
+    CHECK(!reader.next(pkt));
+    CHECK(reader.packets_matched() == 0);
+    unlink(path);
+}
+
+// ============================================================================
+// SBE DECODER
+// ============================================================================
+
+/**
+ * Negative PRICE9 mantissas and sizes have no unsigned MarketEvent
+ * representation - the entries are dropped as malformed, valid entries
+ * around them still decode
+ */
+static void check_sbe_negative_price_and_size() {
+    std::printf("sbe_negative_price_and_size\n");
+    SbePacketBuilder builder;
+    builder.begin(1, 0);
+    CHECK(builder.begin_book(0));
+    CHECK(builder.add_book_entry(7, 1000000, 100, 1, 'B', 0));
+    CHECK(builder.add_book_entry(7, static_cast<uint64_t>(-1), 100, 1, 'B', 0));  // -0.0001
+    CHECK(builder.add_book_entry(7, 1000000, -5, 1, 'S', 0));
+    CHECK(builder.begin_trades(0));
+    CHECK(builder.add_trade_entry(7, static_cast<uint64_t>(-1), 10, 'B', 1));
+    CHECK(builder.add_trade_entry(7, 1000000, -10, 'S', 2));
+    CHECK(builder.add_trade_entry(7, 1000100, 10, 'S', 3));
+
+    SbeDecoder decoder;
+    std::vector<MarketEvent> events;
+    const size_t emitted = decoder.decode_packet(builder.data(), builder.size(), 0,
+                                                 [&](const MarketEvent& e) { events.push_back(e); });
+    CHECK(emitted == 2);
+    CHECK(decoder.malformed() == 4);
+    CHECK(events.size() == 2);
+    if (events.size() == 2) {
+        CHECK(events[0].type == MessageType::BOOK_LEVEL);
+        CHECK(events[0].data.level.price == 1000000);
+        CHECK(events[0].data.level.quantity == 100);
+        CHECK(events[1].type == MessageType::TRADE);
+        CHECK(events[1].data.trade.price == 1000100);
+        CHECK(events[1].data.trade.quantity == 10);
+    }
+}
+
+// ============================================================================
+// WATCHDOG
+// ============================================================================
+
+/**
+ * Stalls that end without the heartbeat moving again - the thread
+ * detaches mid-stall, or the watchdog stops first - still count toward
+ * max_stall_us. Driven with synthetic TSC values: at 0.001 GHz one tick
+ * is one microsecond.
+ */
+static void check_watchdog_open_stalls() {
+    std::printf("watchdog_open_stalls\n");
+    constexpr double TSC_GHZ = 0.001;
+    constexpr uint64_t STALL_TICKS = 100;
+    WatchdogConfig cfg;
+    cfg.capture_stack = false;
+
+    // Detached mid-stall
+    {
+        Heartbeat heartbeat;
+        Watchdog watchdog(cfg);
+        CHECK(watchdog.watch(heartbeat));
+        heartbeat.attach("Detaching");
+        watchdog.check(1000, STALL_TICKS, TSC_GHZ);
+        watchdog.check(1200, STALL_TICKS, TSC_GHZ);
+        CHECK(watchdog.stalls() == 1);
+        heartbeat.detach();
+        watchdog.check(1500, STALL_TICKS, TSC_GHZ);
+        CHECK(watchdog.max_stall_us() == 500);
+        watchdog.finish(2000, TSC_GHZ);
+        CHECK(watchdog.max_stall_us() == 500);     // Already closed on detach
+    }
+
+    // Still stalled when the watchdog stops
+    {
+        Heartbeat heartbeat;
+        Watchdog watchdog(cfg);
+        CHECK(watchdog.watch(heartbeat));
+        heartbeat.attach("Hung");
+        watchdog.check(1000, STALL_TICKS, TSC_GHZ);
+        watchdog.check(1300, STALL_TICKS, TSC_GHZ);
+        CHECK(watchdog.stalls() == 1);
+        watchdog.finish(1800, TSC_GHZ);
+        CHECK(watchdog.max_stall_us() == 800);
+        heartbeat.detach();
+    }
+}
+
+// ============================================================================
+// GENERATOR
+// ============================================================================
+
+/**
+ * A microburst adds its packets on top of the sustained rate: time spent
+ * draining it still refills the bucket. Synthetic TSC at 0.001 GHz and
+ * 1M/s = one token per tick.
+ */
+static void check_token_bucket_rate_after_burst() {
+    std::printf("token_bucket_rate_after_burst\n");
+    TscTokenBucket bucket(1000000.0, 32, 0.001);
+    uint64_t now = LatencyTracker::rdtsc();
+    (void)bucket.acquire(1000, now);                // Sync the clock, drain the initial fill
+    bucket.add(1000);
+    uint64_t taken = 0;
+    for (int step = 0; step < 200; ++step) {
+        now += 10;                                  // 10 tokens of refill per step
+        taken += bucket.acquire(15, now);
+    }
+    CHECK(taken == 3000);                           // 2000 refill + 1000 burst
+}
+
+/**
+ * Scenario configs MarketScenario cannot run are rejected up front
+ */
+static void check_scenario_config_valid() {
+    std::printf("scenario_config_valid\n");
+    ScenarioConfig cfg;
+    CHECK(cfg.valid());
+    cfg.num_symbols = 0;
+    CHECK(!cfg.valid());
+    cfg = ScenarioConfig{};
+    cfg.branching_ratio = 1.0;
+    CHECK(!cfg.valid());
+}
+
+// ============================================================================
+// WARMUP
+// ============================================================================
+
+/**
+ * Several feeds warming into one engine: LIVE only when the last finishes
+ */
+static void check_warmup_last_feed_goes_live() {
+    std::printf("warmup_last_feed_goes_live\n");
+    begin_warmup(3);
+    CHECK(!is_live());
+    CHECK(!finish_warmup());
+    CHECK(!finish_warmup());
+    CHECK(!is_live());
+    CHECK(finish_warmup());
+    CHECK(is_live());
+}
+
+// ============================================================================
+// SYMBOL FILTER
+// ============================================================================
+
+/**
+ * Handler reading a filter with no housekeeper attached: one poll
+ * iteration is a quiescent state, so replaced sets are reclaimed, and an
+ * offline reader never holds reclaim up again
+ */
+static void check_filter_reader_quiesces_without_housekeeper() {
+    std::printf("filter_reader_quiesces_without_housekeeper\n");
+    auto queue = std::make_unique<SPSCQueue<MarketEvent, 65536>>();
+    FeedHandlerStats stats;
+    auto handler = std::make_unique<FeedHandler>(*queue, stats);
+    SymbolFilter filter;
+    CHECK(handler->set_symbol_filter(&filter));
+
+    filter.edit(64, [](SubscriptionSet& set) { set.subscribe(1); });
+    filter.edit(64, [](SubscriptionSet& set) { set.subscribe(2); });
+    CHECK(filter.reclaim() == 0);                 // Reader has not moved past the swap
+    (void)handler->poll_once(LatencyTracker::rdtsc());
+    CHECK(filter.reclaim() == 1);
+
+    handler->filter_offline();
+    filter.edit(64, [](SubscriptionSet& set) { set.subscribe(3); });
+    CHECK(filter.reclaim() == 0);                 // Freed by edit() itself
+    CHECK(filter.reclaimed() == 2);
+}
+
+// ============================================================================
+// WARM RESTART
+// ============================================================================
+
+/**
+ * First packet after resume_from(): a feed that restarted its sequence
+ * (far below the resume point) is taken as from INITIAL, not dropped as
+ * old; one at or past the resume point, or a late duplicate just below
+ * it, keeps the resume point
+ */
+static void check_resume_below_restarted_feed() {
+    std::printf("resume_below_restarted_feed\n");
+    {
+        PacketManager pm;
+        pm.resume_from(61);
+        CHECK(pm.process_packet(1));
+        CHECK(pm.get_state() == FeedState::LIVE);
+        CHECK(pm.get_next_expected() == 2);
+        CHECK(pm.process_packet(2));
+        CHECK(pm.get_stats().resumes_abandoned == 1);
+    }
+    {
+        PacketManager pm;
+        pm.resume_from(61);
+        CHECK(pm.process_packet(61));
+        CHECK(pm.get_next_expected() == 62);
+        CHECK(!pm.process_packet(1));             // Resume point already confirmed
+        CHECK(pm.get_stats().resumes_abandoned == 0);
+    }
+    {
+        PacketManager pm;
+        pm.resume_from(61);
+        CHECK(!pm.process_packet(58));            // Late duplicate within the slack
+        CHECK(pm.get_next_expected() == 61);
+        CHECK(pm.get_stats().resumes_abandoned == 0);
+    }
+}
+
+/**
+ * Gap at the resume point (packets missed while down): recovered when
+ * retransmission is available, otherwise - or once the last retry has
+ * timed out - the feed starts again from INITIAL rather than going STALE
+ */
+static void check_resume_unrecoverable_gap() {
+    std::printf("resume_unrecoverable_gap\n");
+    {
+        PacketManager pm;
+        pm.set_gap_recovery(false);
+        pm.resume_from(61);
+        CHECK(pm.process_packet(70));
+        CHECK(pm.get_state() == FeedState::LIVE);
+        CHECK(pm.get_next_expected() == 71);
+        CHECK(pm.get_stats().resumes_abandoned == 1);
+    }
+    {
+        PacketManager pm;
+        pm.resume_from(61);
+        CHECK(pm.process_packet(5000));           // Beyond MAX_GAP_SIZE
+        CHECK(pm.get_state() == FeedState::LIVE);
+        CHECK(pm.get_next_expected() == 5001);
+        CHECK(pm.get_stats().resumes_abandoned == 1);
+    }
+    {
+        const uint8_t payload[1] = {0};
+        PacketManager pm;
+        pm.resume_from(61);
+        CHECK(!pm.process_packet(70, payload, sizeof(payload), 0));
+        CHECK(pm.get_state() == FeedState::RECOVERING);
+        uint64_t now = 0;
+        for (int i = 0; i < 5 && pm.get_state() == FeedState::RECOVERING; ++i) {
+            now += 2000000000ULL;                   // Past GAP_TIMEOUT_NS each pass
+            pm.periodic_maintenance(now);
+        }
+        CHECK(pm.get_state() == FeedState::INITIAL);
+        CHECK(pm.get_stats().resumes_abandoned == 1);
+        CHECK(pm.process_packet(80));
+        CHECK(pm.get_state() == FeedState::LIVE);
+    }
+    {
+        PacketManager pm;                           // Gap after the resume point was confirmed
+        pm.resume_from(61);
+        CHECK(pm.process_packet(61));
+        CHECK(!pm.process_packet(5000));
+        CHECK(pm.get_state() == FeedState::STALE);
+        CHECK(pm.get_stats().resumes_abandoned == 0);
+    }
+}
+
+/**
+ * A snapshot from another session, or older than max_age_ns, is a cold
+ * start; a fresh one from this session is restored
+ */
+static void check_snapshot_session_and_age() {
+    std::printf("snapshot_session_and_age\n");
+    char path[] = "/tmp/hft_check_XXXXXX";
+    const int fd = mkstemp(path);
+    CHECK(fd >= 0);
+    close(fd);
+
+    BookSnapshotConfig cfg;
+    cfg.path = path;
+    cfg.capacity = 64;
+    cfg.session = 20261016;
+    {
+        BookSnapshot snapshot(cfg);
+        CHECK(snapshot.open());
+        CHECK(!snapshot.restored());
+        snapshot.checkpoint();
+    }
+    {
+        BookSnapshot snapshot(cfg);
+        CHECK(snapshot.open());
+        CHECK(snapshot.restored());
+    }
+    {
+        BookSnapshotConfig aged = cfg;
+        aged.max_age_ns = 1;
+        usleep(1000);
+        BookSnapshot snapshot(aged);
+        CHECK(snapshot.open());
+        CHECK(!snapshot.restored());
+        CHECK(std::strcmp(snapshot.cold_reason(), "image too old") == 0);
+    }
+    {
+        BookSnapshot snapshot(cfg);                // Cold start above re-initialized the file
+        CHECK(snapshot.open());
+        CHECK(!snapshot.restored());
+        snapshot.checkpoint();
+    }
+    {
+        BookSnapshotConfig next_day = cfg;
+        next_day.session = 20261017;
+        BookSnapshot snapshot(next_day);
+        CHECK(snapshot.open());
+        CHECK(!snapshot.restored());
+        CHECK(std::strcmp(snapshot.cold_reason(), "session mismatch") == 0);
+    }
+    unlink(path);
+}
+
+/**
+ * capture_stack on but no handler installed: the stall is reported
+ * without signalling the thread (SIGUSR2's default action would end the
+ * process here)
+ */
+static void check_watchdog_no_capture_handler() {
+    std::printf("watchdog_no_capture_handler\n");
+    Heartbeat heartbeat;
+    Watchdog watchdog;
+    CHECK(watchdog.watch(heartbeat));
+    heartbeat.attach("Uncaptured");
+    watchdog.check(1000, 100, 0.001);
+    watchdog.check(1200, 100, 0.001);
+    CHECK(watchdog.stalls() == 1);
+    CHECK(watchdog.stacks_captured() == 0);
+    heartbeat.detach();
+    watchdog.check(1300, 100, 0.001);
+}
+
+/**
+ * REGRESSION CHECKS
+ *
+ * Edge cases the benchmarks and the generator never produce: corrupt
+ * captures, stalls that never resume and the like. Exit code is non-zero
+ * if any check fails.
+ *
+ * Usage:
+ *   ./regression_checks      (or: make check)
+ */
+int main() {
+    check_pcapng_oversized_caplen();
+    check_pcapng_short_spb();
+    check_sbe_negative_price_and_size();
+    check_watchdog_open_stalls();
+    check_watchdog_no_capture_handler();
+    check_token_bucket_rate_after_burst();
+    check_scenario_config_valid();
+    check_warmup_last_feed_goes_live();
+    check_filter_reader_quiesces_without_housekeeper();
+    check_resume_below_restarted_feed();
+    check_resume_unrecoverable_gap();
+    check_snapshot_session_and_age();
+
+    if (g_failures > 0) {
+        std::printf("[Checks] %d failed\n", g_failures);
+        return 1;
+    }
+    std::printf("[Checks] All passed\n");
+    return 0;
+}
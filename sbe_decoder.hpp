@@ -0,0 +1,529 @@
+#pragma once
+
+#include "types.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+namespace hft {
+
+/**
+ * SBE (Simple Binary Encoding) - CME MDP 3.0 style incremental feed
+ *
+ * Wire format (all integers little-endian):
+ *
+ *   Packet header (12 bytes)
+ *     MsgSeqNum u32 | SendingTime u64
+ *   then one or more messages
+ *     MsgSize u16 (includes itself)
+ *     SBE header: blockLength u16 | templateId u16 | schemaId u16 | version u16
+ *     root block (blockLength bytes)
+ *     repeating groups, each
+ *       group header (blockLength u16 | numInGroup u8, 3 bytes; or the
+ *       8-byte variant with numInGroup at offset 7)
+ *       numInGroup entries of blockLength bytes
+ *
+ * Schema evolution: newer versions append fields to blocks, so root and
+ * entry strides always come from the wire blockLength, never sizeof().
+ *
+ * MsgSeqNum numbers packets (count = 1 in PacketManager terms).
+ * Prices are PRICE9 (int64 mantissa, exponent -9) and are normalized to
+ * 4 implied decimals, the same units ITCH uses. The MarketEvent price and
+ * quantity are unsigned, so entries with a negative price (calendar
+ * spreads) or negative size are rejected and counted as malformed.
+ */
+namespace sbe {
+
+template<typename T>
+inline T load_le(const uint8_t* p) noexcept {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+template<typename T>
+inline void store_le(uint8_t* p, T v) noexcept {
+    std::memcpy(p, &v, sizeof(T));
+}
+
+constexpr size_t PACKET_HEADER_SIZE = 12;
+constexpr size_t MESSAGE_SIZE_FIELD = 2;
+constexpr size_t MESSAGE_HEADER_SIZE = 8;
+constexpr size_t GROUP_HEADER_SIZE = 3;
+constexpr size_t GROUP_HEADER_8BYTE_SIZE = 8;
+
+constexpr uint16_t MDP3_SCHEMA_ID = 1;
+constexpr uint16_t MDP3_SCHEMA_VERSION = 9;
+
+constexpr uint16_t TEMPLATE_BOOK = 46;          // MDIncrementalRefreshBook
+constexpr uint16_t TEMPLATE_TRADE_SUMMARY = 48; // MDIncrementalRefreshTradeSummary
+
+constexpr uint16_t ROOT_BLOCK_LENGTH = 11;      // TransactTime u64 + MatchEventIndicator u8 + pad
+constexpr uint16_t BOOK_ENTRY_LENGTH = 32;
+constexpr uint16_t TRADE_ENTRY_LENGTH = 32;
+constexpr uint16_t BOOK_ORDER_ENTRY_LENGTH = 24;
+constexpr uint16_t TRADE_ORDER_ENTRY_LENGTH = 16;
+
+constexpr int64_t PRICE9_TO_PRICE4 = 100000;
+
+/**
+ * Packet header flyweight
+ */
+class PacketHeader {
+private:
+    const uint8_t* p_;
+
+public:
+    explicit PacketHeader(const uint8_t* p) noexcept : p_(p) {}
+    [[nodiscard]] uint32_t msg_seq_num() const noexcept { return load_le<uint32_t>(p_); }
+    [[nodiscard]] uint64_t sending_time() const noexcept { return load_le<uint64_t>(p_ + 4); }
+};
+
+/**
+ * SBE message header flyweight (points just past MsgSize)
+ */
+class MessageHeader {
+private:
+    const uint8_t* p_;
+
+public:
+    explicit MessageHeader(const uint8_t* p) noexcept : p_(p) {}
+    [[nodiscard]] uint16_t block_length() const noexcept { return load_le<uint16_t>(p_); }
+    [[nodiscard]] uint16_t template_id() const noexcept { return load_le<uint16_t>(p_ + 2); }
+    [[nodiscard]] uint16_t schema_id() const noexcept { return load_le<uint16_t>(p_ + 4); }
+    [[nodiscard]] uint16_t version() const noexcept { return load_le<uint16_t>(p_ + 6); }
+};
+
+/**
+ * MDIncrementalRefreshBook NoMDEntries entry
+ * MDEntryPx i64 @0, MDEntrySize i32 @8, SecurityID i32 @12, RptSeq u32 @16,
+ * NumberOfOrders i32 @20, MDPriceLevel u8 @24, MDUpdateAction u8 @25,
+ * MDEntryType char @26
+ */
+class BookEntry {
+private:
+    const uint8_t* p_;
+
+public:
+    explicit BookEntry(const uint8_t* p) noexcept : p_(p) {}
+    [[nodiscard]] int64_t price_mantissa() const noexcept { return load_le<int64_t>(p_); }
+    [[nodiscard]] int32_t size() const noexcept { return load_le<int32_t>(p_ + 8); }
+    [[nodiscard]] int32_t security_id() const noexcept { return load_le<int32_t>(p_ + 12); }
+    [[nodiscard]] uint32_t rpt_seq() const noexcept { return load_le<uint32_t>(p_ + 16); }
+    [[nodiscard]] int32_t number_of_orders() const noexcept { return load_le<int32_t>(p_ + 20); }
+    [[nodiscard]] uint8_t price_level() const noexcept { return p_[24]; }
+    [[nodiscard]] uint8_t update_action() const noexcept { return p_[25]; }     // 0 new, 1 change, 2 delete
+    [[nodiscard]] char entry_type() const noexcept { return static_cast<char>(p_[26]); }  // '0' bid, '1' offer
+};
+
+/**
+ * MDIncrementalRefreshTradeSummary NoMDEntries entry
+ * MDEntryPx i64 @0, MDEntrySize i32 @8, SecurityID i32 @12, RptSeq u32 @16,
+ * NumberOfOrders i32 @20, AggressorSide u8 @24, MDUpdateAction u8 @25,
+ * MDTradeEntryID u32 @26
+ */
+class TradeEntry {
+private:
+    const uint8_t* p_;
+
+public:
+    explicit TradeEntry(const uint8_t* p) noexcept : p_(p) {}
+    [[nodiscard]] int64_t price_mantissa() const noexcept { return load_le<int64_t>(p_); }
+    [[nodiscard]] int32_t size() const noexcept { return load_le<int32_t>(p_ + 8); }
+    [[nodiscard]] int32_t security_id() const noexcept { return load_le<int32_t>(p_ + 12); }
+    [[nodiscard]] uint32_t rpt_seq() const noexcept { return load_le<uint32_t>(p_ + 16); }
+    [[nodiscard]] uint8_t aggressor_side() const noexcept { return p_[24]; }    // 0 none, 1 buy, 2 sell
+    [[nodiscard]] uint32_t trade_entry_id() const noexcept { return load_le<uint32_t>(p_ + 26); }
+};
+
+/**
+ * Repeating group flyweight - iterates entries in place
+ *
+ * Bounds are checked once, on construction: if the declared entries don't
+ * fit in the message the group is invalid and iterates nothing.
+ *
+ * @tparam Entry Entry flyweight (constructible from const uint8_t*)
+ * @tparam HeaderSize 3 (groupSize) or 8 (groupSize8Byte)
+ */
+template<typename Entry, size_t HeaderSize = GROUP_HEADER_SIZE>
+class Group {
+private:
+    const uint8_t* entries_{nullptr};
+    const uint8_t* end_{nullptr};
+    uint16_t block_length_{0};
+    uint8_t count_{0};
+    bool valid_{false};
+
+public:
+    class iterator {
+    private:
+        const uint8_t* p_;
+        uint16_t stride_;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Entry;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Entry;
+
+        iterator(const uint8_t* p, uint16_t stride) noexcept : p_(p), stride_(stride) {}
+        Entry operator*() const noexcept { return Entry(p_); }
+        iterator& operator++() noexcept { p_ += stride_; return *this; }
+        bool operator!=(const iterator& other) const noexcept { return p_ != other.p_; }
+        bool operator==(const iterator& other) const noexcept { return p_ == other.p_; }
+    };
+
+    /**
+     * @param p Group header
+     * @param limit End of the enclosing message
+     */
+    Group(const uint8_t* p, const uint8_t* limit) noexcept {
+        if (limit - p < static_cast<ptrdiff_t>(HeaderSize)) {
+            return;
+        }
+        block_length_ = load_le<uint16_t>(p);
+        count_ = p[HeaderSize - 1];
+        entries_ = p + HeaderSize;
+        const size_t bytes = static_cast<size_t>(block_length_) * count_;
+        valid_ = static_cast<size_t>(limit - entries_) >= bytes;
+        if (!valid_) {
+            count_ = 0;
+        }
+        end_ = valid_ ? entries_ + bytes : entries_;
+    }
+
+    [[nodiscard]] bool valid() const noexcept { return valid_; }
+    [[nodiscard]] uint8_t count() const noexcept { return count_; }
+    [[nodiscard]] uint16_t block_length() const noexcept { return block_length_; }
+
+    /** First byte after this group - where the next group header starts */
+    [[nodiscard]] const uint8_t* next() const noexcept { return end_; }
+
+    [[nodiscard]] iterator begin() const noexcept { return iterator(entries_, block_length_); }
+    [[nodiscard]] iterator end() const noexcept { return iterator(end_, block_length_); }
+};
+
+/** Caller must have rejected negative mantissas - the result is unsigned */
+inline uint64_t to_price4(int64_t mantissa) noexcept {
+    return static_cast<uint64_t>(mantissa / PRICE9_TO_PRICE4);
+}
+
+} // namespace sbe
+
+/**
+ * MDP3-style SBE Decoder
+ *
+ * Zero-copy: every field is read through a flyweight straight out of the
+ * packet buffer, repeating groups are walked in place, and each entry is
+ * normalized directly into the MarketEvent handed to the sink. Nothing
+ * is copied into intermediate structs.
+ *
+ * Book entries become BOOK_LEVEL events (one per entry), trade summary
+ * entries become TRADE events. Other templates and schemas are skipped.
+ *
+ * Not thread-safe - one decoder per feed thread.
+ */
+class SbeDecoder {
+private:
+    uint64_t messages_{0};
+    uint64_t entries_{0};
+    uint64_t skipped_{0};       // Other templates / schemas
+    uint64_t malformed_{0};     // Truncated messages/groups, negative price or size
+    uint64_t filtered_{0};      // Entries for unsubscribed securities
+
+public:
+    /**
+     * Decode every message of a packet
+     *
+     * @param sink Called with each normalized event (recv timestamp filled in)
+     * @param accept accept(security_id) == false drops an entry before it is normalized
+     * @return Number of events emitted
+     */
+    template<typename Sink, typename Accept = AllSymbols>
+    size_t decode_packet(const uint8_t* data, size_t size, uint64_t recv_tsc, Sink&& sink,
+                         const Accept& accept = Accept{}) noexcept {
+        if (size < sbe::PACKET_HEADER_SIZE) {
+            malformed_++;
+            return 0;
+        }
+
+        const uint8_t* p = data + sbe::PACKET_HEADER_SIZE;
+        const uint8_t* const end = data + size;
+        size_t events = 0;
+
+        while (end - p >= static_cast<ptrdiff_t>(sbe::MESSAGE_SIZE_FIELD)) {
+            const uint16_t msg_size = sbe::load_le<uint16_t>(p);
+            if (msg_size < sbe::MESSAGE_SIZE_FIELD + sbe::MESSAGE_HEADER_SIZE ||
+                end - p < msg_size) [[unlikely]] {
+                malformed_++;
+                break;
+            }
+
+            const uint8_t* const msg_end = p + msg_size;
+            const sbe::MessageHeader header(p + sbe::MESSAGE_SIZE_FIELD);
+            const uint8_t* const root = p + sbe::MESSAGE_SIZE_FIELD + sbe::MESSAGE_HEADER_SIZE;
+            messages_++;
+
+            if (header.schema_id() != sbe::MDP3_SCHEMA_ID ||
+                header.block_length() < sbe::ROOT_BLOCK_LENGTH ||
+                msg_end - root < header.block_length()) {
+                skipped_++;
+            } else if (header.template_id() == sbe::TEMPLATE_BOOK) {
+                events += decode_book(root, header.block_length(), msg_end, recv_tsc, sink, accept);
+            } else if (header.template_id() == sbe::TEMPLATE_TRADE_SUMMARY) {
+                events += decode_trades(root, header.block_length(), msg_end, recv_tsc, sink, accept);
+            } else {
+                skipped_++;
+            }
+            p = msg_end;
+        }
+        return events;
+    }
+
+    [[nodiscard]] uint64_t messages() const noexcept { return messages_; }
+    [[nodiscard]] uint64_t entries() const noexcept { return entries_; }
+    [[nodiscard]] uint64_t skipped() const noexcept { return skipped_; }
+    [[nodiscard]] uint64_t malformed() const noexcept { return malformed_; }
+    [[nodiscard]] uint64_t filtered() const noexcept { return filtered_; }
+
+private:
+    template<typename Sink, typename Accept>
+    size_t decode_book(const uint8_t* root, uint16_t block_length, const uint8_t* msg_end,
+                       uint64_t recv_tsc, Sink& sink, const Accept& accept) noexcept {
+        const uint64_t transact_time = sbe::load_le<uint64_t>(root);
+        const sbe::Group<sbe::BookEntry> group(root + block_length, msg_end);
+        if (!group.valid() || group.block_length() < sbe::BOOK_ENTRY_LENGTH) [[unlikely]] {
+            malformed_++;
+            return 0;
+        }
+
+        size_t events = 0;
+        for (const sbe::BookEntry entry : group) {
+            const char type = entry.entry_type();
+            if (type != '0' && type != '1') {
+                continue;   // Implied / stats entries - not book levels
+            }
+            const int64_t mantissa = entry.price_mantissa();
+            const int32_t size = entry.size();
+            if (mantissa < 0 || size < 0) [[unlikely]] {
+                malformed_++;   // Unrepresentable in the unsigned MarketEvent
+                continue;
+            }
+            const uint32_t security = static_cast<uint32_t>(entry.security_id());
+            if (!accept(security)) {
+                filtered_++;
+                continue;
+            }
+            MarketEvent event{};
+            event.recv_timestamp_ns = recv_tsc;
+            event.exchange_timestamp_ns = transact_time;
+            event.symbol_id = security;
+            event.type = MessageType::BOOK_LEVEL;
+            event.data.level.price = sbe::to_price4(mantissa);
+            event.data.level.quantity = static_cast<uint32_t>(size);
+            event.data.level.level = entry.price_level();
+            event.data.level.side = type == '0' ? 'B' : 'S';
+            event.data.level.action = entry.update_action();
+            sink(event);
+            events++;
+        }
+        entries_ += group.count();
+        // NoOrderIDEntries (groupSize8Byte) follows - not needed for levels
+        return events;
+    }
+
+    template<typename Sink, typename Accept>
+    size_t decode_trades(const uint8_t* root, uint16_t block_length, const uint8_t* msg_end,
+                         uint64_t recv_tsc, Sink& sink, const Accept& accept) noexcept {
+        const uint64_t transact_time = sbe::load_le<uint64_t>(root);
+        const sbe::Group<sbe::TradeEntry> group(root + block_length, msg_end);
+        if (!group.valid() || group.block_length() < sbe::TRADE_ENTRY_LENGTH) [[unlikely]] {
+            malformed_++;
+            return 0;
+        }
+
+        size_t events = 0;
+        for (const sbe::TradeEntry entry : group) {
+            const int64_t mantissa = entry.price_mantissa();
+            const int32_t size = entry.size();
+            if (mantissa < 0 || size < 0) [[unlikely]] {
+                malformed_++;   // Unrepresentable in the unsigned MarketEvent
+                continue;
+            }
+            const uint32_t security = static_cast<uint32_t>(entry.security_id());
+            if (!accept(security)) {
+                filtered_++;
+                continue;
+            }
+            MarketEvent event{};
+            event.recv_timestamp_ns = recv_tsc;
+            event.exchange_timestamp_ns = transact_time;
+            event.symbol_id = security;
+            event.type = MessageType::TRADE;
+            event.data.trade.price = sbe::to_price4(mantissa);
+            event.data.trade.quantity = static_cast<uint32_t>(size);
+            const uint8_t aggressor = entry.aggressor_side();
+            event.data.trade.side = aggressor == 1 ? 'B' : aggressor == 2 ? 'S' : ' ';
+            sink(event);
+            events++;
+        }
+        entries_ += group.count();
+        return events;
+    }
+};
+
+/**
+ * SBE packet builder - book and trade summary messages
+ *
+ * For warmup traffic and benchmarks. Each message gets its entry group
+ * plus an empty order-id group so decoders exercise group skipping.
+ *
+ *   builder.begin(seq, now);
+ *   builder.begin_book(now);
+ *   builder.add_book_entry(...);  // repeat
+ *   builder.begin_trades(now);
+ *   builder.add_trade_entry(...);
+ *   send(builder.data(), builder.size());
+ */
+class SbePacketBuilder {
+public:
+    static constexpr size_t MAX_PACKET_SIZE = 1400;
+
+private:
+    uint8_t buffer_[MAX_PACKET_SIZE];
+    size_t size_{0};
+    size_t message_start_{0};   // 0 = no open message
+    size_t group_header_{0};
+    uint8_t group_count_{0};
+    uint16_t entry_length_{0};
+
+public:
+    SbePacketBuilder() noexcept {
+        begin(1, 0);
+    }
+
+    void begin(uint32_t msg_seq_num, uint64_t sending_time) noexcept {
+        sbe::store_le<uint32_t>(buffer_, msg_seq_num);
+        sbe::store_le<uint64_t>(buffer_ + 4, sending_time);
+        size_ = sbe::PACKET_HEADER_SIZE;
+        message_start_ = 0;
+    }
+
+    bool begin_book(uint64_t transact_time) noexcept {
+        return begin_message(sbe::TEMPLATE_BOOK, transact_time, sbe::BOOK_ENTRY_LENGTH);
+    }
+
+    bool begin_trades(uint64_t transact_time) noexcept {
+        return begin_message(sbe::TEMPLATE_TRADE_SUMMARY, transact_time, sbe::TRADE_ENTRY_LENGTH);
+    }
+
+    /**
+     * @param price4 Price in 4-decimal units (stored as PRICE9)
+     * @param side 'B' or 'S'
+     * @param action 0 new, 1 change, 2 delete
+     */
+    bool add_book_entry(int32_t security_id, uint64_t price4, int32_t size, uint8_t level,
+                        char side, uint8_t action, uint32_t rpt_seq = 0) noexcept {
+        uint8_t* p = add_entry();
+        if (!p) return false;
+        sbe::store_le<int64_t>(p, static_cast<int64_t>(price4) * sbe::PRICE9_TO_PRICE4);
+        sbe::store_le<int32_t>(p + 8, size);
+        sbe::store_le<int32_t>(p + 12, security_id);
+        sbe::store_le<uint32_t>(p + 16, rpt_seq);
+        sbe::store_le<int32_t>(p + 20, 1);
+        p[24] = level;
+        p[25] = action;
+        p[26] = side == 'B' ? '0' : '1';
+        return true;
+    }
+
+    /**
+     * @param aggressor 'B', 'S' or ' ' (none)
+     */
+    bool add_trade_entry(int32_t security_id, uint64_t price4, int32_t size, char aggressor,
+                         uint32_t trade_id, uint32_t rpt_seq = 0) noexcept {
+        uint8_t* p = add_entry();
+        if (!p) return false;
+        sbe::store_le<int64_t>(p, static_cast<int64_t>(price4) * sbe::PRICE9_TO_PRICE4);
+        sbe::store_le<int32_t>(p + 8, size);
+        sbe::store_le<int32_t>(p + 12, security_id);
+        sbe::store_le<uint32_t>(p + 16, rpt_seq);
+        sbe::store_le<int32_t>(p + 20, 1);
+        p[24] = aggressor == 'B' ? 1 : aggressor == 'S' ? 2 : 0;
+        p[25] = 0;
+        sbe::store_le<uint32_t>(p + 26, trade_id);
+        return true;
+    }
+
+    /** Finished packet - closes the open message */
+    [[nodiscard]] const uint8_t* data() noexcept {
+        end_message();
+        return buffer_;
+    }
+
+    [[nodiscard]] size_t size() noexcept {
+        end_message();
+        return size_;
+    }
+
+private:
+    bool begin_message(uint16_t template_id, uint64_t transact_time, uint16_t entry_length) noexcept {
+        end_message();
+        const size_t needed = sbe::MESSAGE_SIZE_FIELD + sbe::MESSAGE_HEADER_SIZE +
+                              sbe::ROOT_BLOCK_LENGTH + sbe::GROUP_HEADER_SIZE +
+                              sbe::GROUP_HEADER_8BYTE_SIZE;
+        if (size_ + needed > MAX_PACKET_SIZE) {
+            return false;
+        }
+
+        message_start_ = size_;
+        uint8_t* p = buffer_ + size_;
+        std::memset(p, 0, sbe::MESSAGE_SIZE_FIELD + sbe::MESSAGE_HEADER_SIZE + sbe::ROOT_BLOCK_LENGTH);
+        sbe::store_le<uint16_t>(p + 2, sbe::ROOT_BLOCK_LENGTH);
+        sbe::store_le<uint16_t>(p + 4, template_id);
+        sbe::store_le<uint16_t>(p + 6, sbe::MDP3_SCHEMA_ID);
+        sbe::store_le<uint16_t>(p + 8, sbe::MDP3_SCHEMA_VERSION);
+        sbe::store_le<uint64_t>(p + 10, transact_time);
+        size_ += sbe::MESSAGE_SIZE_FIELD + sbe::MESSAGE_HEADER_SIZE + sbe::ROOT_BLOCK_LENGTH;
+
+        group_header_ = size_;
+        sbe::store_le<uint16_t>(buffer_ + size_, entry_length);
+        buffer_[size_ + 2] = 0;
+        size_ += sbe::GROUP_HEADER_SIZE;
+        group_count_ = 0;
+        entry_length_ = entry_length;
+        return true;
+    }
+
+    uint8_t* add_entry() noexcept {
+        // Room for this entry plus the trailing empty order-id group
+        if (message_start_ == 0 || group_count_ == UINT8_MAX ||
+            size_ + entry_length_ + sbe::GROUP_HEADER_8BYTE_SIZE > MAX_PACKET_SIZE) {
+            return nullptr;
+        }
+        uint8_t* p = buffer_ + size_;
+        std::memset(p, 0, entry_length_);
+        size_ += entry_length_;
+        buffer_[group_header_ + 2] = ++group_count_;
+        return p;
+    }
+
+    void end_message() noexcept {
+        if (message_start_ == 0) return;
+
+        // Empty NoOrderIDEntries (groupSize8Byte)
+        const uint16_t order_entry_length = entry_length_ == sbe::BOOK_ENTRY_LENGTH
+                                                ? sbe::BOOK_ORDER_ENTRY_LENGTH
+                                                : sbe::TRADE_ORDER_ENTRY_LENGTH;
+        std::memset(buffer_ + size_, 0, sbe::GROUP_HEADER_8BYTE_SIZE);
+        sbe::store_le<uint16_t>(buffer_ + size_, order_entry_length);
+        size_ += sbe::GROUP_HEADER_8BYTE_SIZE;
+
+        sbe::store_le<uint16_t>(buffer_ + message_start_, static_cast<uint16_t>(size_ - message_start_));
+        message_start_ = 0;
+    }
+};
+
+} // namespace hft
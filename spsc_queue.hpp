@@ -138,6 +138,19 @@ public:
                write_pos_.load(std::memory_order_acquire);
     }
     
+    /**
+     * Fault in every page of the ring buffer
+     * A queue in .bss or fresh heap is backed by the zero page until first
+     * write - without this the first lap of the ring takes a page fault
+     * every 4KB. Call before producer/consumer threads start.
+     */
+    void prefault() noexcept {
+        volatile uint8_t* p = reinterpret_cast<volatile uint8_t*>(buffer_);
+        for (size_t off = 0; off < sizeof(buffer_); off += 4096) {
+            p[off] = p[off];
+        }
+    }
+    
     /**
      * Get queue capacity
      */
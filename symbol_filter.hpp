@@ -0,0 +1,255 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace hft {
+
+/**
+ * Subscribed symbol ids - one bit per id
+ *
+ * Immutable once handed to a SymbolFilter: readers test bits with no
+ * synchronization. 64K symbol ids are an 8KB bitmap; a channel's hot
+ * symbols touch a few lines of it. Ids at or past capacity are never
+ * subscribed.
+ */
+class SubscriptionSet {
+private:
+    std::unique_ptr<uint64_t[]> words_;
+    uint32_t capacity_;
+    uint32_t count_{0};
+
+public:
+    explicit SubscriptionSet(uint32_t capacity)
+        : words_(std::make_unique<uint64_t[]>((capacity + 63) / 64)), capacity_(capacity) {
+        std::memset(words_.get(), 0, word_count() * sizeof(uint64_t));
+    }
+
+    SubscriptionSet(const SubscriptionSet& other)
+        : words_(std::make_unique<uint64_t[]>(other.word_count())),
+          capacity_(other.capacity_), count_(other.count_) {
+        std::memcpy(words_.get(), other.words_.get(), word_count() * sizeof(uint64_t));
+    }
+
+    SubscriptionSet& operator=(const SubscriptionSet&) = delete;
+
+    /**
+     * @return false if symbol is out of range
+     */
+    bool subscribe(uint32_t symbol) noexcept {
+        if (symbol >= capacity_) {
+            return false;
+        }
+        const uint64_t bit = 1ULL << (symbol & 63);
+        count_ += (words_[symbol >> 6] & bit) == 0;
+        words_[symbol >> 6] |= bit;
+        return true;
+    }
+
+    void unsubscribe(uint32_t symbol) noexcept {
+        if (symbol >= capacity_) {
+            return;
+        }
+        const uint64_t bit = 1ULL << (symbol & 63);
+        count_ -= (words_[symbol >> 6] & bit) != 0;
+        words_[symbol >> 6] &= ~bit;
+    }
+
+    [[nodiscard]] inline bool contains(uint32_t symbol) const noexcept {
+        return symbol < capacity_ && (words_[symbol >> 6] >> (symbol & 63)) & 1;
+    }
+
+    [[nodiscard]] uint32_t capacity() const noexcept { return capacity_; }
+    [[nodiscard]] uint32_t count() const noexcept { return count_; }
+
+private:
+    [[nodiscard]] size_t word_count() const noexcept { return (capacity_ + 63) / 64; }
+};
+
+/**
+ * Runtime-Updatable Symbol Subscription (RCU)
+ *
+ * Feed threads drop messages for unsubscribed symbols straight after the
+ * symbol field is decoded - before normalization, the engine queue and the
+ * broadcast ring. Sequencing is untouched: PacketManager sees every packet
+ * before decode, so filtered messages still advance the sequence and gaps
+ * are still detected.
+ *
+ * Read side (feed thread, per packet): one acquire load of the current set,
+ * then a bit test per message. No atomics on the message path, no locks.
+ *
+ * Update side (control / housekeeping thread): copy the current set, edit
+ * the copy, swap the pointer (edit()/update()), retire the old set tagged
+ * with a new generation. Each reader announces a quiescent state - between
+ * packets, holding no set - by recording the generation it has seen
+ * (quiescent(), once per feed handler poll iteration - a load and a
+ * compare, with or without a housekeeper). reclaim() frees retired sets
+ * every reader has moved past, so a swap becomes visible at the next
+ * packet and old memory goes at the next reclaim. Readers are registered
+ * before they start and go offline() when they stop.
+ *
+ * No set installed = every symbol passes.
+ */
+class SymbolFilter {
+public:
+    static constexpr size_t MAX_READERS = 8;
+
+private:
+    static constexpr uint64_t OFFLINE = UINT64_MAX;
+
+    struct Retired {
+        std::unique_ptr<const SubscriptionSet> set;
+        uint64_t generation;        // Free once every reader has seen this
+    };
+
+    alignas(64) std::atomic<const SubscriptionSet*> current_{nullptr};
+    alignas(64) std::atomic<uint64_t> generation_{1};
+
+    // Last generation seen at a quiescent point, per reader (0 = unused)
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint64_t> seen{0};
+    };
+    ReaderSlot readers_[MAX_READERS];
+    std::atomic<uint32_t> num_readers_{0};
+
+    // Writers only
+    std::mutex write_mutex_;
+    std::unique_ptr<const SubscriptionSet> owned_;      // The set current_ points at
+    std::vector<Retired> retired_;
+    uint64_t updates_{0};
+    uint64_t reclaimed_{0};
+
+public:
+    SymbolFilter() = default;
+    SymbolFilter(const SymbolFilter&) = delete;
+    SymbolFilter& operator=(const SymbolFilter&) = delete;
+
+    /**
+     * Register a reader thread - before it starts reading
+     * @return Reader id for quiescent()/offline(), -1 when MAX_READERS are in use
+     */
+    int add_reader() noexcept {
+        const uint32_t id = num_readers_.load(std::memory_order_relaxed);
+        if (id == MAX_READERS) {
+            return -1;
+        }
+        readers_[id].seen.store(generation_.load(std::memory_order_acquire), std::memory_order_relaxed);
+        num_readers_.store(id + 1, std::memory_order_release);
+        return static_cast<int>(id);
+    }
+
+    /**
+     * Current subscription for this packet (nullptr = no filtering)
+     * Valid until the reader's next quiescent()
+     */
+    [[nodiscard]] inline const SubscriptionSet* current() const noexcept {
+        return current_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Reader holds no set - a load and a compare unless an update is pending
+     */
+    inline void quiescent(int reader) noexcept {
+        const uint64_t generation = generation_.load(std::memory_order_acquire);
+        if (readers_[reader].seen.load(std::memory_order_relaxed) != generation) {
+            readers_[reader].seen.store(generation, std::memory_order_release);
+        }
+    }
+
+    /**
+     * Reader stopped for good - never holds up reclaim again
+     */
+    void offline(int reader) noexcept {
+        readers_[reader].seen.store(OFFLINE, std::memory_order_release);
+    }
+
+    /**
+     * Install a new set (nullptr = stop filtering); the old one is retired
+     */
+    void update(std::unique_ptr<SubscriptionSet> next) {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        install(std::move(next));
+    }
+
+    /**
+     * Copy-update: fn(SubscriptionSet&) edits a copy of the current set
+     * (or an empty one of capacity symbols if none is installed), which
+     * then replaces it
+     */
+    template<typename Fn>
+    void edit(uint32_t capacity, Fn&& fn) {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        auto next = owned_ ? std::make_unique<SubscriptionSet>(*owned_)
+                           : std::make_unique<SubscriptionSet>(capacity);
+        fn(*next);
+        install(std::move(next));
+    }
+
+    /**
+     * Free retired sets no reader can still hold - housekeeping task
+     * @return Sets freed
+     */
+    size_t reclaim() {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        return reclaim_locked();
+    }
+
+    [[nodiscard]] uint64_t generation() const noexcept { return generation_.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t updates() const noexcept { return updates_; }
+    [[nodiscard]] uint64_t reclaimed() const noexcept { return reclaimed_; }
+
+    void print() {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        if (owned_) {
+            printf("[SymbolFilter] %u of %u symbol ids subscribed, %u readers: %lu updates, %lu sets reclaimed, %zu pending\n",
+                   owned_->count(), owned_->capacity(), num_readers_.load(std::memory_order_relaxed),
+                   updates_, reclaimed_, retired_.size());
+        } else {
+            printf("[SymbolFilter] Off (every symbol passes), %lu updates\n", updates_);
+        }
+    }
+
+private:
+    void install(std::unique_ptr<SubscriptionSet> next) {
+        current_.store(next.get(), std::memory_order_release);
+        // Readers that record this generation have dropped the old set
+        const uint64_t generation = generation_.fetch_add(1, std::memory_order_acq_rel) + 1;
+        if (owned_) {
+            retired_.push_back(Retired{std::move(owned_), generation});
+        }
+        owned_ = std::move(next);
+        updates_++;
+        reclaim_locked();
+    }
+
+    size_t reclaim_locked() {
+        if (retired_.empty()) {
+            return 0;
+        }
+        uint64_t oldest = OFFLINE;
+        const uint32_t readers = num_readers_.load(std::memory_order_acquire);
+        for (uint32_t i = 0; i < readers; ++i) {
+            const uint64_t seen = readers_[i].seen.load(std::memory_order_acquire);
+            oldest = seen < oldest ? seen : oldest;
+        }
+        size_t freed = 0;
+        auto it = retired_.begin();
+        while (it != retired_.end()) {
+            if (it->generation <= oldest) {
+                it = retired_.erase(it);
+                freed++;
+            } else {
+                ++it;
+            }
+        }
+        reclaimed_ += freed;
+        return freed;
+    }
+};
+
+} // namespace hft
@@ -1,5 +1,7 @@
 #include "types.hpp"
 #include "utils.hpp"
+#include "market_scenario.hpp"
+#include "feed_generator.hpp"
 #include <iostream>
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -9,9 +11,23 @@
 #include <chrono>
 #include <random>
 #include <cstring>
+#include <vector>
+#include <atomic>
+#include <string>
+#include <cstdlib>
+#include <memory>
+#include <signal.h>
 
 using namespace hft;
 
+// Ctrl+C / SIGTERM: senders stop, final stats are still printed
+static std::atomic<bool> g_stop{false};
+
+static void signal_handler(int signum) {
+    (void)signum;
+    g_stop.store(true, std::memory_order_release);
+}
+
 /**
  * Test Feed Generator
  * 
@@ -22,7 +38,13 @@ using namespace hft;
  * - Out-of-order delivery (to test resequencing)
  * 
  * Usage:
- *   ./test_feed_generator [multicast_ip] [port] [packets_per_second]
+ *   ./test_feed_generator [multicast_ip] [port] [packets_per_second] [total_packets]
+ *   ./test_feed_generator 127.0.0.1 15000 2000000 0 --fast --batch 32 --threads 2
+ * 
+ * --fast switches to the high-rate mode (sendmmsg batches, TSC pacing,
+ * one sender thread per channel on consecutive ports) for 1-5M pps runs.
+ * --scenario replaces the single-symbol trade stream with MarketScenario
+ * (Zipf symbols, Hawkes bursts, auction spikes, order add/cancel/modify).
  */
 class TestFeedGenerator {
 private:
@@ -35,8 +57,11 @@ private:
     double duplicate_probability_{0.002}; // 0.2% chance of duplicate
     double reorder_probability_{0.005};   // 0.5% chance of reorder
     
-    std::mt19937 rng_{std::random_device{}()};
+    std::mt19937_64 rng_{std::random_device{}()};
     std::uniform_real_distribution<double> dist_{0.0, 1.0};
+    
+    // Optional microstructure scenario (content + arrival times)
+    MarketScenario* scenario_{nullptr};
 
 public:
     bool initialize(const std::string& multicast_ip, uint16_t port) {
@@ -71,6 +96,12 @@ public:
     void set_duplicate_probability(double prob) { duplicate_probability_ = prob; }
     void set_reorder_probability(double prob) { reorder_probability_ = prob; }
     
+    /**
+     * Drive content and timing from a scenario instead of uniform trades
+     * packets_per_second is then the scenario's mean rate, bursts included
+     */
+    void set_scenario(MarketScenario* scenario) { scenario_ = scenario; }
+    
     /**
      * Send packets at specified rate
      */
@@ -89,14 +120,26 @@ public:
                   << packets_per_second << " packets/sec" << std::endl;
         
         auto start_time = std::chrono::steady_clock::now();
+        if (scenario_) {
+            // Exchange timestamp = TSC at the scheduled send, as in
+            // create_market_packet - the engine reads it as local TSC
+            const double tsc_ghz = LatencyTracker::calibrate_tsc_ghz(20);
+            start_time = std::chrono::steady_clock::now();
+            scenario_->set_clock(LatencyTracker::rdtsc(), tsc_ghz);
+        }
         
-        while (total_packets == 0 || packets_sent < total_packets) {
-            auto send_time = start_time + (interval * packets_sent);
-            std::this_thread::sleep_until(send_time);
-            
+        while ((total_packets == 0 || packets_sent < total_packets) &&
+               !g_stop.load(std::memory_order_acquire)) {
             // Create packet
             MarketDataPacket packet;
-            create_market_packet(packet, sequence_);
+            auto send_time = start_time + (interval * packets_sent);
+            if (scenario_) {
+                const uint64_t sim_ns = scenario_->next(packet, sequence_);
+                send_time = start_time + std::chrono::nanoseconds(sim_ns);
+            } else {
+                create_market_packet(packet, sequence_);
+            }
+            std::this_thread::sleep_until(send_time);
             
             // Decide on anomalies
             double rand_val = dist_(rng_);
@@ -182,22 +225,7 @@ public:
 
 private:
     void create_market_packet(MarketDataPacket& packet, uint64_t seq) {
-        std::memset(&packet, 0, sizeof(packet));
-        
-        packet.msg_type = MessageType::TRADE;
-        packet.version = 1;
-        packet.payload_size = sizeof(TradeMessage);
-        packet.packet_sequence = seq;
-        
-        // Fill in trade data
-        auto& trade = packet.payload.trade;
-        trade.timestamp_ns = LatencyTracker::rdtsc();
-        trade.sequence_num = seq;
-        trade.symbol_id = 12345; // AAPL
-        trade.trade_id = seq;
-        trade.price = 1500000 + (rng_() % 10000); // $150.00 +/- $1.00
-        trade.quantity = 100 + (rng_() % 1000);
-        trade.side = (rng_() % 2 == 0) ? 'B' : 'S';
+        fill_trade_packet(packet, seq, rng_());
     }
     
     void send_packet(const MarketDataPacket& packet) {
@@ -209,6 +237,82 @@ private:
     }
 };
 
+/**
+ * Run N sender threads (one channel each) and report aggregate rate
+ */
+static int run_high_rate(const HighRateConfig& cfg) {
+    const double tsc_ghz = LatencyTracker::calibrate_tsc_ghz();
+    
+    std::cout << "[HighRate] TSC: " << tsc_ghz << " GHz" << std::endl;
+    std::cout << "[HighRate] " << cfg.num_threads << " sender(s) x " << cfg.packets_per_second
+              << " pps, batch " << cfg.batch_size;
+    if (cfg.burst_packets > 0) {
+        std::cout << ", microburst " << cfg.burst_packets << " pkts every "
+                  << cfg.burst_interval_us << "us";
+    }
+    std::cout << std::endl;
+    
+    std::vector<SenderStats> stats(cfg.num_threads);
+    std::vector<std::thread> threads;
+    
+    for (uint32_t t = 0; t < cfg.num_threads; ++t) {
+        const uint16_t port = static_cast<uint16_t>(cfg.base_port + t);
+        std::cout << "[HighRate] Channel " << t << " -> " << cfg.multicast_ip << ":" << port << std::endl;
+        
+        threads.emplace_back([&cfg, &stats, tsc_ghz, t, port]() {
+            if (cfg.first_core >= 0 && !ThreadUtils::pin_to_core(cfg.first_core + static_cast<int>(t))) {
+                std::cerr << "[HighRate] Failed to pin channel " << t << std::endl;
+            }
+            
+            HighRateSender sender(0x9E3779B97F4A7C15ULL * (t + 1));
+            if (sender.initialize(cfg.multicast_ip, port, cfg.batch_size)) {
+                sender.run(cfg, tsc_ghz, stats[t], g_stop);
+            }
+            stats[t].done.store(true, std::memory_order_release);
+        });
+    }
+    
+    // Reporting loop (1s interval)
+    const auto start = std::chrono::steady_clock::now();
+    uint64_t last_total = 0;
+    auto last_time = start;
+    bool all_done = false;
+    
+    while (!all_done) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        
+        uint64_t total = 0;
+        uint64_t syscalls = 0;
+        uint64_t blocked = 0;
+        all_done = true;
+        for (const auto& s : stats) {
+            total += s.packets_sent.load(std::memory_order_relaxed);
+            syscalls += s.syscalls.load(std::memory_order_relaxed);
+            blocked += s.would_block.load(std::memory_order_relaxed);
+            all_done &= s.done.load(std::memory_order_acquire);
+        }
+        
+        const auto now = std::chrono::steady_clock::now();
+        const double interval = std::chrono::duration<double>(now - last_time).count();
+        std::cout << "[HighRate] Sent: " << total
+                  << ", Rate: " << static_cast<uint64_t>((total - last_total) / interval) << " pps"
+                  << ", Pkts/syscall: " << (syscalls > 0 ? static_cast<double>(total) / syscalls : 0.0)
+                  << ", EAGAIN: " << blocked
+                  << std::endl;
+        last_total = total;
+        last_time = now;
+    }
+    
+    for (auto& th : threads) {
+        th.join();
+    }
+    
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "[HighRate] Complete. Total packets: " << last_total
+              << ", Avg rate: " << static_cast<uint64_t>(last_total / elapsed) << " pps" << std::endl;
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     std::cout << R"(
 ╔══════════════════════════════════════════════════════════════╗
@@ -217,16 +321,59 @@ int main(int argc, char* argv[]) {
 ╚══════════════════════════════════════════════════════════════╝
     )" << std::endl;
     
-    // Parse arguments
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+    
+    // Parse arguments: positionals, then --options
     std::string multicast_ip = "233.54.12.1";
     uint16_t port = 15000;
     uint32_t packets_per_second = 10000;
     uint32_t total_packets = 0; // 0 = infinite
     
-    if (argc > 1) multicast_ip = argv[1];
-    if (argc > 2) port = std::stoi(argv[2]);
-    if (argc > 3) packets_per_second = std::stoi(argv[3]);
-    if (argc > 4) total_packets = std::stoi(argv[4]);
+    HighRateConfig high_rate;
+    bool use_high_rate = false;
+    
+    int positional = 0;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        
+        if (arg == "--fast") {
+            use_high_rate = true;
+        } else if (arg == "--batch" && has_value) {
+            high_rate.batch_size = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--threads" && has_value) {
+            high_rate.num_threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--burst" && has_value) {
+            high_rate.burst_packets = std::atoi(argv[++i]);
+        } else if (arg == "--burst-interval-us" && has_value) {
+            high_rate.burst_interval_us = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--core" && has_value) {
+            high_rate.first_core = std::atoi(argv[++i]);
+        } else if (arg == "--scenario") {
+            high_rate.use_scenario = true;
+        } else if (arg == "--symbols" && has_value) {
+            high_rate.scenario.num_symbols = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--session-s" && has_value) {
+            high_rate.scenario.session_seconds = std::max(1.0, std::atof(argv[++i]));
+        } else {
+            switch (positional++) {
+                case 0: multicast_ip = arg; break;
+                case 1: port = std::stoi(arg); break;
+                case 2: packets_per_second = std::stoi(arg); break;
+                case 3: total_packets = std::stoi(arg); break;
+                default: break;
+            }
+        }
+    }
+    
+    if (use_high_rate) {
+        high_rate.multicast_ip = multicast_ip;
+        high_rate.base_port = port;
+        high_rate.packets_per_second = packets_per_second;
+        high_rate.total_packets = total_packets;
+        return run_high_rate(high_rate);
+    }
     
     TestFeedGenerator generator;
     
@@ -234,6 +381,21 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    // Scenario storage must outlive run()
+    ScenarioConfig scenario_cfg = high_rate.scenario;
+    scenario_cfg.mean_rate = packets_per_second;
+    std::unique_ptr<MarketScenario> scenario;
+    if (high_rate.use_scenario) {
+        if (!scenario_cfg.valid()) {
+            std::cerr << "[Generator] Invalid scenario config" << std::endl;
+            return 1;
+        }
+        scenario = std::make_unique<MarketScenario>(scenario_cfg, std::random_device{}());
+        std::cout << "[Generator] Scenario: " << scenario_cfg.num_symbols << " symbols, "
+                  << scenario_cfg.session_seconds << "s session" << std::endl;
+        generator.set_scenario(scenario.get());
+    }
+    
     // Optional: customize probabilities via command line or config
     // generator.set_gap_probability(0.01); // 1% gaps
     // generator.set_duplicate_probability(0.02); // 2% duplicates
@@ -242,7 +404,11 @@ int main(int argc, char* argv[]) {
     std::cout << "[Main] Press Ctrl+C to stop" << std::endl;
     std::cout << "\n[Main] Usage: " << argv[0] 
               << " [multicast_ip] [port] [packets_per_sec] [total_packets]" << std::endl;
-    std::cout << "[Main] Example: " << argv[0] << " 233.54.12.1 15000 10000 100000\n" << std::endl;
+    std::cout << "[Main] Example: " << argv[0] << " 233.54.12.1 15000 10000 100000" << std::endl;
+    std::cout << "[Main] High-rate: " << argv[0]
+              << " 127.0.0.1 15000 2000000 0 --fast [--batch 32] [--threads N] [--burst N]"
+              << " [--burst-interval-us N] [--core N]" << std::endl;
+    std::cout << "[Main] Scenario: add --scenario [--symbols N] [--session-s S] to either mode\n" << std::endl;
     
     // No exception handling - fails fast if error occurs
     generator.run(packets_per_second, total_packets);
@@ -0,0 +1,354 @@
+#include "spsc_queue.hpp"
+#include "types.hpp"
+#include "utils.hpp"
+#include "logger.hpp"
+#include "latency_histogram.hpp"
+#include "feed_generator.hpp"
+#include "feed_handler_impl.hpp"
+#include "trading_engine.hpp"
+#include "order_gateway.hpp"
+#include "housekeeping.hpp"
+#include <iostream>
+#include <fstream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <cstdlib>
+#include <fcntl.h>
+#include <signal.h>
+
+using namespace hft;
+
+namespace hft {
+std::atomic<bool> g_running{true};
+}
+
+// Ctrl+C: the generator stops first, then the pipeline drains and reports
+static std::atomic<bool> g_gen_stop{false};
+
+static void signal_handler(int signum) {
+    (void)signum;
+    g_gen_stop.store(true, std::memory_order_release);
+}
+
+/**
+ * Simulated Exchange - closes the loop
+ *
+ * Receives NewOrderMessages from the gateway and attributes latency using
+ * the timestamps carried end to end:
+ *
+ *   generator send TSC (in market data) -> feed recv TSC -> gateway send TSC -> exchange recv TSC
+ *        |---------- network in --------|------ internal ------|---- network out ----|
+ *        |----------------------------- tick-to-trade ---------------------------------|
+ */
+class SimulatedExchange {
+private:
+    int socket_fd_{-1};
+    int core_id_;
+    double tsc_ghz_;
+    uint64_t warmup_orders_;
+
+    alignas(64) std::atomic<uint64_t> orders_received_{0};
+    std::atomic<bool> running_{false};
+
+    LatencyHistogram tick_to_trade_;
+    LatencyHistogram network_in_;
+    LatencyHistogram internal_;
+    LatencyHistogram network_out_;
+
+public:
+    SimulatedExchange(int core_id, double tsc_ghz, uint64_t warmup_orders)
+        : core_id_(core_id), tsc_ghz_(tsc_ghz), warmup_orders_(warmup_orders) {}
+
+    ~SimulatedExchange() {
+        if (socket_fd_ >= 0) {
+            close(socket_fd_);
+        }
+    }
+
+    bool init(uint16_t port) noexcept {
+        socket_fd_ = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (socket_fd_ < 0) {
+            return false;
+        }
+        fcntl(socket_fd_, F_SETFL, fcntl(socket_fd_, F_GETFL, 0) | O_NONBLOCK);
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        return bind(socket_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    }
+
+    void run() {
+        pin_if_available(core_id_, "Exchange");
+
+        NewOrderMessage msg;
+        uint64_t received = 0;
+
+        running_.store(true, std::memory_order_release);
+        while (g_running.load(std::memory_order_acquire)) {
+            const ssize_t bytes = recv(socket_fd_, &msg, sizeof(msg), MSG_DONTWAIT);
+            if (bytes != static_cast<ssize_t>(sizeof(msg))) {
+                SpinWait::pause();
+                continue;
+            }
+
+            const uint64_t recv_tsc = LatencyTracker::rdtsc();
+            received++;
+            orders_received_.store(received, std::memory_order_relaxed);
+
+            // First orders include cold caches and page faults - not steady state
+            if (received <= warmup_orders_) {
+                continue;
+            }
+
+            // TSC is invariant and synchronized across cores - deltas are valid
+            if (recv_tsc < msg.origin_timestamp_ns || msg.gateway_send_tsc < msg.event_recv_tsc ||
+                msg.event_recv_tsc < msg.origin_timestamp_ns) {
+                continue;
+            }
+
+            tick_to_trade_.record(to_ns(recv_tsc - msg.origin_timestamp_ns));
+            network_in_.record(to_ns(msg.event_recv_tsc - msg.origin_timestamp_ns));
+            internal_.record(to_ns(msg.gateway_send_tsc - msg.event_recv_tsc));
+            network_out_.record(to_ns(recv_tsc - msg.gateway_send_tsc));
+        }
+    }
+
+    [[nodiscard]] uint64_t orders_received() const noexcept {
+        return orders_received_.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] bool running() const noexcept {
+        return running_.load(std::memory_order_acquire);
+    }
+
+    const LatencyHistogram& tick_to_trade() const noexcept { return tick_to_trade_; }
+    const LatencyHistogram& network_in() const noexcept { return network_in_; }
+    const LatencyHistogram& internal() const noexcept { return internal_; }
+    const LatencyHistogram& network_out() const noexcept { return network_out_; }
+
+    static void pin_if_available(int core, const char* name) {
+        if (core < 0 || static_cast<unsigned>(core) >= std::thread::hardware_concurrency()) {
+            std::cerr << "[Bench] " << name << ": core " << core << " not available, not pinned" << std::endl;
+            return;
+        }
+        if (!ThreadUtils::pin_to_core(core)) {
+            std::cerr << "[Bench] " << name << ": failed to pin to core " << core << std::endl;
+        }
+    }
+
+private:
+    uint64_t to_ns(uint64_t ticks) const noexcept {
+        return LatencyTracker::tsc_to_ns(ticks, tsc_ghz_);
+    }
+};
+
+/**
+ * Benchmark configuration
+ */
+struct BenchConfig {
+    uint32_t rate{100000};          // Market data packets/sec
+    uint64_t packets{1000000};      // Total market data packets
+    uint32_t signal_every{10};      // Every Nth packet triggers an order
+    uint32_t batch{8};              // Generator sendmmsg batch
+    uint64_t warmup_orders{1000};   // Excluded from histograms
+    uint64_t idle_warm_us{0};       // Engine/gateway idle warming interval (0 = off)
+    uint16_t feed_port{15000};
+    uint16_t exchange_port{16000};
+    int cores[5]{0, 1, 2, 3, 4};    // feed, engine, gateway, exchange, generator
+    std::string output{"bench_e2e.json"};
+};
+
+static void parse_cores(const char* arg, int (&cores)[5]) {
+    int idx = 0;
+    const char* p = arg;
+    while (*p && idx < 5) {
+        cores[idx++] = std::atoi(p);
+        while (*p && *p != ',') p++;
+        if (*p == ',') p++;
+    }
+}
+
+/**
+ * END-TO-END TICK-TO-TRADE BENCHMARK
+ *
+ * Full pipeline on loopback, every stage on its own pinned core:
+ *
+ *   [Generator] -UDP-> [FeedHandler] -SPSC-> [TradingEngine] -SPSC-> [OrderGateway] -UDP-> [Exchange]
+ *
+ * Market data carries the generator's send TSC; orders echo it back, so the
+ * exchange sees the full closed loop. Results go to stdout and to a JSON file
+ * for regression tracking.
+ *
+ * Usage:
+ *   ./tick_to_trade_bench [--rate N] [--packets N] [--signal-every N] [--batch N]
+ *                         [--warmup N] [--cores feed,engine,gateway,exchange,generator]
+ *                         [--idle-warm-us N] [--output bench_e2e.json]
+ *
+ * Low --rate with --idle-warm-us 0 vs 50 shows the first-tick-after-a-lull
+ * penalty and how much idle warming recovers.
+ */
+int main(int argc, char* argv[]) {
+    BenchConfig cfg;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--rate" && has_value) cfg.rate = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--packets" && has_value) cfg.packets = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--signal-every" && has_value) cfg.signal_every = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--batch" && has_value) cfg.batch = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--warmup" && has_value) cfg.warmup_orders = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--cores" && has_value) parse_cores(argv[++i], cfg.cores);
+        else if (arg == "--idle-warm-us" && has_value) cfg.idle_warm_us = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--output" && has_value) cfg.output = argv[++i];
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--rate N] [--packets N] [--signal-every N] [--batch N]"
+                      << " [--warmup N] [--cores f,e,g,x,gen] [--idle-warm-us N] [--output file.json]" << std::endl;
+            return 1;
+        }
+    }
+
+    Logger::initialize("tick_to_trade_bench.log", LogLevel::INFO);
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    const double tsc_ghz = LatencyTracker::calibrate_tsc_ghz();
+    std::cout << "[Bench] TSC " << tsc_ghz << " GHz, " << cfg.packets << " packets at "
+              << cfg.rate << " pps, 1 signal per " << cfg.signal_every << " packets" << std::endl;
+
+    // Static storage - queues are too large for the stack
+    static SPSCQueue<MarketEvent, 65536> event_queue;
+    static OrderQueue order_queue;
+    static FeedHandlerStats stats;
+
+    FeedHandler feed_handler(event_queue, stats, cfg.cores[0]);
+    TradingEngine engine(event_queue, cfg.cores[1], &order_queue);
+    OrderGateway gateway(order_queue, cfg.cores[2]);
+    if (cfg.idle_warm_us > 0) {
+        engine.enable_idle_warming(cfg.idle_warm_us);
+        gateway.enable_idle_warming(cfg.idle_warm_us);
+    }
+    SimulatedExchange exchange(cfg.cores[3], tsc_ghz, cfg.warmup_orders);
+
+    // Gap timeouts, stats and logging off the feed core, as in production
+    Housekeeper housekeeper;
+    feed_handler.attach_housekeeping(housekeeper);
+
+    // Unicast loopback: "0.0.0.0" skips the multicast join
+    if (!feed_handler.init("0.0.0.0", cfg.feed_port) ||
+        !gateway.init("127.0.0.1", cfg.exchange_port) ||
+        !exchange.init(cfg.exchange_port)) {
+        std::cerr << "[Bench] Failed to initialize sockets" << std::endl;
+        Logger::shutdown();
+        return 1;
+    }
+
+    std::thread exchange_thread([&]() { exchange.run(); });
+    std::thread gateway_thread([&]() { gateway.run(); });
+    std::thread engine_thread([&]() { engine.run(); });
+    std::thread feed_thread([&]() { feed_handler.run(); });
+    std::thread housekeeping_thread([&]() { housekeeper.run(); });
+
+    // Start the generator once every stage is in its polling loop (sockets
+    // are bound by init() above)
+    const auto ready_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!(exchange.running() && gateway.running() &&
+             engine.heartbeat().attached.load(std::memory_order_acquire) &&
+             feed_handler.heartbeat().attached.load(std::memory_order_acquire)) &&
+           !g_gen_stop.load(std::memory_order_acquire)) {
+        if (std::chrono::steady_clock::now() > ready_deadline) {
+            std::cerr << "[Bench] Pipeline not ready after 5s - not starting the generator" << std::endl;
+            g_gen_stop.store(true, std::memory_order_release);
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // Generator - clean sequence, trade packets with send TSC embedded
+    HighRateConfig gen_cfg;
+    gen_cfg.packets_per_second = cfg.rate;
+    gen_cfg.total_packets = cfg.packets;
+    gen_cfg.batch_size = cfg.batch;
+    gen_cfg.signal_every = cfg.signal_every;
+
+    SenderStats gen_stats;
+    const auto start = std::chrono::steady_clock::now();
+    std::thread generator_thread([&]() {
+        SimulatedExchange::pin_if_available(cfg.cores[4], "Generator");
+        HighRateSender sender(0x5DEECE66DULL);
+        if (sender.initialize("127.0.0.1", cfg.feed_port, cfg.batch)) {
+            sender.run(gen_cfg, tsc_ghz, gen_stats, g_gen_stop);
+        }
+        gen_stats.done.store(true, std::memory_order_release);
+    });
+    generator_thread.join();
+    g_gen_stop.store(true, std::memory_order_release);
+    const auto gen_end = std::chrono::steady_clock::now();
+
+    // Drain: wait until orders stop arriving (or 2s cap)
+    uint64_t last_orders = exchange.orders_received();
+    for (int i = 0; i < 20; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        const uint64_t now_orders = exchange.orders_received();
+        if (now_orders == last_orders && event_queue.empty() && order_queue.empty()) {
+            break;
+        }
+        last_orders = now_orders;
+    }
+
+    g_running.store(false, std::memory_order_release);
+    feed_thread.join();
+    engine_thread.join();
+    gateway_thread.join();
+    exchange_thread.join();
+    housekeeping_thread.join();
+
+    const double gen_seconds = std::chrono::duration<double>(gen_end - start).count();
+    const uint64_t sent = gen_stats.packets_sent.load();
+    const uint64_t received = stats.packets_received.load();
+    const uint64_t orders_received = exchange.orders_received();
+
+    std::cout << "\n[Bench] Packets sent " << sent << ", received " << received
+              << ", events " << engine.events_processed()
+              << ", orders " << engine.orders_sent() << " -> exchange " << orders_received << std::endl;
+    std::cout << "[Bench] Throughput " << static_cast<uint64_t>(received / gen_seconds) << " pps over "
+              << gen_seconds << " s" << std::endl;
+    exchange.tick_to_trade().print("tick_to_trade");
+    exchange.network_in().print("network_in");
+    exchange.internal().print("internal");
+    exchange.network_out().print("network_out");
+
+    // Machine-readable output
+    std::ofstream out(cfg.output);
+    out << "{\n"
+        << "  \"benchmark\": \"tick_to_trade_e2e\",\n"
+        << "  \"config\": {\"rate_pps\": " << cfg.rate << ", \"packets\": " << cfg.packets
+        << ", \"signal_every\": " << cfg.signal_every << ", \"batch\": " << cfg.batch
+        << ", \"warmup_orders\": " << cfg.warmup_orders << "},\n"
+        << "  \"tsc_ghz\": " << tsc_ghz << ",\n"
+        << "  \"packets_sent\": " << sent << ",\n"
+        << "  \"packets_received\": " << received << ",\n"
+        << "  \"packets_dropped\": " << stats.packets_dropped.load() << ",\n"
+        << "  \"events_processed\": " << engine.events_processed() << ",\n"
+        << "  \"orders_sent\": " << engine.orders_sent() << ",\n"
+        << "  \"orders_received\": " << orders_received << ",\n"
+        << "  \"duration_s\": " << gen_seconds << ",\n"
+        << "  \"throughput_pps\": " << static_cast<uint64_t>(received / gen_seconds) << ",\n"
+        << "  \"latency\": {\n"
+        << "    " << exchange.tick_to_trade().to_json("tick_to_trade_ns") << ",\n"
+        << "    " << exchange.network_in().to_json("network_in_ns") << ",\n"
+        << "    " << exchange.internal().to_json("internal_ns") << ",\n"
+        << "    " << exchange.network_out().to_json("network_out_ns") << "\n"
+        << "  },\n"
+        << "  \"perf_counters\": {"
+        << feed_handler.perf_counters().to_json("feed_handler") << ", "
+        << engine.perf_counters().to_json("trading_engine") << "}\n"
+        << "}\n";
+    std::cout << "[Bench] Results written to " << cfg.output << std::endl;
+
+    Logger::shutdown();
+    return 0;
+}
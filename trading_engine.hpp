@@ -4,11 +4,25 @@
 #include "types.hpp"
 #include "utils.hpp"
 #include "logger.hpp"
+#include "order_gateway.hpp"
+#include "perf_counters.hpp"
+#include "jitter_probe.hpp"
+#include "warmup.hpp"
+#include "clock_skew.hpp"
+#include "feed_health.hpp"
+#include "watchdog.hpp"
+#include "book_snapshot.hpp"
+#include "event_merger.hpp"
+#include "nbbo.hpp"
 #include <iostream>
 #include <atomic>
+#include <memory>
 
 namespace hft {
 
+// External global for shutdown signaling
+extern std::atomic<bool> g_running;
+
 /**
  * Trading Engine Implementation
  * 
@@ -16,7 +30,7 @@ namespace hft {
  * - Consumes from lock-free queue
  * - Updates order book state
  * - Runs trading strategies
- * - Generates orders
+ * - Generates orders (pushed to OrderGateway via SPSC queue)
  * 
  * Runs on dedicated CPU core with RT priority
  */
@@ -25,38 +39,212 @@ private:
     SPSCQueue<MarketEvent, 65536>& event_queue_;
     int core_id_;
     
+    // Several feed queues in timestamp order instead of event_queue_
+    // (nullptr = single feed)
+    EventMerger<>* merger_{nullptr};
+    
     // Order book state (simplified)
     // In production: highly optimized order book with hash maps, price levels, etc.
-    uint64_t last_bid_{0};
-    uint64_t last_ask_{0};
+    struct StrategyState {
+        uint64_t last_bid{0};
+        uint64_t last_ask{0};
+    };
+    StrategyState state_;
+    
+    // Outbound orders - nullptr means signals are computed but never sent
+    OrderQueue* order_queue_;
+    
+    // Counters (read by owner after run() returns)
+    uint64_t events_processed_{0};
+    uint64_t orders_sent_{0};
+    uint64_t orders_dropped_{0};
+    uint64_t orders_suppressed_{0};
+    uint64_t orders_unhealthy_{0};
+    
+    // Orders go out only once LIVE (synthetic warmup events never trade)
+    bool live_{false};
+    
+    // Idle-time cache warming (off unless enable_idle_warming() is called)
+    // warming_ is set only while a dummy event is in flight - send_order
+    // builds the request but never pushes it
+    bool warming_{false};
+    uint64_t idle_warm_interval_us_{0};
+    uint64_t idle_warm_interval_ticks_{0};
+    uint64_t idle_warm_passes_{0};
+    uint64_t orders_warmed_{0};
+    
+    // Hardware counters for the strategy region (HFT_PERF_COUNTERS builds)
+    PerfCounters perf_;
+    
+    // Per-channel exchange -> us latency (off unless enable_clock_skew())
+    std::unique_ptr<ClockSkewMonitor> clock_skew_;
+    
+    // Per-symbol books checkpointed for warm restart (off unless
+    // enable_book_snapshot())
+    std::unique_ptr<BookSnapshot> snapshot_;
+    SymbolBooks* books_{nullptr};
+    
+    // Consolidated best bid/offer across venues (channel id = venue);
+    // off unless enable_nbbo()
+    std::unique_ptr<NbboBook<>> nbbo_;
+    
+    // Per-channel circuit breaker (nullptr = always quote)
+    const FeedHealth* health_{nullptr};
+    
+    // Idle-loop gap detection (core stolen while waiting for events)
+    JitterMonitor jitter_;
+    static constexpr uint64_t JITTER_THRESHOLD_NS = 10000;
+    
+    // Advanced every loop iteration - watched by Watchdog
+    Heartbeat heartbeat_;
 
 public:
-    TradingEngine(SPSCQueue<MarketEvent, 65536>& queue, int core_id = 1)
-        : event_queue_(queue), core_id_(core_id) {}
+    TradingEngine(SPSCQueue<MarketEvent, 65536>& queue, int core_id = 1,
+                  OrderQueue* order_queue = nullptr)
+        : event_queue_(queue), core_id_(core_id), order_queue_(order_queue) {}
+    
+    /**
+     * Keep the strategy hot through quiet periods
+     *
+     * After interval_us with no events, a pass of dummy trade/quote events
+     * runs through the strategy and order-building path so code, branch
+     * history and data stay resident - otherwise the first real tick after
+     * a lull pays for i-cache/TLB misses. Dummy orders are never pushed and
+     * strategy state is restored afterwards.
+     *
+     * A real event arriving mid-pass waits for it (~100ns) - keep the
+     * interval well above the pass cost. Call before run().
+     */
+    void enable_idle_warming(uint64_t interval_us = 50) noexcept {
+        idle_warm_interval_us_ = interval_us;
+    }
+    
+    /**
+     * Track exchange-to-local clock offset/drift and per-channel one-way
+     * latency next to our own receive -> engine latency (clock_skew.hpp)
+     * Live events only. Call before run().
+     */
+    void enable_clock_skew(const ClockSkewConfig& cfg = ClockSkewConfig{}) {
+        clock_skew_ = std::make_unique<ClockSkewMonitor>(cfg);
+    }
+    
+    /**
+     * Keep per-symbol books (live events only) in a checkpointed
+     * memory-mapped file (book_snapshot.hpp) and restore them from it
+     * 
+     * Call before run(); then, if book_snapshot()->restored(), resume the
+     * feed at book_snapshot()->resume_sequence() and schedule
+     * maybe_checkpoint() on the housekeeping thread.
+     * 
+     * @return false if the file cannot be mapped (snapshots stay off)
+     */
+    bool enable_book_snapshot(const BookSnapshotConfig& cfg = BookSnapshotConfig{}) {
+        auto snapshot = std::make_unique<BookSnapshot>(cfg);
+        if (!snapshot->open()) {
+            return false;
+        }
+        snapshot_ = std::move(snapshot);
+        books_ = &snapshot_->books();
+        return true;
+    }
+    
+    /**
+     * Maintain the consolidated NBBO per symbol from every venue's quotes
+     * (nbbo.hpp) - live quotes only. Call before run().
+     */
+    void enable_nbbo(size_t num_symbols) {
+        nbbo_ = std::make_unique<NbboBook<>>(num_symbols);
+    }
+    
+    /**
+     * Consume several feed queues merged in timestamp order (event_merger.hpp)
+     * instead of the constructor's queue - add every feed's queue to the
+     * merger, then call before run()
+     * 
+     * Each feed warms up on its own; begin_warmup() must count every
+     * handler that will warm, so the engine goes LIVE only after the last
+     * one's synthetic events are consumed.
+     */
+    void set_merger(EventMerger<>* merger) noexcept {
+        merger_ = merger;
+    }
+    
+    /**
+     * Suppress order sends while the trigger's channel is unhealthy
+     * (feed_health.hpp) - one byte load per send. Call before run().
+     */
+    void set_feed_health(const FeedHealth* health) noexcept {
+        health_ = health;
+    }
     
     /**
      * Main trading loop - runs on dedicated core
      */
     void run() {
         // Pin to different core than feed handler
-        ThreadUtils::pin_to_core(core_id_);
-        ThreadUtils::set_realtime_priority();
+        if (!ThreadUtils::pin_to_core(core_id_)) {
+            std::cerr << "[TradingEngine] Failed to pin to core " << core_id_ << std::endl;
+            LOG_WARN("TradingEngine: failed to pin to core - latency will be unpredictable");
+        }
+        if (!ThreadUtils::set_realtime_priority()) {
+            std::cerr << "[TradingEngine] SCHED_FIFO unavailable (needs CAP_SYS_NICE)" << std::endl;
+            LOG_WARN("TradingEngine: SCHED_FIFO unavailable - running at normal priority");
+        }
+        
+        const double tsc_ghz = LatencyTracker::calibrate_tsc_ghz(20);
+        jitter_.configure(tsc_ghz, JITTER_THRESHOLD_NS);
+        idle_warm_interval_ticks_ = static_cast<uint64_t>(idle_warm_interval_us_ * 1000 * tsc_ghz);
+        if (clock_skew_) {
+            clock_skew_->start(tsc_ghz);
+        }
+        if (merger_) {
+            merger_->set_tsc_ghz(tsc_ghz);
+        }
+        Prefault::stack();
+        
+        // Counters are per-thread - open after pinning, on this thread
+        HFT_PERF_OPEN(perf_, "TradingEngine");
         
+        heartbeat_.attach("TradingEngine");
         std::cout << "[TradingEngine] Started on core " << core_id_ << std::endl;
         LOG_INFO("TradingEngine thread started");
         
         MarketEvent event{};
         uint64_t events_processed = 0;
+        uint64_t last_activity_tsc = LatencyTracker::rdtsc();
         
         while (g_running.load(std::memory_order_acquire)) {
+            heartbeat_.beat();
+            
+            // Phase is read BEFORE the pop: the feed only flips to LIVE once
+            // every warmup event has been popped, so anything popped after
+            // observing LIVE is real. One-way - no cost once live.
+            if (!live_) [[unlikely]] {
+                live_ = is_live();
+                if (live_) {
+                    // Warmup traffic doesn't count
+                    events_processed = 0;
+                    orders_sent_ = 0;
+                    orders_dropped_ = 0;
+                    orders_unhealthy_ = 0;
+                }
+            }
+            
             // Try to pop from queue - non-blocking
-            if (event_queue_.try_pop(event)) {
+            if (next_event(event)) {
                 // Timestamp when we got the event
                 const uint64_t process_tsc = LatencyTracker::rdtsc();
                 
                 // Process event
                 process_event(event);
                 
+                if (books_ && live_) {
+                    books_->apply(event);
+                }
+                if (clock_skew_ && live_) {
+                    clock_skew_->on_event(event, process_tsc);
+                }
+                
                 // Calculate tick-to-trade latency
                 const uint64_t total_latency_ticks = process_tsc - event.recv_timestamp_ns;
                 const uint64_t total_latency_ns = LatencyTracker::tsc_to_ns(total_latency_ticks);
@@ -69,22 +257,87 @@ public:
                               << " events, Last latency: " << total_latency_ns << "ns"
                               << std::endl;
                 }
+                jitter_.skip();
+                last_activity_tsc = process_tsc;
                 
             } else {
                 // No events - spin wait
+                const uint64_t now = LatencyTracker::rdtsc();
+                if (idle_warm_interval_ticks_ != 0 &&
+                    now - last_activity_tsc > idle_warm_interval_ticks_) [[unlikely]] {
+                    warm_hot_path(event);
+                    last_activity_tsc = now;
+                    jitter_.skip();
+                    continue;
+                }
+                jitter_.sample(now);
                 SpinWait::pause();
             }
         }
         
-        std::cout << "[TradingEngine] Stopped. Total events: " << events_processed << std::endl;
+        heartbeat_.detach();
+        events_processed_ = events_processed;
+        std::cout << "[TradingEngine] Stopped. Total events: " << events_processed
+                  << ", Orders: " << orders_sent_
+                  << ", Suppressed (warmup): " << orders_suppressed_
+                  << ", Suppressed (feed unhealthy): " << orders_unhealthy_ << std::endl;
+        if (idle_warm_passes_ > 0) {
+            std::cout << "[TradingEngine] Idle warming - Passes: " << idle_warm_passes_
+                      << ", Dummy orders built: " << orders_warmed_ << std::endl;
+        }
+        if (jitter_.gap_count() > 0) {
+            std::cout << "[TradingEngine] Jitter - Idle gaps > " << jitter_.threshold_ns() << "ns: "
+                      << jitter_.gap_count()
+                      << ", p99: " << jitter_.gaps_ns().percentile(99.0) << "ns"
+                      << ", Max: " << jitter_.max_gap_ns() << "ns" << std::endl;
+        }
+        perf_.print("TradingEngine");
+        if (clock_skew_) {
+            clock_skew_->print();
+        }
+        if (merger_) {
+            merger_->print();
+        }
+        if (nbbo_) {
+            nbbo_->print();
+        }
     }
+    
+    [[nodiscard]] uint64_t events_processed() const noexcept { return events_processed_; }
+    [[nodiscard]] uint64_t orders_sent() const noexcept { return orders_sent_; }
+    [[nodiscard]] uint64_t orders_dropped() const noexcept { return orders_dropped_; }
+    [[nodiscard]] uint64_t orders_suppressed() const noexcept { return orders_suppressed_; }
+    [[nodiscard]] uint64_t orders_unhealthy() const noexcept { return orders_unhealthy_; }
+    [[nodiscard]] uint64_t idle_warm_passes() const noexcept { return idle_warm_passes_; }
+    [[nodiscard]] const PerfCounters& perf_counters() const noexcept { return perf_; }
+    [[nodiscard]] const JitterMonitor& jitter_monitor() const noexcept { return jitter_; }
+    [[nodiscard]] const ClockSkewMonitor* clock_skew() const noexcept { return clock_skew_.get(); }
+    [[nodiscard]] Heartbeat& heartbeat() noexcept { return heartbeat_; }
+    [[nodiscard]] BookSnapshot* book_snapshot() noexcept { return snapshot_.get(); }
+    [[nodiscard]] const NbboBook<>* nbbo() const noexcept { return nbbo_.get(); }
 
 private:
+    /**
+     * Next event from the feed queue, or from the merger - ordered once
+     * live, pass-through during warmup (see EventMerger::drain)
+     */
+    [[nodiscard]] inline bool next_event(MarketEvent& event) noexcept {
+        if (merger_) {
+            return live_ ? merger_->poll(event) : merger_->drain(event);
+        }
+        return event_queue_.try_pop(event);
+    }
+    
     /**
      * Process market event and run trading logic
      * This is where your alpha lives!
      */
     void process_event(const MarketEvent& event) {
+        HFT_PERF_SCOPE(perf_, PerfRegion::STRATEGY);
+        dispatch_event(event);
+    }
+    
+    void dispatch_event(const MarketEvent& event) {
         switch (event.type) {
             case MessageType::TRADE:
                 handle_trade(event);
@@ -99,6 +352,33 @@ private:
         }
     }
     
+    /**
+     * One idle warming pass: a signalling trade and a wide quote, so both
+     * strategy branches and send_order (three orders) are exercised
+     * Bypasses the perf scope so dummy events don't skew the STRATEGY numbers.
+     *
+     * @param last Last real event - reuses its symbol so the same state is touched
+     */
+    [[gnu::noinline]] void warm_hot_path(const MarketEvent& last) {
+        const StrategyState saved = state_;
+        warming_ = true;
+        
+        MarketEvent dummy{};
+        dummy.symbol_id = last.symbol_id;
+        dummy.type = MessageType::TRADE;
+        dummy.data.trade = {.price = 1000000, .quantity = 20000, .side = 'B'};
+        dispatch_event(dummy);
+        
+        dummy.type = MessageType::QUOTE;
+        dummy.data.quote = {.bid_price = 999000, .ask_price = 1001000,
+                            .bid_size = 100, .ask_size = 100};
+        dispatch_event(dummy);
+        
+        warming_ = false;
+        state_ = saved;
+        idle_warm_passes_++;
+    }
+    
     void handle_trade(const MarketEvent& event) {
         // Example: Simple trade signal logic
         // In production: complex strategies, ML models, etc.
@@ -107,49 +387,90 @@ private:
         
         // Example: If large trade on bid side, might indicate buying pressure
         if (trade.side == 'B' && trade.quantity > 10000) {
-            // Would send buy order here
-            // send_order(event.symbol_id, trade.price, 100);
+            send_order(event, trade.price, 100, 'B');
         }
     }
     
     void handle_quote(const MarketEvent& event) {
         const auto& quote = event.data.quote;
         
+        // Venue top of book into the consolidated view (not warmup/dummy quotes)
+        if (nbbo_ && live_ && !warming_) {
+            (void)nbbo_->on_quote(event);
+        }
+        
         // Update our view of the market
-        last_bid_ = quote.bid_price;
-        last_ask_ = quote.ask_price;
+        state_.last_bid = quote.bid_price;
+        state_.last_ask = quote.ask_price;
         
         // Example: Spread calculation
-        const uint64_t spread = last_ask_ - last_bid_;
+        const uint64_t spread = state_.last_ask - state_.last_bid;
         
         // Example strategy: If spread is wide, might place orders inside spread
         if (spread > 1000) { // Wide spread
             // Calculate mid price
-            const uint64_t mid = (last_bid_ + last_ask_) / 2;
+            const uint64_t mid = (state_.last_bid + state_.last_ask) / 2;
             
-            // Would send orders here
-            // send_order(event.symbol_id, mid - 1, 100, 'B'); // Buy below mid
-            // send_order(event.symbol_id, mid + 1, 100, 'S'); // Sell above mid
+            send_order(event, mid - 1, 100, 'B'); // Buy below mid
+            send_order(event, mid + 1, 100, 'S'); // Sell above mid
         }
     }
     
     /**
-     * Send order to gateway
-     * In production: another SPSC queue to order gateway thread
+     * Send order to gateway via SPSC queue
+     * Order gateway on another core encodes and sends it
+     * Total tick-to-trade including this: 1-3 microseconds
+     * 
+     * @param trigger Market event that caused the order (timestamps carried along)
      */
-    void send_order(uint32_t symbol_id, uint64_t price, uint32_t qty, char side = 'B') {
-        // This would push to order queue
-        // Order gateway on another core would send via TCP/binary protocol
-        // Total tick-to-trade including this: 1-3 microseconds
-        (void)symbol_id;
-        (void)price;
-        (void)qty;
-        (void)side;
+    void send_order(const MarketEvent& trigger, uint64_t price, uint32_t qty, char side = 'B') {
+        const OrderRequest request{
+            .origin_timestamp_ns = trigger.exchange_timestamp_ns,
+            .event_recv_tsc = trigger.recv_timestamp_ns,
+            .price = price,
+            .symbol_id = trigger.symbol_id,
+            .quantity = qty,
+            .side = static_cast<uint8_t>(side)
+        };
+        
+        // Idle warming: request is built (same code, same cache lines) then dropped
+        if (warming_) [[unlikely]] {
+            do_not_send(request);
+            return;
+        }
+        
+        // Whole decision path runs during warmup - only the push is gated
+        if (!live_) {
+            orders_suppressed_++;
+            return;
+        }
+        
+        // Market view too old / gapped - don't quote on it
+        if (health_ && !health_->healthy(trigger.channel_id)) [[unlikely]] {
+            orders_unhealthy_++;
+            return;
+        }
+        
+        // No gateway wired (tick_to_trade) - the request is built regardless,
+        // so warming and warmup exercise the same path either way
+        if (!order_queue_) {
+            return;
+        }
+        
+        if (order_queue_->try_push(request)) {
+            orders_sent_++;
+        } else {
+            // Gateway backed up - never block the strategy thread
+            orders_dropped_++;
+        }
+    }
+    
+    void do_not_send(const OrderRequest& request) noexcept {
+        // Keep the dummy request from being optimised away
+        asm volatile("" : : "r"(&request) : "memory");
+        orders_warmed_++;
     }
 };
 
-// External global for shutdown signaling
-extern std::atomic<bool> g_running;
-
 } // namespace hft
 
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <atomic>
+#include <type_traits>
 
 namespace hft {
 
@@ -16,6 +18,10 @@ enum class MessageType : uint8_t {
     ORDER_ADD = 0x03,
     ORDER_DELETE = 0x04,
     ORDER_MODIFY = 0x05,
+    ORDER_EXECUTE = 0x06,   // Resting order (partially) filled
+    ORDER_CANCEL = 0x07,    // Partial cancel - quantity is the amount removed
+    ORDER_REPLACE = 0x08,   // Cancel/replace with a new order id
+    BOOK_LEVEL = 0x09,      // Price-level (market-by-price) book update
     HEARTBEAT = 0xFF
 };
 
@@ -51,6 +57,21 @@ struct __attribute__((packed)) QuoteMessage {
     uint8_t  padding[7];
 };
 
+/**
+ * Order book message (add / delete / modify)
+ * Order-by-order feeds (ITCH, MDP3 MBO) are built from these
+ */
+struct __attribute__((packed)) OrderMessage {
+    uint64_t timestamp_ns;
+    uint64_t sequence_num;
+    uint32_t symbol_id;
+    uint64_t order_id;          // Exchange-assigned order reference
+    uint64_t price;
+    uint32_t quantity;          // New quantity for MODIFY, 0 for DELETE
+    uint8_t  side;              // 'B' or 'S'
+    uint8_t  padding[3];
+};
+
 /**
  * Generic market data packet container
  * In production, you'd have a packet header followed by multiple messages
@@ -64,6 +85,7 @@ struct __attribute__((packed)) MarketDataPacket {
     union {
         TradeMessage trade;
         QuoteMessage quote;
+        OrderMessage order;
         uint8_t raw_data[256];  // Max payload size
     } payload;
 };
@@ -71,12 +93,32 @@ struct __attribute__((packed)) MarketDataPacket {
 /**
  * Processed market event after normalization
  * This is what goes into the SPSC queue and consumed by trading logic
+ * 
+ * Exactly one cache line, cache-line aligned: every queue slot is one line,
+ * so a push or pop touches one line and never splits across two (the old
+ * 56-byte layout straddled a line boundary in 7 of every 8 slots).
+ * 
+ *   0  recv_timestamp_ns      8   TSC at receive
+ *   8  exchange_timestamp_ns  8
+ *  16  sequence               8   Feed sequence of the packet it came in
+ *  24  symbol_id              4
+ *  28  type                   1
+ *  29  channel_id             1   Which feed handler / venue channel
+ *  30  (reserved)             2
+ *  32  data                  32   Largest member: replace (28 bytes)
+ * 
+ * Full-width prices, quantities and timestamps: a 32-byte event would need
+ * 32-bit prices and relative timestamps and would still not fit a cancel/
+ * replace with two 64-bit order ids.
  */
-struct MarketEvent {
+struct alignas(64) MarketEvent {
     uint64_t recv_timestamp_ns;     // When we received it (RDTSC)
     uint64_t exchange_timestamp_ns; // Exchange timestamp
+    uint64_t sequence;              // Packet sequence (MoldUDP64: first message of the packet)
     uint32_t symbol_id;
     MessageType type;
+    uint8_t  channel_id;
+    uint8_t  reserved[2];
     
     // Union for different event types
     union {
@@ -92,9 +134,74 @@ struct MarketEvent {
             uint32_t bid_size;
             uint32_t ask_size;
         } quote;
+        
+        struct {
+            uint64_t order_id;
+            uint64_t price;
+            uint32_t quantity;
+            uint8_t  side;
+        } order;
+        
+        struct {
+            uint64_t orig_order_id;
+            uint64_t new_order_id;
+            uint64_t price;
+            uint32_t quantity;
+        } replace;
+        
+        struct {
+            uint64_t price;
+            uint32_t quantity;
+            uint8_t  level;     // 1 = top of book
+            uint8_t  side;      // 'B' or 'S'
+            uint8_t  action;    // 0 new, 1 change, 2 delete
+        } level;
     } data;
 };
 
+static_assert(sizeof(MarketEvent) == 64, "MarketEvent must be exactly one cache line");
+static_assert(alignof(MarketEvent) == 64, "MarketEvent must be cache-line aligned");
+static_assert(offsetof(MarketEvent, data) == 32, "header must stay in the first half-line");
+static_assert(sizeof(MarketEvent::data) <= 32, "event payload outgrew its half-line");
+static_assert(std::is_trivially_copyable_v<MarketEvent>, "MarketEvent is copied through SPSC queues");
+
+/**
+ * Decoder symbol predicate that keeps every message - the default for the
+ * decoders' accept(symbol_id) hook (a SymbolFilter subscription narrows it)
+ */
+struct AllSymbols {
+    constexpr bool operator()(uint32_t) const noexcept { return true; }
+};
+
+/**
+ * Order request - trading engine -> order gateway (SPSC queue)
+ * Carries the trigger's timestamps so tick-to-trade can be measured end to end
+ */
+struct OrderRequest {
+    uint64_t origin_timestamp_ns;   // Exchange timestamp of triggering market event
+    uint64_t event_recv_tsc;        // When the triggering packet was received
+    uint64_t price;
+    uint32_t symbol_id;
+    uint32_t quantity;
+    uint8_t  side;                  // 'B' or 'S'
+};
+
+/**
+ * New order wire message - order gateway -> exchange
+ * Simplified binary order entry (real venues: OUCH, iLink3, Pillar)
+ */
+struct __attribute__((packed)) NewOrderMessage {
+    uint64_t client_order_id;
+    uint64_t origin_timestamp_ns;   // Echoed trigger timestamp (latency attribution)
+    uint64_t event_recv_tsc;
+    uint64_t gateway_send_tsc;
+    uint64_t price;
+    uint32_t symbol_id;
+    uint32_t quantity;
+    uint8_t  side;
+    uint8_t  padding[3];
+};
+
 /**
  * Statistics tracker for monitoring feed handler performance
  */
@@ -120,6 +227,20 @@ struct FeedHandlerStats {
         if (processed == 0) return 0.0;
         return static_cast<double>(total_latency_ns.load(std::memory_order_relaxed)) / processed;
     }
+    
+    /**
+     * Zero everything (e.g. after warmup, before going live)
+     * Only from the thread that updates min/max
+     */
+    void reset() noexcept {
+        packets_received.store(0, std::memory_order_relaxed);
+        packets_processed.store(0, std::memory_order_relaxed);
+        packets_dropped.store(0, std::memory_order_relaxed);
+        sequence_gaps.store(0, std::memory_order_relaxed);
+        total_latency_ns.store(0, std::memory_order_relaxed);
+        min_latency_ns = UINT64_MAX;
+        max_latency_ns = 0;
+    }
 };
 
 } // namespace hft
@@ -11,6 +11,14 @@
 #include <cstring>
 #include <string>
 
+// Older libc headers (kernel 5.11+ options)
+#ifndef SO_PREFER_BUSY_POLL
+#define SO_PREFER_BUSY_POLL 69
+#endif
+#ifndef SO_BUSY_POLL_BUDGET
+#define SO_BUSY_POLL_BUDGET 70
+#endif
+
 namespace hft {
 
 /**
@@ -156,7 +164,7 @@ public:
                                 MSG_DONTWAIT, nullptr, nullptr);
         
         if (bytes < 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
                 return 0; // No data available (expected in non-blocking mode)
             }
             return -1; // Actual error
@@ -168,8 +176,11 @@ public:
     /**
      * Optimized receive into internal buffer
      * Avoids extra copy for small packets
+     * 
+     * Packet source interface of BasicFeedHandler: >0 bytes at buffer_ptr,
+     * 0 = nothing yet, -1 = error / end of stream
      */
-    [[nodiscard]] ssize_t receive_internal(uint8_t*& buffer_ptr) noexcept {
+    [[nodiscard]] ssize_t receive_internal(const uint8_t*& buffer_ptr) noexcept {
         ssize_t bytes = receive(recv_buffer_, RECV_BUFFER_SIZE);
         if (bytes > 0) {
             buffer_ptr = recv_buffer_;
@@ -177,6 +188,16 @@ public:
         return bytes;
     }
     
+    /**
+     * Fault in the receive buffer (64KB inline - lazily backed otherwise)
+     */
+    void prefault() noexcept {
+        volatile uint8_t* p = recv_buffer_;
+        for (size_t off = 0; off < sizeof(recv_buffer_); off += 4096) {
+            p[off] = p[off];
+        }
+    }
+    
     /**
      * Poll for data availability
      * In kernel bypass: always poll, never block
@@ -188,6 +209,25 @@ public:
         return result > 0;
     }
     
+    /**
+     * Kernel busy polling for a socket that sits in an epoll set
+     * 
+     * SO_BUSY_POLL: blocking/epoll waits spin on the device queue for up to
+     * usec before sleeping. SO_PREFER_BUSY_POLL: with napi_defer_hard_irqs
+     * set, the NIC interrupt stays masked while we keep polling, so packets
+     * are picked up by our poll rather than softirq. Fails soft (older
+     * kernels, SO_BUSY_POLL above net.core.busy_read needs CAP_NET_ADMIN).
+     * 
+     * @return true if SO_BUSY_POLL was accepted
+     */
+    bool enable_busy_poll(int usec, int budget = 8) noexcept {
+        const bool ok = setsockopt(socket_fd_, SOL_SOCKET, SO_BUSY_POLL, &usec, sizeof(usec)) == 0;
+        int prefer = 1;
+        setsockopt(socket_fd_, SOL_SOCKET, SO_PREFER_BUSY_POLL, &prefer, sizeof(prefer));
+        setsockopt(socket_fd_, SOL_SOCKET, SO_BUSY_POLL_BUDGET, &budget, sizeof(budget));
+        return ok;
+    }
+    
     /**
      * Get socket file descriptor
      * Useful for integrating with event loops (epoll/io_uring)
@@ -220,5 +260,103 @@ public:
     }
 };
 
+/**
+ * Batched UDP Receiver (recvmmsg)
+ * 
+ * One syscall drains up to BATCH datagrams into fixed slots; they are then
+ * handed out one per receive_internal() call from user space. Under bursts
+ * (open, news, sweeps) that amortizes the syscall over the whole burst; when
+ * the feed is quiet it degrades to one datagram per call, same as
+ * UDPReceiver. Same packet source interface, so it drops into
+ * BasicFeedHandler<RecvmmsgReceiver, Protocol>.
+ * 
+ * Slots are MTU-sized: a datagram longer than SLOT_SIZE is truncated
+ * (counted in truncated()) and the decoder rejects it as malformed.
+ */
+class RecvmmsgReceiver {
+public:
+    static constexpr unsigned BATCH = 32;
+    static constexpr size_t SLOT_SIZE = 2048;
+
+private:
+    UDPReceiver socket_;    // Socket setup (multicast join, buffers, timestamps)
+    
+    alignas(64) uint8_t slots_[BATCH][SLOT_SIZE];
+    mmsghdr msgs_[BATCH];
+    iovec iovecs_[BATCH];
+    unsigned count_{0};     // Datagrams in the current batch
+    unsigned next_{0};      // Next one to hand out
+    
+    uint64_t batches_{0};
+    uint64_t datagrams_{0};
+    uint64_t truncated_{0};
+
+public:
+    RecvmmsgReceiver() noexcept {
+        for (unsigned i = 0; i < BATCH; ++i) {
+            iovecs_[i].iov_base = slots_[i];
+            iovecs_[i].iov_len = SLOT_SIZE;
+            std::memset(&msgs_[i], 0, sizeof(msgs_[i]));
+            msgs_[i].msg_hdr.msg_iov = &iovecs_[i];
+            msgs_[i].msg_hdr.msg_iovlen = 1;
+        }
+    }
+    
+    RecvmmsgReceiver(const RecvmmsgReceiver&) = delete;
+    RecvmmsgReceiver& operator=(const RecvmmsgReceiver&) = delete;
+    
+    bool initialize(const std::string& multicast_ip, uint16_t port, const std::string& interface_ip = "0.0.0.0") {
+        count_ = 0;
+        next_ = 0;
+        return socket_.initialize(multicast_ip, port, interface_ip);
+    }
+    
+    /**
+     * Next datagram of the current batch, refilling with one recvmmsg()
+     * when it is used up
+     */
+    [[nodiscard]] ssize_t receive_internal(const uint8_t*& buffer_ptr) noexcept {
+        if (next_ == count_) [[unlikely]] {
+            const int n = recvmmsg(socket_.fd(), msgs_, BATCH, MSG_DONTWAIT, nullptr);
+            if (n <= 0) {
+                count_ = next_ = 0;
+                // EINTR: watchdog stack capture signal - not an error
+                if (n == 0 || errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                    return 0;
+                }
+                return -1;
+            }
+            count_ = static_cast<unsigned>(n);
+            next_ = 0;
+            batches_++;
+            datagrams_ += count_;
+        }
+        
+        const unsigned i = next_++;
+        if (msgs_[i].msg_hdr.msg_flags & MSG_TRUNC) [[unlikely]] {
+            truncated_++;
+        }
+        buffer_ptr = slots_[i];
+        return static_cast<ssize_t>(msgs_[i].msg_len);
+    }
+    
+    void prefault() noexcept {
+        volatile uint8_t* p = &slots_[0][0];
+        for (size_t off = 0; off < sizeof(slots_); off += 4096) {
+            p[off] = p[off];
+        }
+    }
+    
+    [[nodiscard]] int fd() const noexcept { return socket_.fd(); }
+    bool enable_busy_poll(int usec, int budget = 8) noexcept { return socket_.enable_busy_poll(usec, budget); }
+    [[nodiscard]] uint64_t batches() const noexcept { return batches_; }
+    [[nodiscard]] uint64_t datagrams() const noexcept { return datagrams_; }
+    [[nodiscard]] uint64_t truncated() const noexcept { return truncated_; }
+    
+    [[nodiscard]] double avg_batch() const noexcept {
+        return batches_ ? static_cast<double>(datagrams_) / batches_ : 0.0;
+    }
+};
+
 } // namespace hft
 
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <immintrin.h>
+#include <time.h>
 
 #ifdef __linux__
 #include <sched.h>
@@ -45,6 +46,31 @@ public:
     static inline uint64_t tsc_to_ns(uint64_t tsc, double tsc_freq_ghz = 3.0) noexcept {
         return static_cast<uint64_t>(tsc / tsc_freq_ghz);
     }
+    
+    /**
+     * Measure TSC frequency against CLOCK_MONOTONIC_RAW
+     * Busy-waits for calibration_ms - call once at startup, never in hot path
+     * 
+     * @return TSC frequency in GHz (ticks per nanosecond)
+     */
+    static double calibrate_tsc_ghz(uint32_t calibration_ms = 100) noexcept {
+        timespec ts_start, ts_now;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &ts_start);
+        const uint64_t tsc_start = rdtscp();
+        
+        const uint64_t target_ns = static_cast<uint64_t>(calibration_ms) * 1000000ULL;
+        uint64_t elapsed_ns = 0;
+        uint64_t tsc_end = tsc_start;
+        
+        while (elapsed_ns < target_ns) {
+            clock_gettime(CLOCK_MONOTONIC_RAW, &ts_now);
+            tsc_end = rdtscp();
+            elapsed_ns = static_cast<uint64_t>(ts_now.tv_sec - ts_start.tv_sec) * 1000000000ULL +
+                         static_cast<uint64_t>(ts_now.tv_nsec) - static_cast<uint64_t>(ts_start.tv_nsec);
+        }
+        
+        return static_cast<double>(tsc_end - tsc_start) / static_cast<double>(elapsed_ns);
+    }
 };
 
 /**
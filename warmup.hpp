@@ -0,0 +1,146 @@
+#pragma once
+
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <iostream>
+
+namespace hft {
+
+/**
+ * System lifecycle phase
+ *
+ * WARMUP: synthetic events flow through parse -> queue -> strategy to fault
+ *         in pages, fill i-cache and train branch predictors. The strategy
+ *         runs but must not send orders.
+ * LIVE:   real market data, orders enabled.
+ *
+ * Defaults to LIVE so tools that skip warmup (replay, benchmarks) behave
+ * as before; main() calls begin_warmup() before starting the pipeline
+ * threads.
+ */
+enum class SystemPhase : uint8_t {
+    WARMUP,
+    LIVE
+};
+
+inline std::atomic<SystemPhase> g_system_phase{SystemPhase::LIVE};
+
+// Feed handlers still pushing synthetic traffic - LIVE when the last one ends
+inline std::atomic<uint32_t> g_warming_feeds{0};
+
+[[nodiscard]] inline bool is_live() noexcept {
+    return g_system_phase.load(std::memory_order_acquire) == SystemPhase::LIVE;
+}
+
+/**
+ * Enter WARMUP with this many feed handlers to warm - every handler that
+ * will call warmup(), counted before any of them starts. Several feeds
+ * into one engine (EventMerger) must not flip LIVE while another is still
+ * sending synthetic packets.
+ */
+inline void begin_warmup(uint32_t feeds) noexcept {
+    g_warming_feeds.store(feeds, std::memory_order_relaxed);
+    g_system_phase.store(SystemPhase::WARMUP, std::memory_order_release);
+}
+
+/**
+ * One feed finished warming (its synthetic events all consumed)
+ * @return true if it was the last one and the system is now LIVE
+ */
+inline bool finish_warmup() noexcept {
+    uint32_t warming = g_warming_feeds.load(std::memory_order_relaxed);
+    while (warming > 1 &&
+           !g_warming_feeds.compare_exchange_weak(warming, warming - 1, std::memory_order_acq_rel)) {
+    }
+    if (warming > 1) {
+        return false;
+    }
+    g_warming_feeds.store(0, std::memory_order_relaxed);
+    g_system_phase.store(SystemPhase::LIVE, std::memory_order_release);
+    return true;
+}
+
+/**
+ * Warmup tuning
+ */
+struct WarmupConfig {
+    uint64_t window{1000};          // Packets per measurement window
+    uint64_t min_packets{20000};    // Never stop before this
+    uint64_t max_packets{1000000};  // Give up waiting for stability after this
+    double stable_pct{5.0};         // Window p50 within this % of the previous...
+    uint32_t stable_windows{5};     // ...this many windows in a row
+};
+
+/**
+ * Memory prefaulting
+ *
+ * A page fault on first touch costs 1-5us (more with THP compaction) -
+ * on the first packets of the day that lands straight in tick-to-trade.
+ * Everything the hot path touches is faulted in and locked before LIVE.
+ */
+class Prefault {
+public:
+    /**
+     * Lock all current and future mappings (no swap, no lazy faulting)
+     * MCL_CURRENT also populates every existing mapping.
+     *
+     * Needs CAP_IPC_LOCK or a large enough RLIMIT_MEMLOCK
+     * (ulimit -l unlimited / LimitMEMLOCK=infinity in the systemd unit)
+     */
+    static bool lock_all_memory() noexcept {
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+            return true;
+        }
+        rlimit limit{};
+        getrlimit(RLIMIT_MEMLOCK, &limit);
+        std::cerr << "[Warmup] mlockall failed (RLIMIT_MEMLOCK=" << limit.rlim_cur
+                  << " bytes) - pages may still fault on first touch" << std::endl;
+        return false;
+    }
+
+    /**
+     * Touch every page of [ptr, ptr+size) without changing its contents
+     * Only safe while no other thread is writing the region.
+     */
+    static void touch(void* ptr, size_t size) noexcept {
+        if (!ptr || size == 0) return;
+        volatile uint8_t* p = static_cast<volatile uint8_t*>(ptr);
+        const size_t page = page_size();
+        for (size_t off = 0; off < size; off += page) {
+            p[off] = p[off];
+        }
+        p[size - 1] = p[size - 1];
+    }
+
+    /**
+     * Fault in the calling thread's stack below the current frame
+     * Call at the top of each pipeline thread.
+     */
+    static void stack(size_t bytes = 256 * 1024) noexcept {
+        touch_stack(bytes);
+    }
+
+    static size_t page_size() noexcept {
+        static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return size;
+    }
+
+private:
+    [[gnu::noinline]] static void touch_stack(size_t bytes) noexcept {
+        constexpr size_t CHUNK = 16 * 1024;
+        volatile uint8_t buf[CHUNK];
+        for (size_t off = 0; off < CHUNK; off += 4096) {
+            buf[off] = 0;
+        }
+        if (bytes > CHUNK) {
+            touch_stack(bytes - CHUNK);
+        }
+        buf[0] = buf[0];    // Use after the call - blocks tail-call frame reuse
+    }
+};
+
+} // namespace hft
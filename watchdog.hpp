@@ -0,0 +1,305 @@
+#pragma once
+
+#include "utils.hpp"
+#include "logger.hpp"
+#include <pthread.h>
+#include <signal.h>
+#include <execinfo.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+
+namespace hft {
+
+// External global for shutdown signaling
+extern std::atomic<bool> g_running;
+
+/**
+ * Hot-Thread Heartbeat
+ *
+ * The owning thread bumps the counter once per loop iteration - a plain
+ * load/add/store with relaxed ordering, no RMW, on a line nobody else
+ * writes. The watchdog only reads it, so the line stays Modified in the
+ * owner's cache except when sampled (a few times per stall window).
+ *
+ * The stack capture buffer lives in the same object but on its own lines;
+ * it is written only by the owner's signal handler.
+ */
+struct alignas(64) Heartbeat {
+    static constexpr int MAX_FRAMES = 48;
+
+    std::atomic<uint64_t> beats{0};
+
+    // Registration (owner, once)
+    alignas(64) std::atomic<bool> attached{false};
+    pthread_t owner{};
+    const char* name{"?"};
+
+    // Filled by the stack capture handler on the owner thread
+    alignas(64) std::atomic<int> frame_count{0};
+    void* frames[MAX_FRAMES]{};
+
+    /**
+     * Hot path: one relaxed store
+     */
+    inline void beat() noexcept {
+        beats.store(beats.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * On the owning thread, at the top of its loop
+     */
+    void attach(const char* thread_name) noexcept;
+
+    /**
+     * On the owning thread, before it returns - a finished thread is not hung
+     */
+    void detach() noexcept {
+        attached.store(false, std::memory_order_release);
+    }
+};
+
+namespace detail {
+inline thread_local Heartbeat* t_heartbeat = nullptr;
+}
+
+inline void Heartbeat::attach(const char* thread_name) noexcept {
+    name = thread_name;
+    owner = pthread_self();
+    detail::t_heartbeat = this;
+    beat();
+    attached.store(true, std::memory_order_release);
+}
+
+/**
+ * Stall Watchdog
+ *
+ * Runs on a housekeeping core and samples every registered heartbeat each
+ * poll_us. A heartbeat that has not advanced for stall_us is a stall:
+ * alert once (stderr + log), then send the owner STACK_SIGNAL - its
+ * handler records backtrace() frames into the heartbeat, and the watchdog
+ * prints them. When the counter moves again - or the thread detaches, or
+ * the watchdog stops with the stall still open - its length is reported
+ * and counts toward max_stall_us.
+ *
+ * A thread spinning somewhere without beating is caught mid-stall. One
+ * that is not running at all (RT throttled, blocked on a fault) handles
+ * the signal when it is next scheduled, so the frames show where it
+ * resumed - still the code that stalled. Frames are printed as
+ * binary+offset; resolve with addr2line -e <binary> (or link -rdynamic).
+ */
+struct WatchdogConfig {
+    uint64_t stall_us{1000};        // No heartbeat for this long = alert
+    uint64_t poll_us{100};          // Sampling period (sleep)
+    int core_id{-1};                // Housekeeping core, -1 = not pinned
+    bool capture_stack{true};       // Takes effect once install_stack_capture() succeeds
+};
+
+class Watchdog {
+public:
+    static constexpr size_t MAX_THREADS = 8;
+    static constexpr int STACK_SIGNAL = SIGUSR2;
+
+private:
+    struct Watch {
+        Heartbeat* heartbeat{nullptr};
+        uint64_t last_beats{0};
+        uint64_t last_change_tsc{0};
+        bool stalled{false};
+        bool frames_printed{false};
+        uint64_t stall_start_tsc{0};
+    };
+
+    WatchdogConfig cfg_;
+    Watch watch_[MAX_THREADS];
+    size_t num_watched_{0};
+
+    // Readable from any thread
+    alignas(64) std::atomic<uint64_t> stalls_{0};
+    std::atomic<uint64_t> max_stall_us_{0};
+    std::atomic<uint64_t> stacks_captured_{0};
+
+    // STACK_SIGNAL's default action terminates - never sent without the handler
+    static inline std::atomic<bool> capture_installed_{false};
+
+public:
+    explicit Watchdog(const WatchdogConfig& cfg = WatchdogConfig{}) noexcept
+        : cfg_(cfg) {}
+
+    /**
+     * Watch a heartbeat - before run(); the owner attaches when it starts
+     */
+    bool watch(Heartbeat& heartbeat) noexcept {
+        if (num_watched_ == MAX_THREADS) {
+            return false;
+        }
+        watch_[num_watched_++].heartbeat = &heartbeat;
+        return true;
+    }
+
+    /**
+     * Install the stack capture handler - once, before hot threads start
+     * backtrace() is called once here so libgcc is loaded outside a handler.
+     */
+    static bool install_stack_capture() noexcept {
+        void* frames[4];
+        (void)backtrace(frames, 4);
+
+        struct sigaction sa{};
+        sa.sa_handler = &Watchdog::capture_handler;
+        sigemptyset(&sa.sa_mask);
+        sa.sa_flags = SA_RESTART;
+        const bool installed = sigaction(STACK_SIGNAL, &sa, nullptr) == 0;
+        if (installed) {
+            capture_installed_.store(true, std::memory_order_release);
+        }
+        return installed;
+    }
+
+    /**
+     * Watchdog loop until shutdown
+     */
+    void run() {
+        if (cfg_.core_id >= 0 && !ThreadUtils::pin_to_core(cfg_.core_id)) {
+            std::cerr << "[Watchdog] Failed to pin to core " << cfg_.core_id << std::endl;
+        }
+        const double tsc_ghz = LatencyTracker::calibrate_tsc_ghz(20);
+        const uint64_t stall_ticks = static_cast<uint64_t>(cfg_.stall_us * 1000 * tsc_ghz);
+
+        std::cout << "[Watchdog] Watching " << num_watched_ << " threads, stall > "
+                  << cfg_.stall_us << "us" << std::endl;
+
+        while (g_running.load(std::memory_order_acquire)) {
+            check(LatencyTracker::rdtsc(), stall_ticks, tsc_ghz);
+            std::this_thread::sleep_for(std::chrono::microseconds(cfg_.poll_us));
+        }
+        finish(LatencyTracker::rdtsc(), tsc_ghz);
+    }
+
+    /**
+     * One sampling pass (run() calls this each poll)
+     */
+    void check(uint64_t now, uint64_t stall_ticks, double tsc_ghz) {
+        for (size_t i = 0; i < num_watched_; ++i) {
+            Watch& w = watch_[i];
+            Heartbeat& hb = *w.heartbeat;
+            if (!hb.attached.load(std::memory_order_acquire)) {
+                if (w.stalled) [[unlikely]] {
+                    end_stall(w, now, tsc_ghz, "detached while stalled, after");
+                }
+                w.last_change_tsc = 0;
+                continue;
+            }
+
+            const uint64_t beats = hb.beats.load(std::memory_order_relaxed);
+            if (w.last_change_tsc == 0 || beats != w.last_beats) {
+                if (w.stalled) [[unlikely]] {
+                    end_stall(w, now, tsc_ghz, "resumed after");
+                }
+                w.last_beats = beats;
+                w.last_change_tsc = now;
+                continue;
+            }
+
+            if (!w.stalled && now - w.last_change_tsc > stall_ticks) [[unlikely]] {
+                report_stall(w, now, tsc_ghz);
+            } else if (w.stalled && !w.frames_printed) {
+                print_frames(w);
+            }
+        }
+    }
+
+    /**
+     * Close stalls still open when watching stops (run() calls this on
+     * shutdown) - their length so far counts toward max_stall_us
+     */
+    void finish(uint64_t now, double tsc_ghz) {
+        for (size_t i = 0; i < num_watched_; ++i) {
+            if (watch_[i].stalled) {
+                end_stall(watch_[i], now, tsc_ghz, "still stalled at shutdown, for");
+            }
+        }
+    }
+
+    [[nodiscard]] uint64_t stalls() const noexcept { return stalls_.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t max_stall_us() const noexcept { return max_stall_us_.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t stacks_captured() const noexcept { return stacks_captured_.load(std::memory_order_relaxed); }
+
+    void print() const {
+        std::cout << "[Watchdog] Stalls: " << stalls()
+                  << ", Max: " << max_stall_us() << "us"
+                  << ", Stacks captured: " << stacks_captured() << std::endl;
+    }
+
+private:
+    /**
+     * Owner thread, in signal context: backtrace into the preallocated
+     * buffer only - printing is left to the watchdog
+     */
+    static void capture_handler(int) {
+        Heartbeat* hb = detail::t_heartbeat;
+        if (hb) {
+            const int n = backtrace(hb->frames, Heartbeat::MAX_FRAMES);
+            hb->frame_count.store(n, std::memory_order_release);
+        }
+    }
+
+    void report_stall(Watch& w, uint64_t now, double tsc_ghz) {
+        Heartbeat& hb = *w.heartbeat;
+        w.stalled = true;
+        const bool capture = cfg_.capture_stack && capture_installed_.load(std::memory_order_acquire);
+        w.frames_printed = !capture;
+        w.stall_start_tsc = w.last_change_tsc;
+        stalls_.fetch_add(1, std::memory_order_relaxed);
+
+        char msg[160];
+        snprintf(msg, sizeof(msg), "STALL: %s thread has not advanced for %lu us",
+                 hb.name, static_cast<uint64_t>(LatencyTracker::tsc_to_ns(now - w.last_change_tsc, tsc_ghz) / 1000));
+        std::cerr << "[Watchdog] " << msg << std::endl;
+        LOG_ERROR(msg);
+
+        if (capture) {
+            hb.frame_count.store(0, std::memory_order_relaxed);
+            pthread_kill(hb.owner, STACK_SIGNAL);
+        }
+    }
+
+    /**
+     * Stall over (resumed, detached or shutdown): record its length
+     */
+    void end_stall(Watch& w, uint64_t now, double tsc_ghz, const char* how) {
+        Heartbeat& hb = *w.heartbeat;
+        if (!w.frames_printed) {
+            print_frames(w);
+        }
+        w.stalled = false;
+
+        const uint64_t stall_us = LatencyTracker::tsc_to_ns(now - w.stall_start_tsc, tsc_ghz) / 1000;
+        if (stall_us > max_stall_us_.load(std::memory_order_relaxed)) {
+            max_stall_us_.store(stall_us, std::memory_order_relaxed);
+        }
+
+        char msg[160];
+        snprintf(msg, sizeof(msg), "%s thread %s ~%lu us", hb.name, how, stall_us);
+        std::cerr << "[Watchdog] " << msg << std::endl;
+        LOG_WARN(msg);
+    }
+
+    void print_frames(Watch& w) {
+        Heartbeat& hb = *w.heartbeat;
+        const int n = hb.frame_count.load(std::memory_order_acquire);
+        if (n <= 0) {
+            return;     // Handler has not run yet
+        }
+        w.frames_printed = true;
+        stacks_captured_.fetch_add(1, std::memory_order_relaxed);
+        std::cerr << "[Watchdog] " << hb.name << " stack:" << std::endl;
+        backtrace_symbols_fd(hb.frames, n, STDERR_FILENO);
+    }
+};
+
+} // namespace hft